@@ -3,7 +3,11 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cmath>
+#include <vector>
 #include "Logging.h"
 
 #ifndef MDW_ENABLE_ADAPTIVE_QUALITY
@@ -16,19 +20,60 @@
 
 namespace milkdawp {
 
-// Phase 8.2: Adaptive Quality skeleton — disabled by default
-// Defines quality profiles and a controller that suggests a resolution scale
-// based on FPS EMA and viz-thread CPU%. No side effects unless enabled later.
+// Phase 8.2: Adaptive Quality
+// A quality ladder (frame rate tier, render scale, effect tier, projectM mesh size) and a
+// controller that walks it every frame from a rolling window of render times (p95/p99 against
+// the frame budget). The order of the rungs is the degradation policy.
 struct QualityProfile
 {
-    // Render resolution scale (applied to back buffer size), clamped [0.5, 1.0]
-    double resolutionScale = 1.0;
+    double targetFps = 60.0;        // frame pacing of the renderers
+    double resolutionScale = 1.0;   // render target size relative to the surface, [0.5, 1.0]
+    int effectsTier = 2;            // 2 = full, 1 = reduced, 0 = minimal overlays/effects
+    int meshWidth = 32;             // projectM per-pixel mesh resolution (32x24 is projectM's default)
+    int meshHeight = 24;
 
-    // Future toggles/placeholders (effect density/complexity)
+    // Derived from effectsTier
     bool highDetailEffects = true;
     bool particlesEnabled = true;
+
+    // Render cost of one frame relative to the top rung: pixels, effects and mesh.
+    // Frame rate does not change the cost of a frame, only the budget it has to fit in.
+    double relativeFrameCost() const
+    {
+        static constexpr double effectCost[3] = { 0.7, 0.85, 1.0 };
+        const double mesh = 0.9 + 0.1 * ((double)meshWidth * (double)meshHeight) / (32.0 * 24.0);
+        return resolutionScale * resolutionScale * effectCost[juce::jlimit(0, 2, effectsTier)] * mesh;
+    }
+
+    double budgetMs() const { return 1000.0 / targetFps; }
+
+    bool operator== (const QualityProfile& o) const
+    {
+        return targetFps == o.targetFps && resolutionScale == o.resolutionScale && effectsTier == o.effectsTier
+            && meshWidth == o.meshWidth && meshHeight == o.meshHeight;
+    }
+    bool operator!= (const QualityProfile& o) const { return ! (*this == o); }
+};
+
+// GL pacing of a rung on a display refreshing at refreshHz: the swap interval closest to
+// targetFps without falling below it, and the frame rate that interval really gives. projectM
+// is told the latter so preset timing matches what is shown (interval 2 is 72 fps at 144 Hz).
+struct SwapPacing
+{
+    int interval = 1;
+    double fps = 60.0;
 };
 
+inline SwapPacing swapPacingFor(double targetFps, double refreshHz, int maxInterval = 8) noexcept
+{
+    if (! (refreshHz >= 20.0)) refreshHz = 60.0; // not reported by every platform
+    if (! (targetFps >= 1.0)) targetFps = 1.0;
+    SwapPacing p;
+    p.interval = juce::jlimit(1, maxInterval, (int)std::floor(refreshHz / targetFps + 1.0e-3));
+    p.fps = refreshHz / (double)p.interval;
+    return p;
+}
+
 enum class QualityMode {
     Auto = 0,    // Adaptive based on performance
     Low = 1,     // 0.5x resolution
@@ -36,23 +81,89 @@ enum class QualityMode {
     High = 3     // 1.0x resolution
 };
 
+// Which dimension gives way first under load
+enum class QualityPolicy {
+    PreferSmoothness = 0, // hold the frame rate; drop resolution, effects and mesh first
+    PreferSharpness = 1   // hold the resolution; drop to 45/30 fps first
+};
+
+// Rolling window of the most recent frame times with nearest-rank percentiles.
+// Fixed storage; percentile() partially sorts a scratch copy (cheap at this size).
+class FrameTimeWindow
+{
+public:
+    static constexpr int capacity = 120; // 2 s at 60 fps
+
+    void clear() noexcept { count = 0; head = 0; }
+
+    void push(double ms) noexcept
+    {
+        samples[(size_t)head] = ms;
+        head = (head + 1) % capacity;
+        if (count < capacity) ++count;
+    }
+
+    int size() const noexcept { return count; }
+
+    // p in (0, 1], e.g. 0.95; returns 0 when empty
+    double percentile(double p) const noexcept
+    {
+        if (count == 0) return 0.0;
+        std::copy(samples.begin(), samples.begin() + count, scratch.begin());
+        int rank = (int)std::ceil(p * (double)count) - 1;
+        rank = juce::jlimit(0, count - 1, rank);
+        std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.begin() + count);
+        return scratch[(size_t)rank];
+    }
+
+private:
+    std::array<double, capacity> samples{};
+    mutable std::array<double, capacity> scratch{};
+    int head = 0;
+    int count = 0;
+};
+
 class AdaptiveQualityController
 {
 public:
-    void setTargetFps(double fps) { targetFps.store(juce::jlimit(1.0, 240.0, fps)); }
+    static constexpr double minScale = 0.5;
+    static constexpr double maxScale = 1.0;
+    static constexpr int minSamples = 8;        // frames observed at a rung before acting on it
+    static constexpr double targetLoad = 0.85;  // aim p95 at this fraction of the frame budget
+    static constexpr double headroomLoad = 0.6; // step up only when p95 is below this fraction
+    static constexpr double stallFactor = 1.5;  // p99 above budget * this counts as a stall
+    static constexpr int maxUpRungs = 2;        // recover gradually, drop immediately
+
+    AdaptiveQualityController() { rebuildLadder(); }
+
+    // User frame-rate ceiling; ladder fps tiers never exceed it
+    void setTargetFps(double fps)
+    {
+        targetFps.store(juce::jlimit(1.0, 240.0, fps));
+        ladderDirty.store(true);
+    }
 
-    // Configure thresholds and hysteresis
-    void setFpsThresholds(double lowFps, double highFps)
+    void setPolicy(QualityPolicy p)
     {
-        fpsLow.store(lowFps);
-        fpsHigh.store(juce::jmax(highFps, lowFps + 1.0));
+        policy.store(static_cast<int>(p));
+        ladderDirty.store(true);
     }
+
+    QualityPolicy getPolicy() const { return static_cast<QualityPolicy>(policy.load()); }
+
+    // Configure CPU gating (step up only while the viz thread CPU% is relaxed)
     void setCpuThresholds(double highPct, double relaxPct)
     {
         cpuHigh.store(juce::jlimit(0.0, 100.0, highPct));
         cpuRelax.store(juce::jlimit(0.0, 100.0, relaxPct));
     }
 
+    // Viz thread, before each evaluateFrame: the process-wide cap on the render scale
+    // (QualityBudgetCoordinator). Rungs are costed at the scale they really render at,
+    // min(rung scale, cap), so a capped rung isn't taken for an overloaded one and climbing
+    // above the cap is predicted at its true cost.
+    void setScaleCap(double cap) noexcept { scaleCap = juce::jlimit(0.25, maxScale, cap); }
+
     // Set manual quality override (Auto = 0, Low = 1, Medium = 2, High = 3)
     void setQualityMode(QualityMode mode)
     {
@@ -64,93 +175,182 @@ public:
         return static_cast<QualityMode>(manualMode.load());
     }
 
+    // Rungs from best (0) to cheapest, for the current policy and fps ceiling
+    static std::vector<QualityProfile> buildLadder(QualityPolicy p, double fpsCeiling)
+    {
+        struct Rung { double fps, scale; int tier; };
+        static constexpr Rung smooth[] = {
+            { 60, 1.0, 2 }, { 60, 0.85, 2 }, { 60, 0.75, 1 }, { 60, 0.6, 1 }, { 60, 0.5, 0 }, { 45, 0.5, 0 }, { 30, 0.5, 0 } };
+        static constexpr Rung sharp[] = {
+            { 60, 1.0, 2 }, { 45, 1.0, 2 }, { 30, 1.0, 2 }, { 30, 1.0, 1 }, { 30, 0.85, 1 }, { 30, 0.75, 0 }, { 30, 0.5, 0 } };
+
+        std::vector<QualityProfile> ladder;
+        for (const auto& r : (p == QualityPolicy::PreferSharpness ? sharp : smooth))
+        {
+            QualityProfile q = makeProfile(juce::jmin(r.fps, fpsCeiling), r.scale, r.tier);
+            // A low fps ceiling collapses the upper fps tiers into duplicates
+            if (ladder.empty() || ladder.back() != q)
+                ladder.push_back(q);
+        }
+        return ladder;
+    }
+
     struct Decision {
-        double suggestedScale = 1.0;  // [0.5, 1.0]
-        QualityProfile profile;       // mirrors suggestedScale
+        double suggestedScale = 1.0;  // scale to render at: profile.resolutionScale under the cap
+        QualityProfile profile;       // full rung to apply
+        int rung = 0;                 // ladder index (0 = best); -1 for manual override
         juce::String reason;          // human-readable rationale
+        bool changed = false;         // profile differs from the previous decision
+        double p95Ms = 0.0;           // window percentiles at decision time
+        double p99Ms = 0.0;
+        double budgetMs = 0.0;
     };
 
-    // Compute a suggested resolution scale based on the latest metrics.
-    // This method is cheap and can be called each perf interval.
-    Decision evaluate(double fpsEma, double frameMsEma, double cpuPct)
+    // Feed one frame's render time and get the profile for the next frame. Called every frame.
+    // The window holds frame times per unit of relativeFrameCost() at the scale each frame was
+    // rendered at, so a moving budget cap doesn't skew it. Each rung's render time is
+    // predicted from that via its own capped cost; on
+    // overload the controller jumps straight to the best rung predicted to fit targetLoad of its
+    // budget, and with headroom climbs up to maxUpRungs to the best rung that is predicted to
+    // fit. Rungs are discrete and the up/down thresholds are far apart, so it settles instead
+    // of oscillating. The window is cleared on every change, since frame times from the
+    // previous rung no longer describe the new one.
+    Decision evaluateFrame(double frameMs, double cpuPct)
     {
-        juce::ignoreUnused(frameMsEma);
-        Decision d;
+        if (ladderDirty.exchange(false))
+        {
+            rebuildLadder();
+            window.clear();
+        }
 
-        // Check for manual override first
+        Decision d;
         const QualityMode mode = getQualityMode();
         if (mode != QualityMode::Auto)
         {
-            // Manual override: use fixed scale
-            switch (mode)
-            {
-                case QualityMode::Low:
-                    d.suggestedScale = 0.5;
-                    d.reason = "manual override: Low";
-                    break;
-                case QualityMode::Medium:
-                    d.suggestedScale = 0.75;
-                    d.reason = "manual override: Medium";
-                    break;
-                case QualityMode::High:
-                    d.suggestedScale = 1.0;
-                    d.reason = "manual override: High";
-                    break;
-                default:
-                    d.suggestedScale = 1.0;
-                    d.reason = "manual override: unknown";
-                    break;
-            }
-            currentScale = d.suggestedScale;
-            d.profile.resolutionScale = d.suggestedScale;
-            d.profile.highDetailEffects = (d.suggestedScale >= 0.9);
-            d.profile.particlesEnabled = (d.suggestedScale >= 0.6);
-            return d;
+            const double scale = mode == QualityMode::Low ? 0.5 : (mode == QualityMode::Medium ? 0.75 : 1.0);
+            d.profile = makeProfile(targetFps.load(), scale, scale >= 0.9 ? 2 : (scale >= 0.6 ? 1 : 0));
+            d.rung = -1;
+            d.reason = mode == QualityMode::Low ? "manual override: Low"
+                     : (mode == QualityMode::Medium ? "manual override: Medium" : "manual override: High");
+            // Resume auto mode from the closest rung at or below this resolution
+            rung = 0;
+            while (rung + 1 < (int)ladder.size() && ladder[(size_t)rung].resolutionScale > scale) ++rung;
+            window.clear();
+            return finish(d);
         }
 
-        // Auto mode: adaptive quality based on performance
-        d.suggestedScale = currentScale; // start from last (for hysteresis)
-
-        const double tfps = targetFps.load();
-        const double low = fpsLow.load();
-        const double high = fpsHigh.load();
-        const double cpuH = cpuHigh.load();
-        const double cpuR = cpuRelax.load();
-
-        // Basic strategy with hysteresis:
-        // - If FPS is well below (low) or CPU above (cpuHigh), step down scale.
-        // - If FPS is above (high) and CPU below (cpuRelax), step up.
-        bool stepDown = (fpsEma > 0.0 && fpsEma < juce::jmin(low, 0.85 * tfps)) || (cpuPct >= cpuH);
-        bool stepUp   = (fpsEma >= juce::jmax(high, 0.95 * tfps)) && (cpuPct <= cpuR);
-
-        if (stepDown) {
-            d.suggestedScale = juce::jmax(0.5, currentScale - 0.1);
-            d.reason = "auto: low FPS or high CPU";
-        } else if (stepUp) {
-            d.suggestedScale = juce::jmin(1.0, currentScale + 0.1);
-            d.reason = "auto: good FPS and relaxed CPU";
-        } else {
-            d.reason = "auto: hold (within hysteresis)";
+        window.push(frameMs / costAt(current, appliedScale));
+        const QualityProfile& cur = ladder[(size_t)rung];
+        const double curCost = costAt(cur, scaleCap);
+        d.rung = rung;
+        d.profile = cur;
+        d.budgetMs = cur.budgetMs();
+        const double p95Unit = window.percentile(0.95);
+        const double p99Unit = window.percentile(0.99);
+        d.p95Ms = p95Unit * curCost;
+        d.p99Ms = p99Unit * curCost;
+        if (window.size() < minSamples)
+        {
+            d.reason = "auto: measuring";
+            return finish(d);
         }
 
-        currentScale = d.suggestedScale; // keep internal state for next call
-        d.profile.resolutionScale = d.suggestedScale;
-        d.profile.highDetailEffects = (d.suggestedScale >= 0.9);
-        d.profile.particlesEnabled = (d.suggestedScale >= 0.6);
-        return d;
+        auto fits = [&](int r, double observedUnit) {
+            const auto& q = ladder[(size_t)r];
+            return observedUnit * costAt(q, scaleCap) <= targetLoad * q.budgetMs();
+        };
+
+        const double budget = d.budgetMs;
+        const bool stall = d.p99Ms > stallFactor * budget;
+        const int last = (int)ladder.size() - 1;
+        if ((stall || d.p95Ms > budget) && rung < last)
+        {
+            const double observed = juce::jmax(p95Unit, stall ? p99Unit / stallFactor : 0.0);
+            int r = rung + 1;
+            while (r < last && ! fits(r, observed)) ++r;
+            d.rung = r;
+            d.reason = stall ? "auto: p99 stall" : "auto: p95 over budget";
+        }
+        else if (d.p95Ms < headroomLoad * budget && cpuPct <= cpuRelax.load() && rung > 0)
+        {
+            int r = rung;
+            for (int c = juce::jmax(0, rung - maxUpRungs); c < rung; ++c)
+                if (fits(c, p95Unit)) { r = c; break; }
+            d.rung = r;
+            d.reason = r < rung ? "auto: p95 headroom" : "auto: hold (next rung would not fit)";
+        }
+        else
+        {
+            d.reason = cpuPct >= cpuHigh.load() ? "auto: hold (high CPU)" : "auto: hold (within hysteresis)";
+        }
+
+        if (d.rung != rung)
+        {
+            rung = d.rung;
+            window.clear();
+        }
+        d.profile = ladder[(size_t)rung];
+        d.budgetMs = d.profile.budgetMs();
+        return finish(d);
     }
 
-    double getCurrentScale() const { return currentScale; }
+    double getCurrentScale() const { return current.resolutionScale; }
+    const QualityProfile& getCurrentProfile() const { return current; }
+    int getCurrentRung() const { return rung; }
 
 private:
+    static QualityProfile makeProfile(double fps, double scale, int tier)
+    {
+        static constexpr int meshW[3] = { 16, 24, 32 };
+        static constexpr int meshH[3] = { 12, 18, 24 };
+        QualityProfile q;
+        q.targetFps = fps;
+        q.resolutionScale = scale;
+        q.effectsTier = tier;
+        q.meshWidth = meshW[tier];
+        q.meshHeight = meshH[tier];
+        q.highDetailEffects = tier >= 2;
+        q.particlesEnabled = tier >= 1;
+        return q;
+    }
+
+    void rebuildLadder()
+    {
+        const double prevScale = ladder.empty() ? 1.0 : ladder[(size_t)rung].resolutionScale;
+        ladder = buildLadder(getPolicy(), targetFps.load());
+        rung = 0;
+        while (rung + 1 < (int)ladder.size() && ladder[(size_t)rung].resolutionScale > prevScale) ++rung;
+    }
+
+    Decision& finish(Decision& d)
+    {
+        d.suggestedScale = juce::jmin(d.profile.resolutionScale, scaleCap);
+        d.changed = d.profile != current;
+        current = d.profile; // keep internal state for next call
+        appliedScale = d.suggestedScale;
+        return d;
+    }
+
+    static double costAt(QualityProfile q, double cap)
+    {
+        q.resolutionScale = juce::jmin(q.resolutionScale, cap);
+        return q.relativeFrameCost();
+    }
+
     std::atomic<double> targetFps{ 60.0 };
-    std::atomic<double> fpsLow{ 45.0 };   // scale down if < 45
-    std::atomic<double> fpsHigh{ 58.0 };  // scale up if >= 58
-    std::atomic<double> cpuHigh{ 80.0 };  // scale down if >= 80%
+    std::atomic<double> cpuHigh{ 80.0 };  // reported as the hold reason if >= 80%
     std::atomic<double> cpuRelax{ 50.0 }; // allow scale up if <= 50%
     std::atomic<int> manualMode{ 0 };     // QualityMode: 0=Auto, 1=Low, 2=Medium, 3=High
+    std::atomic<int> policy{ 0 };         // QualityPolicy
+    std::atomic<bool> ladderDirty{ false };
 
-    double currentScale { 1.0 };
+    // Caller thread only (viz thread)
+    std::vector<QualityProfile> ladder;
+    int rung = 0;
+    QualityProfile current;
+    double scaleCap = 1.0;      // latest setScaleCap
+    double appliedScale = 1.0;  // scale the next reported frame is rendered at
+    FrameTimeWindow window;
 };
 
 } // namespace milkdawp
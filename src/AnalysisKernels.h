@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "AudioAnalysisQueue.h"
+#include "SimdDispatch.h"
+
+namespace milkdawp {
+
+// Analysis-path helpers on top of the dispatched SIMD kernels (see SimdDispatch.h).
+// Accumulators always use the same 16-lane layout and reduction order, so results are
+// identical whichever instruction set is active.
+namespace AnalysisKernels {
+
+using EnergyPeak = simd::EnergyPeak;
+
+// Single pass over src: dst = src * window, while accumulating energy and peak of src.
+// Only the first n entries of dst are written; the real-only FFT never reads the upper half.
+inline EnergyPeak windowedCopyEnergyPeak(const float* src, const float* window, float* dst, int n) noexcept
+{
+    return simd::active().windowedCopyEnergyPeak(src, window, dst, n);
+}
+
+// Octave band edges (in FFT bins, half-open) for the fixed analysis rate; band 0 also takes bin 1.
+// At 48 kHz / 1024 points a bin is ~47 Hz, so bands run roughly 47 Hz .. 24 kHz.
+inline const std::array<int, AudioAnalysisSnapshot::numBands + 1>& bandEdges() noexcept
+{
+    static const std::array<int, AudioAnalysisSnapshot::numBands + 1> edges = [] {
+        std::array<int, AudioAnalysisSnapshot::numBands + 1> e{};
+        e[0] = 1;
+        for (int b = 1; b < AudioAnalysisSnapshot::numBands; ++b)
+            e[(size_t)b] = 1 << (b + 1);
+        e[AudioAnalysisSnapshot::numBands] = AudioAnalysisSnapshot::fftSize / 2 + 1;
+        return e;
+    }();
+    return edges;
+}
+
+// One sweep over the interleaved (re, im) spectrum from performRealOnlyForwardTransform.
+// Each band is sqrt(sum |X|^2) scaled by 2/N, i.e. roughly the amplitude of the content in it.
+inline void bandMagnitudes(const float* spectrum, float* bandsOut) noexcept
+{
+    const auto& edges = bandEdges();
+    const auto& k = simd::active();
+    constexpr float scale = 2.0f / (float)AudioAnalysisSnapshot::fftSize;
+    for (int b = 0; b < AudioAnalysisSnapshot::numBands; ++b)
+    {
+        // |X|^2 summed over a band is the sum of squares of its interleaved re/im values
+        const int lo = edges[(size_t)b];
+        const int hi = edges[(size_t)b + 1];
+        bandsOut[b] = std::sqrt(k.sumSquares(spectrum + 2 * lo, 2 * (hi - lo))) * scale;
+    }
+}
+
+// Process-global Hann table for the analysis FFT size, normalised like
+// juce::dsp::WindowingFunction (normalise = true). Shared by all plugin instances.
+inline const float* hannTable() noexcept
+{
+    static const std::vector<float> table = [] {
+        std::vector<float> t((size_t)AudioAnalysisSnapshot::fftSize);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(t.data(), t.size(),
+            juce::dsp::WindowingFunction<float>::hann, true);
+        return t;
+    }();
+    return table.data();
+}
+
+} // namespace AnalysisKernels
+
+} // namespace milkdawp
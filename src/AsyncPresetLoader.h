@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "Logging.h"
+#include "PresetPrefetcher.h"
+
+namespace milkdawp {
+
+// Reads preset files on a background thread so the GL thread only performs the final swap.
+// Requests are "latest wins": a request made while another is still being read supersedes it,
+// and results for superseded requests are dropped. The handoff is double-buffered: the worker
+// fills its own slot and swaps it with the published one under a short lock, and the consumer
+// swaps the published slot into its own object, so neither side copies preset text or waits
+// on file I/O.
+//
+// projectM parses presets and compiles their shaders inside projectm_load_preset_data, which
+// needs the GL context, so that part necessarily stays on the GL thread; this removes the disk
+// read (the dominant stall for cold files and network shares).
+class AsyncPresetLoader {
+public:
+    struct Loaded {
+        juce::String path;
+        std::string data;      // file contents as UTF-8, ready for projectm_load_preset_data
+        bool ok = false;       // false if the file was missing or empty
+        double readMs = 0.0;   // time spent reading on the worker
+        bool prefetched = false; // served from the PresetPrefetcher instead of disk
+        juce::Time modified;   // file timestamp, stat'ed on the worker (keys PresetCostProfile)
+        uint64_t generation = 0;
+    };
+
+    AsyncPresetLoader() = default;
+    ~AsyncPresetLoader() { stop(); }
+
+    // Consumer thread (starts the worker on first use). Returns the generation of this request.
+    uint64_t request(const juce::String& path)
+    {
+        uint64_t gen;
+        {
+            const juce::ScopedLock sl(lock);
+            pendingPath = path;
+            gen = ++requested;
+        }
+        if (! worker.joinable())
+        {
+            exitFlag.store(false, std::memory_order_relaxed);
+            worker = std::thread([this] { run(); });
+        }
+        wake.signal();
+        return gen;
+    }
+
+    // Optional source of already-read presets, consulted before the disk. Must outlive the loader.
+    void setPrefetcher(PresetPrefetcher* p) noexcept { prefetcher.store(p, std::memory_order_release); }
+
+    // Consumer thread: if the most recent request has finished, swaps its result into out.
+    bool takeReady(Loaded& out)
+    {
+        const juce::ScopedLock sl(lock);
+        if (! publishedReady || published.generation != requested)
+            return false;
+        std::swap(out, published);
+        publishedReady = false;
+        taken = out.generation;
+        return true;
+    }
+
+    // True while the latest request has not been handed over yet
+    bool isPending() const
+    {
+        const juce::ScopedLock sl(lock);
+        return taken < requested;
+    }
+
+    void stop()
+    {
+        exitFlag.store(true, std::memory_order_relaxed);
+        wake.signal();
+        if (worker.joinable())
+            worker.join();
+    }
+
+private:
+    void run()
+    {
+        while (! exitFlag.load(std::memory_order_relaxed))
+        {
+            juce::String path;
+            uint64_t gen = 0;
+            {
+                const juce::ScopedLock sl(lock);
+                if (requested != completed)
+                {
+                    path = pendingPath;
+                    gen = requested;
+                }
+            }
+            if (gen == 0)
+            {
+                wake.wait(100.0);
+                continue;
+            }
+
+            const double t0 = juce::Time::getMillisecondCounterHiRes();
+            back.path = path;
+            back.generation = gen;
+            back.data.clear();
+            auto* pf = prefetcher.load(std::memory_order_acquire);
+            back.prefetched = pf != nullptr && pf->take(path, back.data);
+            if (! back.prefetched)
+            {
+                const juce::File f(path);
+                if (f.existsAsFile())
+                    back.data = f.loadFileAsString().toStdString();
+            }
+            back.ok = ! back.data.empty();
+            back.modified = juce::File(path).getLastModificationTime();
+            back.readMs = juce::Time::getMillisecondCounterHiRes() - t0;
+            if (! back.ok)
+                MDW_LOG_WARN(juce::String("Preset loader: could not read ") + path);
+
+            const juce::ScopedLock sl(lock);
+            completed = gen;
+            // Drop the result if a newer request arrived while reading; the loop picks it up
+            if (gen == requested)
+            {
+                std::swap(back, published);
+                publishedReady = true;
+            }
+        }
+    }
+
+    mutable juce::CriticalSection lock;
+    juce::String pendingPath;       // guarded by lock
+    uint64_t requested = 0;         // guarded by lock
+    uint64_t completed = 0;         // guarded by lock
+    uint64_t taken = 0;             // guarded by lock
+    Loaded published;               // guarded by lock
+    bool publishedReady = false;    // guarded by lock
+    Loaded back;                    // worker only
+
+    juce::WaitableEvent wake;
+    std::atomic<PresetPrefetcher*> prefetcher{ nullptr };
+    std::atomic<bool> exitFlag{ false };
+    std::thread worker;
+};
+
+} // namespace milkdawp
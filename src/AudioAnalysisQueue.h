@@ -15,9 +15,15 @@ struct AudioAnalysisSnapshot {
     // FFT configuration used for windowing in processor/tests
     static constexpr int fftOrder = 10; // 2^10 = 1024
     static constexpr int fftSize  = 1 << fftOrder;
+    static constexpr int numBands = 8;  // octave bands, see AnalysisKernels::bandEdges
 
-    uint64_t samplePosition = 0;    // position in samples of start of window
+    uint64_t samplePosition = 0;    // position in samples of start of window (host rate)
+    uint32_t windowLength   = 0;    // window length in host-rate samples
+    double analysisRate     = 0.0;  // sample rate the window was analysed at (after decimation)
     float shortTimeEnergy   = 0.0f; // simple energy metric for tests and basic visualization
+    float peak              = 0.0f; // max |sample| within the window
+    float beatEnvelope      = 0.0f; // 1 on an energy onset, decaying towards 0 between beats
+    std::array<float, numBands> bands{}; // band magnitudes, low to high
     // Additional fields (spectrum bins, beat flags, etc.) will be added in later phases.
 };
 
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "AudioAnalysisQueue.h"
+#include "AnalysisKernels.h"
+#include "HalfBandDecimator.h"
+
+namespace milkdawp {
+
+// Audio-thread analysis front end.
+// Mixes the host input to mono, decimates it to a fixed internal rate (44.1/48 kHz) and
+// produces one AudioAnalysisSnapshot per fftSize analysis-rate samples. Because the FFT
+// always sees the same rate, window length (~21-23 ms), bin spacing and CPU cost per second
+// stay constant whether the host runs at 44.1, 96 or 192 kHz.
+class AudioAnalyzer {
+public:
+    static constexpr int fftOrder = AudioAnalysisSnapshot::fftOrder;
+    static constexpr int fftSize  = AudioAnalysisSnapshot::fftSize;
+
+    AudioAnalyzer()
+    : fft(fftOrder),
+      window(AnalysisKernels::hannTable())
+    {
+        fftBuffer.malloc(fftSize * 2);
+        monoAccum.resize(fftSize);
+        downmixScratch.resize(downmixBlock);
+        // Resolve the SIMD variant here (message thread) so the audio thread never logs
+        kernels = &simd::active();
+        reset();
+    }
+
+    // Not realtime-safe only in the sense that it resets state; no allocation happens here.
+    void prepare(double hostSampleRate)
+    {
+        decimator.prepare(hostSampleRate);
+        reset();
+    }
+
+    void reset()
+    {
+        decimator.reset();
+        fftWritePos = 0;
+        hostSamplePos = 0;
+        energyHistory.fill(0.0f);
+        energyIndex = 0;
+        energyAverage = 0.0f;
+        beatCooldown = 0;
+        beatEnvelope = 0.0f;
+    }
+
+    // Feed one host block (in1 may be null for mono, both null for silence).
+    // Completed snapshots are pushed to queue (dropped if full).
+    template <typename Queue>
+    void process(const float* in0, const float* in1, int numSamples, Queue& queue) noexcept
+    {
+        if (in0 == nullptr && in1 != nullptr)
+            std::swap(in0, in1);
+
+        for (int start = 0; start < numSamples; start += downmixBlock)
+        {
+            const int count = juce::jmin(downmixBlock, numSamples - start);
+            const float* mono = nullptr;
+            if (in0 != nullptr && in1 != nullptr)
+            {
+                // Average stereo in vectorised chunks before the (serial) decimator
+                kernels->downmixStereo(in0 + start, in1 + start, downmixScratch.data(), count);
+                mono = downmixScratch.data();
+            }
+            else if (in0 != nullptr)
+            {
+                mono = in0 + start;
+            }
+            else
+            {
+                std::fill(downmixScratch.begin(), downmixScratch.begin() + count, 0.0f);
+                mono = downmixScratch.data();
+            }
+
+            for (int n = 0; n < count; ++n)
+            {
+                ++hostSamplePos;
+                float d;
+                if (! decimator.push(mono[n], d))
+                    continue;
+
+                monoAccum[(size_t)fftWritePos++] = d;
+                if (fftWritePos == fftSize)
+                {
+                    produceAnalysisSnapshot(queue);
+                    fftWritePos = 0;
+                }
+            }
+        }
+    }
+
+    const char* getSimdVariantName() const noexcept { return kernels->name; }
+    int getDecimationFactor() const noexcept { return decimator.getDecimationFactor(); }
+    // Host-rate samples consumed so far; the audio clock is keyed on the same counter
+    uint64_t getHostSamplePosition() const noexcept { return hostSamplePos; }
+    double getAnalysisRate() const noexcept { return decimator.getOutputRate(); }
+    float getEnergyAverage() const noexcept { return energyAverage; }
+
+private:
+    template <typename Queue>
+    void produceAnalysisSnapshot(Queue& queue) noexcept
+    {
+        // Windowed copy into the FFT buffer; energy and peak are gathered in the same pass.
+        // The upper half of fftBuffer is scratch for the real-only transform and needs no zeroing.
+        auto* fftData = fftBuffer.get();
+        const auto ep = AnalysisKernels::windowedCopyEnergyPeak(monoAccum.data(), window, fftData, fftSize);
+        const float energy = ep.energy;
+
+        fft.performRealOnlyForwardTransform(fftData, true);
+
+        AudioAnalysisSnapshot snap;
+        snap.shortTimeEnergy = energy;
+        snap.peak = ep.peak;
+        AnalysisKernels::bandMagnitudes(fftData, snap.bands.data());
+        // The window spans fftSize analysis samples, i.e. fftSize * factor host samples
+        const uint64_t span = (uint64_t)fftSize * (uint64_t)decimator.getDecimationFactor();
+        snap.samplePosition = hostSamplePos >= span ? hostSamplePos - span : 0;
+        snap.windowLength = (uint32_t)span;
+        snap.analysisRate = decimator.getOutputRate();
+
+        // Beat envelope: jumps to 1 when energy clearly exceeds the ~1 s average, then decays.
+        // The decay is per snapshot, so it reads as a smooth curve once interpolated by the viz thread.
+        if (beatCooldown == 0 && energyAverage > 1.0e-6f && energy > beatThreshold * energyAverage)
+        {
+            beatEnvelope = 1.0f;
+            beatCooldown = beatCooldownSnapshots;
+        }
+        else
+        {
+            beatEnvelope *= beatDecay;
+        }
+        snap.beatEnvelope = beatEnvelope;
+
+        // Maintain the moving average used for beat detection
+        constexpr int historyLen = (int)energyHistorySize;
+        const float old = energyHistory[(size_t)energyIndex];
+        energyHistory[(size_t)energyIndex] = energy;
+        energyIndex = (energyIndex + 1) % historyLen;
+        energyAverage += (energy - old) / (float)historyLen;
+        if (beatCooldown > 0) --beatCooldown;
+
+        // Enqueue (drop if full)
+        (void)queue.tryPush(snap);
+    }
+
+    static constexpr int downmixBlock = 256;
+
+    AnalysisDecimator decimator;
+    const simd::Kernels* kernels = nullptr;
+    std::vector<float> downmixScratch; // size = downmixBlock
+
+    juce::dsp::FFT fft;
+    const float* window; // shared Hann table, see AnalysisKernels::hannTable
+    juce::HeapBlock<float> fftBuffer; // size = 2 * fftSize
+    std::vector<float> monoAccum;     // size = fftSize (analysis rate)
+    int fftWritePos = 0;
+    uint64_t hostSamplePos = 0;
+
+    // ~1 s of history at the fixed analysis rate, independent of host rate
+    static constexpr size_t energyHistorySize = 43;
+    std::array<float, energyHistorySize> energyHistory{};
+    int energyIndex = 0;
+    float energyAverage = 0.0f;
+    int beatCooldown = 0;
+    float beatEnvelope = 0.0f;
+    static constexpr float beatThreshold = 1.5f;       // energy / average ratio counted as a beat
+    static constexpr float beatDecay = 0.85f;          // per snapshot, ~90 ms half-life at 46.9 Hz
+    static constexpr int beatCooldownSnapshots = 9;    // ~190 ms minimum between beats
+};
+
+} // namespace milkdawp
@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include "AudioAnalysisQueue.h"
+
+namespace milkdawp {
+
+// Maps the audio thread's sample counter to wall-clock seconds.
+// processBlock timestamps are jittery (host scheduling, buffer sizes), so a second-order
+// delay-locked loop filters them into a smooth time base:
+//   t(n) = t0 + (n - n0) * secondsPerSample
+// The audio thread is the only writer; any thread may read through a seqlock.
+class AudioClock {
+public:
+    // Loop bandwidth in Hz; lower is smoother but slower to follow drift
+    static constexpr double bandwidthHz = 0.5;
+
+    void reset() noexcept
+    {
+        initialised = false;
+        publish(0.0, 0.0, 0.0, 0.0, false);
+    }
+
+    // Audio thread: call once per block with the sample position of the block start.
+    void update(uint64_t samplePos, double nowSeconds, int numSamples, double sampleRate) noexcept
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0) return;
+
+        const double nominalSps = 1.0 / sampleRate;
+        if (! initialised || samplePos != expectedPos || sampleRate != lastRate)
+        {
+            // First block, transport discontinuity or rate change: restart the loop
+            t = nowSeconds;
+            sps = nominalSps;
+            initialised = true;
+        }
+        else
+        {
+            const double predicted = t + (double)lastBlock * sps;
+            const double err = nowSeconds - predicted;
+            const double omega = 2.0 * 3.14159265358979323846 * bandwidthHz * (double)lastBlock * sps;
+            t = predicted + std::sqrt(2.0) * omega * err;
+            sps += omega * omega * err / (double)lastBlock;
+            // Keep the rate estimate sane if timestamps are garbage (e.g. host stalls)
+            if (sps < 0.5 * nominalSps || sps > 2.0 * nominalSps) { t = nowSeconds; sps = nominalSps; }
+        }
+
+        expectedPos = samplePos + (uint64_t)numSamples;
+        lastBlock = numSamples;
+        lastRate = sampleRate;
+        publish((double)samplePos, t, sps, (double)numSamples * nominalSps, true);
+    }
+
+    struct State {
+        double n0 = 0.0;               // sample position of the reference point
+        double t0 = 0.0;               // filtered wall-clock seconds at n0
+        double secondsPerSample = 0.0;
+        double blockSeconds = 0.0;     // duration of the last host block (output buffer latency estimate)
+        bool valid = false;
+    };
+
+    // Any thread: consistent copy of the latest estimate.
+    State read() const noexcept
+    {
+        State s;
+        for (;;)
+        {
+            const uint32_t s1 = seq.load(std::memory_order_acquire);
+            if (s1 & 1u) continue;
+            s.n0 = n0Pub.load(std::memory_order_relaxed);
+            s.t0 = t0Pub.load(std::memory_order_relaxed);
+            s.secondsPerSample = spsPub.load(std::memory_order_relaxed);
+            s.blockSeconds = blockPub.load(std::memory_order_relaxed);
+            s.valid = validPub.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1)
+                return s;
+        }
+    }
+
+    static double sampleToTime(const State& s, double samplePos) noexcept
+    {
+        return s.t0 + (samplePos - s.n0) * s.secondsPerSample;
+    }
+
+    static double timeToSample(const State& s, double seconds) noexcept
+    {
+        return s.secondsPerSample > 0.0 ? s.n0 + (seconds - s.t0) / s.secondsPerSample : s.n0;
+    }
+
+private:
+    void publish(double n0, double t0, double spsV, double blockSec, bool valid) noexcept
+    {
+        const uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        n0Pub.store(n0, std::memory_order_relaxed);
+        t0Pub.store(t0, std::memory_order_relaxed);
+        spsPub.store(spsV, std::memory_order_relaxed);
+        blockPub.store(blockSec, std::memory_order_relaxed);
+        validPub.store(valid, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // Audio thread only
+    bool initialised = false;
+    double t = 0.0;
+    double sps = 0.0;
+    uint64_t expectedPos = 0;
+    int lastBlock = 0;
+    double lastRate = 0.0;
+
+    // Published estimate
+    std::atomic<uint32_t> seq{ 0 };
+    std::atomic<double> n0Pub{ 0.0 };
+    std::atomic<double> t0Pub{ 0.0 };
+    std::atomic<double> spsPub{ 0.0 };
+    std::atomic<double> blockPub{ 0.0 };
+    std::atomic<bool> validPub{ false };
+};
+
+// Short history of analysis snapshots on the viz thread, so the renderer can show the
+// features that are audible now rather than the snapshot that arrived last.
+class SnapshotHistory {
+public:
+    static constexpr int capacity = 32; // ~0.7 s at 46 snapshots/s
+
+    void clear() noexcept { count = 0; head = 0; }
+
+    void push(const AudioAnalysisSnapshot& s) noexcept
+    {
+        // A position jump backwards means the transport/analyzer restarted
+        if (count > 0 && s.samplePosition < newest().samplePosition)
+            clear();
+        items[(size_t)head] = s;
+        head = (head + 1) % capacity;
+        if (count < capacity) ++count;
+    }
+
+    int size() const noexcept { return count; }
+
+    // i = 0 is the oldest entry
+    const AudioAnalysisSnapshot& at(int i) const noexcept
+    {
+        return items[(size_t)((head - count + i + capacity) % capacity)];
+    }
+
+    const AudioAnalysisSnapshot& newest() const noexcept { return at(count - 1); }
+
+    // Host-rate sample position at the centre of the snapshot's analysis window
+    static double centreOf(const AudioAnalysisSnapshot& s) noexcept
+    {
+        return (double)s.samplePosition + 0.5 * (double)s.windowLength;
+    }
+
+    // Newest snapshot whose window centre is at or before targetPos; the oldest one if all are later.
+    bool pick(double targetPos, AudioAnalysisSnapshot& out) const noexcept
+    {
+        if (count == 0) return false;
+        for (int i = count - 1; i >= 0; --i)
+        {
+            if (centreOf(at(i)) <= targetPos)
+            {
+                out = at(i);
+                return true;
+            }
+        }
+        out = at(0);
+        return true;
+    }
+
+    // Sample position whose features to show at nowSec: the audio leaving the speakers (the
+    // clock's position minus one host buffer of output latency and the user offset). Windows
+    // don't overlap, so the snapshot after any position is only complete up to 1.5 windows
+    // later. Host buffers shorter than that would leave the target past the newest window
+    // centre most of the time, where interpolate() can only repeat the newest snapshot; the
+    // target is held back by the difference so it stays bracketed.
+    double targetPosition(const AudioClock::State& cs, double nowSec, double offsetSec) const noexcept
+    {
+        const double heard = AudioClock::timeToSample(cs, nowSec - cs.blockSeconds - offsetSec);
+        if (count == 0 || cs.secondsPerSample <= 0.0) return heard;
+        const double blockSamples = cs.blockSeconds / cs.secondsPerSample;
+        const double holdBack = 1.5 * (double)newest().windowLength - blockSamples;
+        return holdBack > 0.0 ? heard - holdBack : heard;
+    }
+
+    // Like pick(), but blends the continuous features (energy, peak, bands, beat envelope)
+    // linearly between the two snapshots whose window centres bracket targetPos.
+    // Outside the retained range the nearest snapshot is returned unchanged.
+    bool interpolate(double targetPos, AudioAnalysisSnapshot& out) const noexcept
+    {
+        if (count == 0) return false;
+        int i = count - 1;
+        while (i >= 0 && centreOf(at(i)) > targetPos) --i;
+        if (i < 0 || i == count - 1)
+        {
+            out = at(i < 0 ? 0 : i);
+            return true;
+        }
+
+        const AudioAnalysisSnapshot& a = at(i);
+        const AudioAnalysisSnapshot& b = at(i + 1);
+        const double ca = centreOf(a), cb = centreOf(b);
+        const float f = cb > ca ? (float)((targetPos - ca) / (cb - ca)) : 0.0f;
+        auto lerp = [f](float x, float y) { return x + (y - x) * f; };
+
+        out = a;
+        out.samplePosition = (uint64_t)((double)a.samplePosition + (double)(b.samplePosition - a.samplePosition) * (double)f);
+        out.shortTimeEnergy = lerp(a.shortTimeEnergy, b.shortTimeEnergy);
+        out.peak = lerp(a.peak, b.peak);
+        out.beatEnvelope = lerp(a.beatEnvelope, b.beatEnvelope);
+        for (size_t k = 0; k < out.bands.size(); ++k)
+            out.bands[k] = lerp(a.bands[k], b.bands[k]);
+        return true;
+    }
+
+private:
+    std::array<AudioAnalysisSnapshot, capacity> items{};
+    int head = 0;
+    int count = 0;
+};
+
+} // namespace milkdawp
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif defined(__APPLE__)
+ #include <OpenGL/OpenGL.h>
+#elif defined(__linux__)
+ #include <dlfcn.h>
+#endif
+
+namespace milkdawp {
+
+// A GL context that shares objects with the canvas context. create() and destroy() run on the
+// GL thread while the canvas context is current. makeCurrentOnCurrentDrawable()/restorePrevious()
+// borrow the calling thread's current drawable for a stretch of work and then hand it back to
+// the context that was current (used by RenderHost on the GL thread).
+struct BackgroundGLContext
+{
+   #ifdef _WIN32
+    static constexpr bool sharesWithCanvas = true;
+    HDC dc = nullptr;
+    HGLRC rc = nullptr;
+    HDC prevDc = nullptr;
+    HGLRC prevRc = nullptr;
+    bool create()
+    {
+        dc = wglGetCurrentDC();
+        HGLRC shared = wglGetCurrentContext();
+        if (dc == nullptr || shared == nullptr) return false;
+        typedef HGLRC (WINAPI *PFN_WGL_CREATE_CONTEXT_ATTRIBS)(HDC, HGLRC, const int*);
+        if (auto createAttribs = (PFN_WGL_CREATE_CONTEXT_ATTRIBS) wglGetProcAddress("wglCreateContextAttribsARB")) {
+            const int attribs[] = { 0 };
+            rc = createAttribs(dc, shared, attribs);
+        }
+        if (rc == nullptr) {
+            rc = wglCreateContext(dc);
+            if (rc != nullptr && ! wglShareLists(shared, rc)) { wglDeleteContext(rc); rc = nullptr; }
+        }
+        return rc != nullptr;
+    }
+    void destroy() { if (rc != nullptr) wglDeleteContext(rc); rc = nullptr; dc = nullptr; }
+    bool makeCurrentOnCurrentDrawable()
+    {
+        prevDc = wglGetCurrentDC();
+        prevRc = wglGetCurrentContext();
+        return rc != nullptr && prevDc != nullptr && wglMakeCurrent(prevDc, rc) != FALSE;
+    }
+    void restorePrevious() { wglMakeCurrent(prevDc, prevRc); }
+    void* nativeHandle() const { return rc; } // what juce::OpenGLContext::setNativeSharedContext takes
+   #elif defined(__APPLE__)
+    // A canvas context can't join this one's share group (see nativeHandle), so macOS has no
+    // render host
+    static constexpr bool sharesWithCanvas = false;
+    CGLContextObj rc = nullptr;
+    CGLContextObj prevRc = nullptr;
+    bool create()
+    {
+        CGLContextObj shared = CGLGetCurrentContext();
+        if (shared == nullptr) return false;
+        return CGLCreateContext(CGLGetPixelFormat(shared), shared, &rc) == kCGLNoError && rc != nullptr;
+    }
+    void destroy() { if (rc != nullptr) CGLDestroyContext(rc); rc = nullptr; }
+    bool makeCurrentOnCurrentDrawable()
+    {
+        prevRc = CGLGetCurrentContext();
+        return rc != nullptr && CGLSetCurrentContext(rc) == kCGLNoError;
+    }
+    void restorePrevious() { CGLSetCurrentContext(prevRc); }
+    // JUCE shares with an NSOpenGLContext here, which a bare CGL context can't stand in for
+    void* nativeHandle() const { return nullptr; }
+   #elif defined(__linux__)
+    // GLX is resolved at runtime (JUCE has already loaded libGL) to keep X11's macros out of this file
+    static constexpr bool sharesWithCanvas = true;
+    typedef void* (*PFN_GLX_GET_CURRENT)();
+    typedef unsigned long (*PFN_GLX_GET_CURRENT_DRAWABLE)();
+    typedef int (*PFN_GLX_QUERY_CONTEXT)(void*, void*, int, int*);
+    typedef void** (*PFN_GLX_CHOOSE_FB_CONFIG)(void*, int, const int*, int*);
+    typedef void* (*PFN_GLX_CREATE_NEW_CONTEXT)(void*, void*, int, void*, int);
+    typedef int (*PFN_GLX_MAKE_CONTEXT_CURRENT)(void*, unsigned long, unsigned long, void*);
+    typedef void (*PFN_GLX_DESTROY_CONTEXT)(void*, void*);
+    typedef int (*PFN_X_FREE)(void*);
+    void* display = nullptr;
+    void* rc = nullptr;
+    void* prevRc = nullptr;
+    unsigned long prevDraw = 0, prevRead = 0;
+    PFN_GLX_MAKE_CONTEXT_CURRENT makeContextCurrent = nullptr;
+    PFN_GLX_DESTROY_CONTEXT destroyContext = nullptr;
+    PFN_GLX_GET_CURRENT getCurrentContext = nullptr;
+    PFN_GLX_GET_CURRENT_DRAWABLE getCurrentDrawable = nullptr;
+    PFN_GLX_GET_CURRENT_DRAWABLE getCurrentReadDrawable = nullptr;
+    template <typename Fn> static Fn glx(const char* name) { return reinterpret_cast<Fn>(dlsym(RTLD_DEFAULT, name)); }
+    bool create()
+    {
+        auto getDisplay   = glx<PFN_GLX_GET_CURRENT>("glXGetCurrentDisplay");
+        auto getContext   = glx<PFN_GLX_GET_CURRENT>("glXGetCurrentContext");
+        auto getDrawable  = glx<PFN_GLX_GET_CURRENT_DRAWABLE>("glXGetCurrentDrawable");
+        auto queryContext = glx<PFN_GLX_QUERY_CONTEXT>("glXQueryContext");
+        auto chooseConfig = glx<PFN_GLX_CHOOSE_FB_CONFIG>("glXChooseFBConfig");
+        auto createCtx    = glx<PFN_GLX_CREATE_NEW_CONTEXT>("glXCreateNewContext");
+        auto xFree        = glx<PFN_X_FREE>("XFree");
+        makeContextCurrent = glx<PFN_GLX_MAKE_CONTEXT_CURRENT>("glXMakeContextCurrent");
+        destroyContext     = glx<PFN_GLX_DESTROY_CONTEXT>("glXDestroyContext");
+        getCurrentContext      = getContext;
+        getCurrentDrawable     = getDrawable;
+        getCurrentReadDrawable = glx<PFN_GLX_GET_CURRENT_DRAWABLE>("glXGetCurrentReadDrawable");
+        if (!getDisplay || !getContext || !getDrawable || !queryContext || !chooseConfig || !createCtx
+            || !xFree || !makeContextCurrent || !destroyContext || !getCurrentReadDrawable)
+            return false;
+        display = getDisplay();
+        void* shared = getContext();
+        if (display == nullptr || shared == nullptr || getDrawable() == 0) return false;
+        // GLX_FBCONFIG_ID / GLX_SCREEN / GLX_RGBA_TYPE
+        int fbConfigId = 0, screen = 0;
+        if (queryContext(display, shared, 0x8013, &fbConfigId) != 0) return false;
+        queryContext(display, shared, 0x800C, &screen);
+        const int wanted[] = { 0x8013, fbConfigId, 0 };
+        int n = 0;
+        void** configs = chooseConfig(display, screen, wanted, &n);
+        if (configs != nullptr && n > 0)
+            rc = createCtx(display, configs[0], 0x8014, shared, 1);
+        if (configs != nullptr) xFree(configs);
+        return rc != nullptr;
+    }
+    void destroy() { if (rc != nullptr) destroyContext(display, rc); rc = nullptr; display = nullptr; }
+    bool makeCurrentOnCurrentDrawable()
+    {
+        if (rc == nullptr) return false;
+        prevRc = getCurrentContext();
+        prevDraw = getCurrentDrawable();
+        prevRead = getCurrentReadDrawable();
+        return prevDraw != 0 && makeContextCurrent(display, prevDraw, prevDraw, rc) != 0;
+    }
+    void restorePrevious() { makeContextCurrent(display, prevDraw, prevRead, prevRc); }
+    void* nativeHandle() const { return rc; }
+   #else
+    static constexpr bool sharesWithCanvas = false;
+    bool create() { return false; }
+    void destroy() {}
+    bool makeCurrentOnCurrentDrawable() { return false; }
+    void restorePrevious() {}
+    void* nativeHandle() const { return nullptr; }
+   #endif
+};
+
+} // namespace milkdawp
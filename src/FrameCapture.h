@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "RenderScale.h"
+#include "ThreadSafeQueue.h"
+
+namespace milkdawp {
+
+// Frame capture. The GL canvas reads its finished frames back through a ring of pixel buffer
+// objects and hands each one, a couple of frames late, to the sinks on the processor's
+// FrameCaptureBus. Sinks run on the canvas's capture thread while the buffer is mapped, and the
+// buffer can't be reused until they return, so they should only copy: CaptureFrameQueue copies
+// into a preallocated pool and passes the frame on to a consumer thread without locks.
+// Without the GL path, the CPU renderer hands its back buffer to a FrameCaptureWorker instead,
+// which runs the sinks on a thread of its own.
+
+// One captured frame: 8-bit BGRA. The GL readback delivers rows bottom to top (GL order), the
+// CPU renderer top to bottom; row() hides the difference.
+struct CapturedFrameView {
+    const uint8_t* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;           // bytes per row
+    uint64_t frameIndex = 0;  // counts rendered frames; gaps are frames that weren't captured
+    double timestampMs = 0.0; // Time::getMillisecondCounterHiRes() when the frame was rendered
+    bool topDown = false;     // row order in memory
+
+    // Row y of the picture, counted from the top
+    const uint8_t* row(int y) const noexcept
+    {
+        return pixels + (size_t)(topDown ? y : height - 1 - y) * (size_t)stride;
+    }
+};
+
+struct FrameCaptureSink {
+    // Capture (or viz) thread; copy what is needed and return, the pixels are only valid during the call
+    virtual void deliver(const CapturedFrameView& frame) = 0;
+    virtual ~FrameCaptureSink() = default;
+};
+
+// The processor's list of sinks. The readback only runs while the bus has sinks.
+// removeSink() waits for a delivery in progress, so a sink may be destroyed once it returns.
+class FrameCaptureBus {
+public:
+    void addSink(FrameCaptureSink* s)
+    {
+        const juce::ScopedLock sl(lock);
+        sinks.addIfNotAlreadyThere(s);
+        numSinks.store(sinks.size(), std::memory_order_release);
+    }
+
+    void removeSink(FrameCaptureSink* s)
+    {
+        const juce::ScopedLock sl(lock);
+        sinks.removeFirstMatchingValue(s);
+        numSinks.store(sinks.size(), std::memory_order_release);
+    }
+
+    bool hasSinks() const noexcept { return numSinks.load(std::memory_order_acquire) > 0; }
+
+    void deliver(const CapturedFrameView& frame)
+    {
+        const juce::ScopedLock sl(lock);
+        for (auto* s : sinks)
+            s->deliver(frame);
+    }
+
+private:
+    juce::CriticalSection lock;
+    juce::Array<FrameCaptureSink*> sinks; // guarded by lock
+    std::atomic<int> numSinks{ 0 };
+};
+
+// Hands captured frames from the capture thread to one consumer thread. Frames are copied into a
+// small pool allocated once per frame size; a frame that finds every pool entry still queued or
+// held by the consumer is dropped and counted, so a slow consumer never holds up rendering.
+class CaptureFrameQueue : public FrameCaptureSink {
+public:
+    static constexpr int poolSize = 4;
+
+    struct Frame {
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        uint64_t frameIndex = 0;
+        double timestampMs = 0.0;
+        bool topDown = false;
+    };
+
+    CaptureFrameQueue()
+    {
+        for (auto& s : state)
+            s.store(slotFree, std::memory_order_relaxed);
+    }
+
+    // Producer (capture thread)
+    void deliver(const CapturedFrameView& v) override
+    {
+        int slot = -1;
+        for (int i = 0; i < poolSize && slot < 0; ++i)
+            if (state[(size_t)i].load(std::memory_order_acquire) == slotFree)
+                slot = i;
+        if (slot < 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto& f = pool[(size_t)slot];
+        const size_t bytes = (size_t)v.stride * (size_t)v.height;
+        if (f.pixels.size() != bytes)
+            f.pixels.resize(bytes); // only when the frame size changes
+        std::memcpy(f.pixels.data(), v.pixels, bytes);
+        f.width = v.width;
+        f.height = v.height;
+        f.stride = v.stride;
+        f.frameIndex = v.frameIndex;
+        f.timestampMs = v.timestampMs;
+        f.topDown = v.topDown;
+        state[(size_t)slot].store(slotQueued, std::memory_order_relaxed);
+        ready.tryPush(slot); // can't be full: it holds at most poolSize entries
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer: the oldest queued frame, or nullptr. Hand it back with release() when done.
+    const Frame* tryAcquire()
+    {
+        int slot = -1;
+        if (! ready.tryPop(slot)) return nullptr;
+        return &pool[(size_t)slot];
+    }
+
+    void release(const Frame* f)
+    {
+        if (f == nullptr) return;
+        const auto slot = (size_t)(f - pool.data());
+        jassert(slot < (size_t)poolSize);
+        state[slot].store(slotFree, std::memory_order_release);
+    }
+
+    uint64_t getDeliveredFrames() const noexcept { return delivered.load(std::memory_order_relaxed); }
+    uint64_t getDroppedFrames() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int slotFree = 0;
+    static constexpr int slotQueued = 1; // in ready or held by the consumer
+
+    std::array<Frame, poolSize> pool{};
+    std::array<std::atomic<int>, poolSize> state;
+    ThreadSafeSPSCQueue<int, poolSize * 2> ready;
+    std::atomic<uint64_t> delivered{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+};
+
+// Runs the bus's sinks for a producer that mustn't wait for them: the CPU renderer, whose viz
+// thread also paces the visuals. submit() only copies the frame into a CaptureFrameQueue slot
+// (a full pool drops it) and wakes the worker thread, which delivers it to the bus. With an
+// output size set, frames are scaled to it there: CPU frames come at the surface's logical
+// size, the GL readback at the drawable's physical size, and a recording must keep one size
+// when the GL path comes and goes on a HiDPI display.
+class FrameCaptureWorker {
+public:
+    ~FrameCaptureWorker() { stop(); }
+
+    // Any thread: size the sinks get frames at; 0 x 0 passes frames through at their own size
+    void setOutputSize(int w, int h) noexcept
+    {
+        outputSize.store(((uint64_t)(uint32_t)juce::jmax(0, w) << 32) | (uint32_t)juce::jmax(0, h), std::memory_order_relaxed);
+    }
+
+    // Producer thread; the bus must outlive the worker
+    void submit(FrameCaptureBus& b, const CapturedFrameView& v)
+    {
+        bus.store(&b, std::memory_order_release);
+        if (! worker.joinable())
+        {
+            exitFlag.store(false, std::memory_order_relaxed);
+            worker = std::thread([this] { run(); });
+        }
+        queue.deliver(v);
+        wake.signal();
+    }
+
+    // Waits for a delivery in progress; frames still queued are dropped
+    void stop()
+    {
+        exitFlag.store(true, std::memory_order_relaxed);
+        wake.signal();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    uint64_t getSubmittedFrames() const noexcept { return queue.getDeliveredFrames(); }
+    uint64_t getDroppedFrames() const noexcept { return queue.getDroppedFrames(); }
+
+private:
+    void run()
+    {
+        while (! exitFlag.load(std::memory_order_relaxed))
+        {
+            const auto* f = queue.tryAcquire();
+            if (f == nullptr)
+            {
+                wake.wait(100);
+                continue;
+            }
+            deliver(*f);
+            queue.release(f);
+        }
+        while (const auto* f = queue.tryAcquire())
+            queue.release(f);
+    }
+
+    void deliver(const CaptureFrameQueue::Frame& f)
+    {
+        CapturedFrameView v;
+        v.pixels = f.pixels.data();
+        v.width = f.width;
+        v.height = f.height;
+        v.stride = f.stride;
+        v.frameIndex = f.frameIndex;
+        v.timestampMs = f.timestampMs;
+        v.topDown = f.topDown;
+        const uint64_t size = outputSize.load(std::memory_order_relaxed);
+        const int w = (int)(size >> 32), h = (int)(size & 0xffffffffu);
+        if (w > 0 && h > 0 && (w != f.width || h != f.height))
+        {
+            // Row order is kept, so topDown still describes the scaled frame
+            scaled.resize((size_t)w * (size_t)h);
+            upscaler.upscale(reinterpret_cast<const uint32_t*>(f.pixels.data()), f.width, f.height, f.stride / 4,
+                             scaled.data(), w, h, w);
+            v.pixels = reinterpret_cast<const uint8_t*>(scaled.data());
+            v.width = w;
+            v.height = h;
+            v.stride = w * 4;
+        }
+        bus.load(std::memory_order_acquire)->deliver(v);
+    }
+
+    CaptureFrameQueue queue;
+    std::atomic<FrameCaptureBus*> bus{ nullptr };
+    std::atomic<uint64_t> outputSize{ 0 };
+    std::atomic<bool> exitFlag{ false };
+    juce::WaitableEvent wake;
+    std::thread worker;
+    // Worker thread only
+    BilinearUpscaler upscaler;
+    std::vector<uint32_t> scaled;
+};
+
+} // namespace milkdawp
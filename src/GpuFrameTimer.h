@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cstdint>
+
+#if defined(_WIN32) && ! defined(_WIN64)
+ #define MDW_GL_APIENTRY __stdcall
+#else
+ #define MDW_GL_APIENTRY
+#endif
+
+namespace milkdawp {
+
+// Phase 8.1: GPU frame time.
+// The CPU-side frame time of the GL path only covers submitting projectM's work; the GPU runs
+// it later. GL_TIME_ELAPSED queries around that work measure what it costs on the GPU, and are
+// read back a few frames later so the CPU never waits for a result.
+//
+// The entry points come in through GpuTimerApi so this header needs no GL headers and the ring
+// can be tested without a context. resolve() takes any getProcAddress-style loader
+// (juce::OpenGLHelpers::getExtensionFunction, eglGetProcAddress).
+struct GpuTimerApi {
+    using GenQueries = void (MDW_GL_APIENTRY*)(int, unsigned int*);
+    using DeleteQueries = void (MDW_GL_APIENTRY*)(int, const unsigned int*);
+    using BeginQuery = void (MDW_GL_APIENTRY*)(unsigned int, unsigned int);
+    using EndQuery = void (MDW_GL_APIENTRY*)(unsigned int);
+    using GetQueryObjectuiv = void (MDW_GL_APIENTRY*)(unsigned int, unsigned int, unsigned int*);
+    using GetQueryObjectui64v = void (MDW_GL_APIENTRY*)(unsigned int, unsigned int, uint64_t*);
+
+    static constexpr unsigned int timeElapsed = 0x88BF;          // GL_TIME_ELAPSED
+    static constexpr unsigned int queryResult = 0x8866;          // GL_QUERY_RESULT
+    static constexpr unsigned int queryResultAvailable = 0x8867; // GL_QUERY_RESULT_AVAILABLE
+
+    GenQueries genQueries = nullptr;
+    DeleteQueries deleteQueries = nullptr;
+    BeginQuery beginQuery = nullptr;
+    EndQuery endQuery = nullptr;
+    GetQueryObjectuiv getQueryObjectuiv = nullptr;
+    GetQueryObjectui64v getQueryObjectui64v = nullptr;
+
+    bool isComplete() const noexcept
+    {
+        return genQueries != nullptr && deleteQueries != nullptr && beginQuery != nullptr && endQuery != nullptr
+            && getQueryObjectuiv != nullptr && getQueryObjectui64v != nullptr;
+    }
+
+    // GL 3.3 / ARB_timer_query, falling back to EXT_timer_query's 64-bit getter
+    template <typename Loader>
+    static GpuTimerApi resolve(Loader&& getProc)
+    {
+        GpuTimerApi a;
+        a.genQueries = reinterpret_cast<GenQueries>(getProc("glGenQueries"));
+        a.deleteQueries = reinterpret_cast<DeleteQueries>(getProc("glDeleteQueries"));
+        a.beginQuery = reinterpret_cast<BeginQuery>(getProc("glBeginQuery"));
+        a.endQuery = reinterpret_cast<EndQuery>(getProc("glEndQuery"));
+        a.getQueryObjectuiv = reinterpret_cast<GetQueryObjectuiv>(getProc("glGetQueryObjectuiv"));
+        a.getQueryObjectui64v = reinterpret_cast<GetQueryObjectui64v>(getProc("glGetQueryObjectui64v"));
+        if (a.getQueryObjectui64v == nullptr)
+            a.getQueryObjectui64v = reinterpret_cast<GetQueryObjectui64v>(getProc("glGetQueryObjectui64vEXT"));
+        return a;
+    }
+};
+
+// Ring of timer queries in one GL context (query objects aren't shared between contexts). Each
+// timed frame takes the next query; results are collected oldest first once the GPU has them.
+// If all queries are still in flight, begin() declines and that frame goes untimed rather than
+// waiting on the GPU. All calls on the thread the context is current on.
+class GpuTimerRing {
+public:
+    static constexpr int depth = 4; // timed frames in flight before frames go untimed
+    static constexpr double maxPlausibleMs = 1000.0;
+
+    bool create(const GpuTimerApi& a)
+    {
+        destroy();
+        if (! a.isComplete()) return false;
+        api = a;
+        api.genQueries(depth, ids.data());
+        created = true;
+        return true;
+    }
+
+    // Context current (or gone, in which case the queries went with it: pass false)
+    void destroy(bool contextAlive = true)
+    {
+        if (created && contextAlive)
+            api.deleteQueries(depth, ids.data());
+        created = false;
+        active = false;
+        first = pending = 0;
+    }
+
+    bool isCreated() const noexcept { return created; }
+
+    // Starts timing the GL work that follows; false if the frame can't be timed
+    bool begin(uint64_t frameId)
+    {
+        if (! created || active) return false;
+        if (pending == depth)
+        {
+            ++skipped;
+            return false;
+        }
+        const int slot = (first + pending) % depth;
+        frameIds[(size_t)slot] = frameId;
+        api.beginQuery(GpuTimerApi::timeElapsed, ids[(size_t)slot]);
+        active = true;
+        return true;
+    }
+
+    void end()
+    {
+        if (! active) return;
+        api.endQuery(GpuTimerApi::timeElapsed);
+        active = false;
+        ++pending;
+    }
+
+    // Hands every result the GPU has finished to f(frameId, gpuMs), oldest first, without
+    // waiting. Returns the number of results delivered. Implausible results are dropped (Mesa's
+    // llvmpipe has been seen to return garbage for the first query of a context).
+    template <typename Fn>
+    int collect(Fn&& f)
+    {
+        int n = 0;
+        while (created && ! active && pending > 0)
+        {
+            const unsigned int id = ids[(size_t)first];
+            unsigned int available = 0;
+            api.getQueryObjectuiv(id, GpuTimerApi::queryResultAvailable, &available);
+            if (available == 0) break;
+            uint64_t ns = 0;
+            api.getQueryObjectui64v(id, GpuTimerApi::queryResult, &ns);
+            const double ms = (double)ns * 1.0e-6;
+            if (ms <= maxPlausibleMs)
+            {
+                f(frameIds[(size_t)first], ms);
+                ++n;
+            }
+            first = (first + 1) % depth;
+            --pending;
+        }
+        return n;
+    }
+
+    int inFlight() const noexcept { return pending; }
+    uint64_t getSkippedFrames() const noexcept { return skipped; }
+
+private:
+    GpuTimerApi api;
+    std::array<unsigned int, depth> ids{};
+    std::array<uint64_t, depth> frameIds{};
+    bool created = false;
+    bool active = false;   // between begin() and end()
+    int first = 0;         // oldest query still in flight
+    int pending = 0;       // queries ended but not collected
+    uint64_t skipped = 0;  // frames begin() declined
+};
+
+// Adds up the parts of a frame timed in different contexts (the render host and the canvas).
+// close() announces how many timed parts a frame has; add() returns true with the frame's total
+// once its last part arrived. Frames with a missing part (one ring skipped it) are overwritten
+// by later frames.
+class GpuFrameTimeAccumulator {
+public:
+    static constexpr int capacity = 8;
+
+    // At the end of the frame; its parts are collected in later frames
+    void close(uint64_t frameId, int parts)
+    {
+        entries[(size_t)(frameId % capacity)] = Entry{ frameId, parts, 0, 0.0 };
+    }
+
+    bool add(uint64_t frameId, double ms, double& frameMs)
+    {
+        auto& e = entries[(size_t)(frameId % capacity)];
+        if (e.frameId != frameId) return false; // overwritten: a part went missing
+        e.totalMs += ms;
+        if (++e.received < e.expected) return false;
+        frameMs = e.totalMs;
+        e = Entry{};
+        return true;
+    }
+
+private:
+    struct Entry {
+        uint64_t frameId = ~(uint64_t)0;
+        int expected = 0;
+        int received = 0;
+        double totalMs = 0.0;
+    };
+    std::array<Entry, capacity> entries{};
+};
+
+} // namespace milkdawp
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace milkdawp {
+
+// Polyphase half-band FIR decimator (2:1).
+// A half-band filter has every other coefficient equal to zero except the centre tap (0.5),
+// so the polyphase split leaves one short FIR on the even input phase and a pure delay on the
+// odd phase. Each output costs evenTaps multiplies for two input samples.
+class HalfBandDecimator {
+public:
+    // Number of non-zero taps on the even phase; full filter length is 2 * evenTaps - 1.
+    static constexpr int evenTaps = 24;
+    static constexpr int filterLength = 2 * evenTaps - 1;
+    static constexpr int oddDelay = evenTaps / 2;
+
+    HalfBandDecimator() { designCoefficients(); reset(); }
+
+    void reset()
+    {
+        evenHistory.fill(0.0f);
+        oddHistory.fill(0.0f);
+        evenPos = 0;
+        oddPos = 0;
+        phase = 0;
+    }
+
+    // Push one input sample; returns true and writes out when an output sample is ready.
+    bool push(float x, float& out) noexcept
+    {
+        if (phase == 1)
+        {
+            // Odd phase only feeds the centre-tap delay line
+            oddHistory[(size_t)oddPos] = x;
+            oddPos = (oddPos + 1) % oddDelay;
+            phase = 0;
+            return false;
+        }
+
+        // Even phase: write twice so the dot product can read a contiguous window
+        evenPos = (evenPos == 0) ? evenTaps - 1 : evenPos - 1;
+        evenHistory[(size_t)evenPos] = x;
+        evenHistory[(size_t)(evenPos + evenTaps)] = x;
+
+        const float* h = evenHistory.data() + evenPos;
+        float acc = 0.0f;
+        for (int k = 0; k < evenTaps; ++k)
+            acc += coeffs[(size_t)k] * h[k];
+
+        // Centre tap: oldest entry of the odd delay line, i.e. x[2m - (evenTaps - 1)]
+        acc += 0.5f * oddHistory[(size_t)oddPos];
+
+        out = acc;
+        phase = 1;
+        return true;
+    }
+
+    const std::array<float, evenTaps>& getCoefficients() const noexcept { return coeffs; }
+
+private:
+    void designCoefficients()
+    {
+        // Blackman-windowed sinc, cutoff at a quarter of the input rate.
+        // Only the even-phase (non-zero) taps are stored; h[c] = 0.5 lives on the odd phase.
+        constexpr double pi = 3.14159265358979323846;
+        const int centre = evenTaps - 1;                 // index of the 0.5 tap in the full filter
+        double sum = 0.0;
+        std::array<double, evenTaps> tmp{};
+        for (int k = 0; k < evenTaps; ++k)
+        {
+            const int n = 2 * k;                         // even full-filter index
+            const double m = (double)(n - centre);       // always odd, so never the centre
+            const double sinc = std::sin(pi * m * 0.5) / (pi * m);
+            const double w = 0.42 - 0.5 * std::cos(2.0 * pi * n / (filterLength - 1))
+                                  + 0.08 * std::cos(4.0 * pi * n / (filterLength - 1));
+            tmp[(size_t)k] = sinc * w;
+            sum += tmp[(size_t)k];
+        }
+        // Normalise even phase to 0.5 so DC gain (even + centre) is exactly 1
+        for (int k = 0; k < evenTaps; ++k)
+            coeffs[(size_t)k] = (float)(tmp[(size_t)k] * (0.5 / sum));
+    }
+
+    std::array<float, evenTaps> coeffs{};
+    std::array<float, evenTaps * 2> evenHistory{};
+    std::array<float, oddDelay> oddHistory{};
+    int evenPos = 0;
+    int oddPos = 0;
+    int phase = 0;
+};
+
+// Cascade of half-band stages that brings any host rate down to the fixed analysis range
+// (<= maxAnalysisRate). 44.1/48 kHz pass through untouched; 88.2/96 kHz use one stage,
+// 176.4/192 kHz two, 352.8/384 kHz three.
+class AnalysisDecimator {
+public:
+    static constexpr double maxAnalysisRate = 50000.0;
+    static constexpr int maxStages = 3;
+
+    void prepare(double hostSampleRate)
+    {
+        numStages = 0;
+        double rate = hostSampleRate > 0.0 ? hostSampleRate : 44100.0;
+        while (rate > maxAnalysisRate && numStages < maxStages)
+        {
+            rate *= 0.5;
+            ++numStages;
+        }
+        outputRate = rate;
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& s : stages)
+            s.reset();
+    }
+
+    // Push one host-rate sample; returns true when an analysis-rate sample is produced.
+    bool push(float x, float& out) noexcept
+    {
+        for (int i = 0; i < numStages; ++i)
+            if (! stages[(size_t)i].push(x, x))
+                return false;
+        out = x;
+        return true;
+    }
+
+    int getNumStages() const noexcept { return numStages; }
+    int getDecimationFactor() const noexcept { return 1 << numStages; }
+    double getOutputRate() const noexcept { return outputRate; }
+
+private:
+    std::array<HalfBandDecimator, maxStages> stages;
+    int numStages = 0;
+    double outputRate = 44100.0;
+};
+
+} // namespace milkdawp
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace milkdawp {
+
+// Single-producer PCM ring for interleaved stereo float, audio thread -> GL thread.
+// The write position is an absolute frame counter, so a consumer can keep its own cursor and
+// take exactly the frames written since its last read (readNew) instead of re-reading a fixed
+// window that overlaps the previous one. copyLatest keeps the "last N frames" view for callers
+// that want a window. Nothing allocates after init().
+class PcmRing {
+public:
+    // Consumer state for readNew. Detached cursors attach at the current write position,
+    // i.e. the first read after attaching returns only audio written after it.
+    struct ReadCursor {
+        uint64_t position = 0;
+        bool attached = false;
+        uint64_t droppedFrames = 0; // frames skipped because the reader fell behind the writer
+        void detach() noexcept { attached = false; }
+    };
+
+    void init(size_t framesCapacity)
+    {
+        capacityFrames = framesCapacity > 0 ? framesCapacity : 1;
+        data.assign(capacityFrames * 2, 0.0f);
+        written.store(0, std::memory_order_relaxed);
+    }
+
+    size_t getCapacityFrames() const noexcept { return capacityFrames; }
+    uint64_t getWritePosition() const noexcept { return written.load(std::memory_order_acquire); }
+
+    void pushInterleaved(const float* interleavedStereo, int frames) noexcept
+    {
+        if (! interleavedStereo || frames <= 0 || capacityFrames == 0) return;
+        const uint64_t w = written.load(std::memory_order_relaxed);
+        for (int i = 0; i < frames; ++i)
+        {
+            const size_t pos = (size_t)((w + (uint64_t)i) % capacityFrames) * 2;
+            data[pos + 0] = interleavedStereo[(size_t)i * 2 + 0];
+            data[pos + 1] = interleavedStereo[(size_t)i * 2 + 1];
+        }
+        written.store(w + (uint64_t)frames, std::memory_order_release);
+    }
+
+    // Planar input interleaved on the way in: right == nullptr duplicates left, both null write silence
+    void pushPlanar(const float* left, const float* right, int frames) noexcept
+    {
+        if (frames <= 0 || capacityFrames == 0) return;
+        if (left == nullptr) std::swap(left, right);
+        if (right == nullptr) right = left;
+        const uint64_t w = written.load(std::memory_order_relaxed);
+        for (int i = 0; i < frames; ++i)
+        {
+            const size_t pos = (size_t)((w + (uint64_t)i) % capacityFrames) * 2;
+            data[pos + 0] = left != nullptr ? left[i] : 0.0f;
+            data[pos + 1] = right != nullptr ? right[i] : 0.0f;
+        }
+        written.store(w + (uint64_t)frames, std::memory_order_release);
+    }
+
+    // Last desiredFrames frames (zero-padded at the front before that much has been written)
+    void copyLatest(int desiredFrames, std::vector<float>& out) const
+    {
+        out.resize((size_t)juce::jmax(0, desiredFrames) * 2);
+        if (capacityFrames == 0 || desiredFrames <= 0) { std::fill(out.begin(), out.end(), 0.0f); return; }
+        const uint64_t w = written.load(std::memory_order_acquire);
+        const uint64_t frames = (uint64_t)juce::jmin((int)capacityFrames, desiredFrames);
+        const uint64_t pad = frames > w ? frames - w : 0;
+        std::fill(out.begin(), out.begin() + (std::ptrdiff_t)(pad * 2), 0.0f);
+        copyRange(w - (frames - pad), (size_t)(frames - pad), out.data() + pad * 2);
+    }
+
+    // Frames written since the cursor's last read, up to maxFrames, into out (interleaved,
+    // room for maxFrames * 2 floats). Returns the number of frames copied; the rest stay for the
+    // next call. If the writer got more than half the ring ahead, the oldest frames are skipped
+    // (counted in droppedFrames) so the copy never races the writer.
+    int readNew(ReadCursor& cursor, float* out, int maxFrames) const noexcept
+    {
+        const uint64_t w = written.load(std::memory_order_acquire);
+        if (! cursor.attached)
+        {
+            cursor.position = w;
+            cursor.attached = true;
+            return 0;
+        }
+        if (cursor.position > w) cursor.position = w; // ring was re-initialised
+
+        const uint64_t maxLag = (uint64_t)(capacityFrames / 2);
+        if (w - cursor.position > maxLag)
+        {
+            cursor.droppedFrames += (w - cursor.position) - maxLag;
+            cursor.position = w - maxLag;
+        }
+        const uint64_t n = juce::jmin(w - cursor.position, (uint64_t)juce::jmax(0, maxFrames));
+        copyRange(cursor.position, (size_t)n, out);
+        cursor.position += n;
+        return (int)n;
+    }
+
+private:
+    void copyRange(uint64_t start, size_t frames, float* out) const noexcept
+    {
+        // At most two contiguous spans
+        size_t pos = (size_t)(start % capacityFrames);
+        while (frames > 0)
+        {
+            const size_t span = juce::jmin(frames, capacityFrames - pos);
+            std::copy(data.begin() + (std::ptrdiff_t)(pos * 2), data.begin() + (std::ptrdiff_t)((pos + span) * 2), out);
+            out += span * 2;
+            frames -= span;
+            pos = 0;
+        }
+    }
+
+    std::vector<float> data; // capacityFrames * 2
+    size_t capacityFrames = 0;
+    std::atomic<uint64_t> written{ 0 }; // absolute frames written
+};
+
+} // namespace milkdawp
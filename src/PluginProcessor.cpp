@@ -9,7 +9,22 @@
 #include "Logging.h"
 #include "BinaryData.h"
 #include "AudioAnalysisQueue.h"
+#include "AudioAnalyzer.h"
+#include "SimdDispatch.h"
+#include "AvSync.h"
 #include "VisualizationThread.h"
+#include "RenderScale.h"
+#include "AsyncPresetLoader.h"
+#include "PresetPrefetcher.h"
+#include "PresetFolderScan.h"
+#include "PresetCostProfile.h"
+#include "GpuFrameTimer.h"
+#include "BackgroundGLContext.h"
+#include "RenderHost.h"
+#include "FrameCapture.h"
+#include "SharedFrameOutput.h"
+#include "Y4mRecorder.h"
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <cstring>
@@ -129,6 +144,7 @@ namespace {
     typedef void (*PFN_PM_SET_FPS)(projectm_handle, int);
     typedef void (*PFN_PM_SET_ASPECT)(projectm_handle, bool);
     typedef void (*PFN_PM_LOAD_PRESET_FILE)(projectm_handle, const char*, bool);
+    typedef void (*PFN_PM_LOAD_PRESET_DATA)(projectm_handle, const char*, bool);
     typedef void (*PFN_PM_OPENGL_RENDER_FRAME)(projectm_handle);
     typedef void (*PFN_PM_SET_BEAT_SENSITIVITY)(projectm_handle, float);
     typedef void (*PFN_PM_SET_HARD_CUT_ENABLED)(projectm_handle, bool);
@@ -137,6 +153,8 @@ namespace {
     typedef void (*PFN_PM_SET_PRESET_DURATION)(projectm_handle, double);
     typedef void (*PFN_PM_SET_SOFT_CUT_DURATION)(projectm_handle, double);
     typedef void (*PFN_PM_SET_PRESET_SWITCH_CB)(projectm_handle, void(*)(bool, void*), void*);
+    typedef void (*PFN_PM_SET_MESH_SIZE)(projectm_handle, size_t, size_t);
+    typedef void (*PFN_PM_OPENGL_RENDER_FRAME_FBO)(projectm_handle, uint32_t);
 
    #ifdef _WIN32
     static HMODULE g_pmModule = nullptr;
@@ -149,6 +167,7 @@ namespace {
     static PFN_PM_SET_FPS               g_pm_set_fps = nullptr;
     static PFN_PM_SET_ASPECT            g_pm_set_aspect = nullptr;
     static PFN_PM_LOAD_PRESET_FILE      g_pm_load_preset_file = nullptr;
+    static PFN_PM_LOAD_PRESET_DATA      g_pm_load_preset_data = nullptr;
     static PFN_PM_OPENGL_RENDER_FRAME   g_pm_opengl_render_frame = nullptr;
     static PFN_PM_SET_BEAT_SENSITIVITY     g_pm_set_beat_sensitivity     = nullptr;
     static PFN_PM_SET_HARD_CUT_ENABLED     g_pm_set_hard_cut_enabled     = nullptr;
@@ -157,6 +176,240 @@ namespace {
     static PFN_PM_SET_PRESET_DURATION      g_pm_set_preset_duration      = nullptr;
     static PFN_PM_SET_SOFT_CUT_DURATION    g_pm_set_soft_cut_duration    = nullptr;
     static PFN_PM_SET_PRESET_SWITCH_CB     g_pm_set_preset_switch_cb     = nullptr;
+    static PFN_PM_SET_MESH_SIZE            g_pm_set_mesh_size            = nullptr;
+    static PFN_PM_OPENGL_RENDER_FRAME_FBO  g_pm_opengl_render_frame_fbo  = nullptr;
+}
+#endif
+
+#if MILKDAWP_HAS_PROJECTM
+namespace {
+    // RenderHost's GL work (see RenderHostGl), in whichever context is current when it runs
+    milkdawp::RenderHostGl renderHostGl()
+    {
+        using namespace juce::gl;
+        milkdawp::RenderHostGl a;
+        a.fenceSync = [] { return (void*) glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); };
+        a.waitSync = [](void* f) { glWaitSync((GLsync) f, 0, GL_TIMEOUT_IGNORED); };
+        a.deleteSync = [](void* f) { glDeleteSync((GLsync) f); };
+        a.flush = [] { glFlush(); };
+        a.allocateTarget = [](unsigned int& fbo, unsigned int& tex, int w, int h) {
+            if (fbo == 0) {
+                glGenTextures(1, &tex);
+                glGenFramebuffers(1, &fbo);
+            }
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+        };
+        a.deleteTarget = [](unsigned int fbo, unsigned int tex) {
+            glDeleteFramebuffers(1, &fbo);
+            glDeleteTextures(1, &tex);
+        };
+        a.buildLevels = [](unsigned int tex, int levels) {
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        };
+        a.blitToDrawable = [](unsigned int& readFbo, unsigned int tex, int level, bool attach,
+                              int srcW, int srcH, int drawW, int drawH) {
+            if (readFbo == 0) glGenFramebuffers(1, &readFbo);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+            if (attach)
+                glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, level);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            const bool sameSize = srcW == drawW && srcH == drawH;
+            glBlitFramebuffer(0, 0, srcW, srcH, 0, 0, drawW, drawH, GL_COLOR_BUFFER_BIT, sameSize ? GL_NEAREST : GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, drawW, drawH);
+        };
+        a.deleteFramebuffer = [](unsigned int fbo) { glDeleteFramebuffers(1, &fbo); };
+        return a;
+    }
+
+    // projectM's own context, sharing with the canvas (see RenderHost.h)
+    using RenderHost = milkdawp::BasicRenderHost<milkdawp::BackgroundGLContext>;
+
+    // Reads the canvas's finished frames back to the CPU for the processor's FrameCaptureBus
+    // without stalling the pipeline. Each captured frame is copied into the next of readSlots
+    // pixel pack buffers (glReadPixels into a PBO returns at once) and fenced; a buffer is only
+    // mapped once its fence has signalled, which is normally two frames later, so frame N is
+    // read while frame N + 2 renders. The mapped buffer goes to a capture thread that runs the
+    // sinks (the copy out of an HD frame takes about a millisecond) and is unmapped by the GL
+    // thread on a later frame, so the GL thread only issues the read, polls a fence and maps.
+    // If no buffer is free the frame isn't captured.
+    // capture()/release(): GL thread, canvas context current.
+    class FrameReadback
+    {
+    public:
+        static constexpr int readSlots = 3;
+
+        ~FrameReadback() { jassert(! isCreated()); }
+
+        bool isCreated() const noexcept { return slots[0].pbo != 0; }
+
+        // After the frame is complete in the back buffer: recycles the buffer the capture thread
+        // is done with, hands it the oldest finished copy, then queues the current frame
+        void capture(milkdawp::FrameCaptureBus& bus, int w, int h, uint64_t frameIndex, double timestampMs)
+        {
+            using namespace juce::gl;
+            const double t0 = juce::Time::getMillisecondCounterHiRes();
+            if (! isCreated()) {
+                for (auto& s : slots)
+                    glGenBuffers(1, &s.pbo);
+                exitFlag.store(false, std::memory_order_relaxed);
+                worker = std::thread([this] { run(); });
+                MDW_LOG_INFO("Frame capture: PBO readback started");
+            }
+            if (mapped && jobDone.load(std::memory_order_acquire))
+                unmapOldest();
+            if (! mapped && pending > 0)
+                mapOldestIfFinished(bus);
+
+            if (pending == readSlots) {
+                ++skipped;
+                spentMs += juce::Time::getMillisecondCounterHiRes() - t0;
+                return;
+            }
+            auto& s = slots[(size_t) ((first + pending) % readSlots)];
+            const int stride = w * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+            if (s.w != w || s.h != h) {
+                glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) stride * h, nullptr, GL_STREAM_READ);
+                s.w = w;
+                s.h = h;
+            }
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glReadPixels(0, 0, w, h, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            s.done = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            s.frameIndex = frameIndex;
+            s.timestampMs = timestampMs;
+            ++pending;
+            ++queued;
+            spentMs += juce::Time::getMillisecondCounterHiRes() - t0;
+        }
+
+        // Context current (or gone: pass false); waits for the capture thread, frames still in
+        // flight are dropped
+        void release(bool contextAlive = true)
+        {
+            using namespace juce::gl;
+            exitFlag.store(true, std::memory_order_relaxed);
+            wake.signal();
+            if (worker.joinable())
+                worker.join();
+            if (mapped && contextAlive) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[(size_t) first].pbo);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            }
+            for (auto& s : slots) {
+                if (contextAlive) {
+                    if (s.done != nullptr) glDeleteSync(s.done);
+                    if (s.pbo != 0) glDeleteBuffers(1, &s.pbo);
+                }
+                s = Slot{};
+            }
+            if (queued > 0)
+                MDW_LOG_INFO(juce::String("Frame capture: stopped after ") + juce::String((juce::int64) queued) + " frames, "
+                             + juce::String(spentMs / (double) (queued + skipped), 3) + " ms per frame on the GL thread, "
+                             + juce::String((juce::int64) skipped) + " skipped while the GPU or the sinks were behind");
+            first = pending = 0;
+            mapped = false;
+            jobReady.store(false, std::memory_order_relaxed);
+            queued = skipped = 0;
+            spentMs = 0.0;
+        }
+
+    private:
+        void mapOldestIfFinished(milkdawp::FrameCaptureBus& bus)
+        {
+            using namespace juce::gl;
+            auto& s = slots[(size_t) first];
+            const GLenum r = glClientWaitSync(s.done, 0, 0);
+            if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED)
+                return; // still copying; never wait for it
+            glDeleteSync(s.done);
+            s.done = nullptr;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+            const GLsizeiptr bytes = (GLsizeiptr) s.w * 4 * s.h;
+            const auto* p = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            if (p == nullptr) {
+                retireOldest();
+                return;
+            }
+            job.pixels = p;
+            job.width = s.w;
+            job.height = s.h;
+            job.stride = s.w * 4;
+            job.frameIndex = s.frameIndex;
+            job.timestampMs = s.timestampMs;
+            jobBus = &bus;
+            mapped = true;
+            jobDone.store(false, std::memory_order_relaxed);
+            jobReady.store(true, std::memory_order_release);
+            wake.signal();
+        }
+
+        void unmapOldest()
+        {
+            using namespace juce::gl;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[(size_t) first].pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            mapped = false;
+            retireOldest();
+        }
+
+        void retireOldest()
+        {
+            first = (first + 1) % readSlots;
+            --pending;
+        }
+
+        // Capture thread: runs the sinks on the mapped buffer
+        void run()
+        {
+            while (! exitFlag.load(std::memory_order_relaxed)) {
+                if (! jobReady.exchange(false, std::memory_order_acquire)) {
+                    wake.wait(100);
+                    continue;
+                }
+                jobBus->deliver(job);
+                jobDone.store(true, std::memory_order_release);
+            }
+        }
+
+        struct Slot {
+            GLuint pbo = 0;
+            int w = 0, h = 0;                      // size the buffer was allocated for
+            GLsync done = nullptr;                 // the copy into pbo has finished
+            uint64_t frameIndex = 0;
+            double timestampMs = 0.0;
+        };
+        Slot slots[readSlots];
+        int first = 0;                             // oldest pending copy (the mapped one, if any)
+        int pending = 0;
+        bool mapped = false;                       // slots[first] is mapped and owned by the capture thread
+        uint64_t queued = 0, skipped = 0;
+        double spentMs = 0.0;                      // GL thread time in capture(), for the log
+
+        milkdawp::CapturedFrameView job;           // written by the GL thread before jobReady
+        milkdawp::FrameCaptureBus* jobBus = nullptr;
+        std::atomic<bool> jobReady{ false };
+        std::atomic<bool> jobDone{ false };
+        std::atomic<bool> exitFlag{ false };
+        juce::WaitableEvent wake;
+        std::thread worker;
+    };
 }
 #endif
 
@@ -172,6 +425,7 @@ public:
     #if MILKDAWP_ENABLE_VIZ_THREAD
         if (!vizThread)
             vizThread = std::make_unique<milkdawp::VisualizationThread>(analysisQueue);
+        connectVizSync();
         vizThread->start();
         // Make sure visualization thread has latest params and preset
         sendAllParamsToViz();
@@ -179,6 +433,95 @@ public:
             vizThread->postLoadPreset(currentPresetPath);
     #endif
     }
+
+    // A/V offset in ms added on top of the measured output latency (editor setting).
+    // Positive values delay the visuals, negative values show them earlier.
+    void setAvOffsetMs(double ms) {
+        avOffsetMs.store(ms, std::memory_order_relaxed);
+        if (vizThread)
+            vizThread->setAvOffsetMs(ms);
+    }
+    double getAvOffsetMs() const { return avOffsetMs.load(std::memory_order_relaxed); }
+
+    // Adaptive quality degradation order (editor setting): keep the frame rate or the resolution
+    void setQualityPolicy(milkdawp::QualityPolicy p) {
+        qualityPolicy = p;
+        if (vizThread)
+            vizThread->setQualityPolicy(p);
+    }
+    milkdawp::QualityPolicy getQualityPolicy() const { return qualityPolicy; }
+
+    // Shuffle and auto-advance pass over presets whose recorded render cost (PresetCostProfile)
+    // overruns the current adaptive quality rung's frame budget (editor setting)
+    void setSkipHeavyPresets(bool skip) {
+        if (skipHeavyPresets == skip) return;
+        skipHeavyPresets = skip;
+        upcomingShuffle_.clear();
+        schedulePrefetch();
+    }
+    bool getSkipHeavyPresets() const { return skipHeavyPresets; }
+
+    // Publish the rendered frames to a shared-memory segment for local compositors (editor
+    // setting). The segment is "/milkdawp", or "/milkdawp-2"... while another instance holds it.
+    bool setSharedFrameOutput(bool enabled) {
+       #if MDW_HAS_SHARED_FRAME_OUTPUT
+        // A writer that stopped on a failed regrow is replaced when the output is enabled again
+        if (sharedFrameWriter != nullptr && (! enabled || sharedFrameWriter->hasFailed())) {
+            frameCaptureBus.removeSink(sharedFrameWriter.get());
+            sharedFrameWriter.reset();
+        }
+        if (! enabled || sharedFrameWriter != nullptr) return true;
+        auto writer = std::make_unique<milkdawp::SharedFrameWriter>();
+        if (! writer->open("/milkdawp")) return false;
+        sharedFrameWriter = std::move(writer);
+        frameCaptureBus.addSink(sharedFrameWriter.get());
+        return true;
+       #else
+        juce::ignoreUnused(enabled);
+        return false;
+       #endif
+    }
+    bool getSharedFrameOutput() const { return sharedFrameWriter != nullptr && ! getSharedFrameOutputFailed(); }
+    // The output was on but stopped publishing (see SharedFrameWriter::hasFailed)
+    bool getSharedFrameOutputFailed() const {
+       #if MDW_HAS_SHARED_FRAME_OUTPUT
+        if (sharedFrameWriter != nullptr) return sharedFrameWriter->hasFailed();
+       #endif
+        return false;
+    }
+    juce::String getSharedFrameOutputName() const {
+       #if MDW_HAS_SHARED_FRAME_OUTPUT
+        if (sharedFrameWriter != nullptr) return sharedFrameWriter->getName();
+       #endif
+        return {};
+    }
+
+    // Live recording of the visuals to a .y4m file (editor settings), at the viz target frame rate.
+    // Frames come through the capture bus: the GL readback, or the CPU renderer without it.
+    bool startRecording(const juce::File& file) {
+        if (videoRecorder != nullptr) return false;
+        auto rec = std::make_unique<milkdawp::Y4mRecorder>();
+        if (! rec->start(file, vizThread ? vizThread->getTargetFps() : 60.0)) return false;
+        videoRecorder = std::move(rec);
+        frameCaptureBus.addSink(videoRecorder.get());
+        return true;
+    }
+    void stopRecording() {
+        if (videoRecorder == nullptr) return;
+        frameCaptureBus.removeSink(videoRecorder.get());
+        videoRecorder->stop(); // writes out the queued frames
+        videoRecorder.reset();
+    }
+    bool isRecording() const { return videoRecorder != nullptr; }
+    // Null while not recording
+    const milkdawp::Y4mRecorder* getVideoRecorder() const { return videoRecorder.get(); }
+
+    // Priority of this instance in the process-wide render budget (editor focus/fullscreen state)
+    void setVizBudgetPriority(milkdawp::QualityBudgetCoordinator::Priority p) {
+        vizBudgetPriority = p;
+        if (vizThread)
+            vizThread->setBudgetPriority(p);
+    }
 public:
     struct AutoAdvanceTimer : juce::Timer {
         MilkDAWpAudioProcessor& proc;
@@ -190,6 +533,10 @@ public:
     APVTS& getValueTreeState() noexcept { return apvts; }
     milkdawp::VisualizationThread* getVizThread() noexcept { return vizThread.get(); }
     juce::String getCurrentPresetPath() const noexcept { return currentPresetPath; }
+    // Upcoming playlist presets, read ahead of the switch (consumed by the GL preset loader)
+    milkdawp::PresetPrefetcher& getPresetPrefetcher() noexcept { return presetPrefetcher; }
+    // Consumers of the rendered frames (read back by the GL canvas while any are registered)
+    milkdawp::FrameCaptureBus& getFrameCaptureBus() noexcept { return frameCaptureBus; }
     void setCurrentPresetPathAndPostLoad(const juce::String& path)
     {
         if (path == currentPresetPath)
@@ -251,9 +598,7 @@ public:
     MilkDAWpAudioProcessor()
     : juce::AudioProcessor(BusesProperties().withInput("Input", juce::AudioChannelSet::stereo(), true)
                                              .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      apvts(*this, nullptr, "Params", createParameterLayout()),
-      fft(milkdawp::AudioAnalysisSnapshot::fftOrder),
-      window(milkdawp::AudioAnalysisSnapshot::fftSize, juce::dsp::WindowingFunction<float>::hann, true)
+      apvts(*this, nullptr, "Params", createParameterLayout())
     {
         milkdawp::Logging::init("MilkDAWp", MILKDAWP_VERSION_STRING);
         MDW_LOG_INFO("AudioProcessor constructed");
@@ -300,10 +645,6 @@ public:
            #endif
         }
        #endif
-        fftBuffer.malloc(milkdawp::AudioAnalysisSnapshot::fftSize * 2);
-        monoAccum.resize(milkdawp::AudioAnalysisSnapshot::fftSize);
-        energyHistory.fill(0.0f);
-
         // Register parameter listeners for wiring to visualization thread
         apvts.addParameterListener("beatSensitivity", this);
         apvts.addParameterListener("transitionDurationSeconds", this);
@@ -320,10 +661,15 @@ public:
         apvts.addParameterListener("transitionJitterEnabled", this);
         apvts.addParameterListener("transitionDurationMin", this);
         apvts.addParameterListener("transitionDurationMax", this);
+
+        milkdawp::PresetCostProfile::instance().ensureLoaded();
     }
 
     ~MilkDAWpAudioProcessor() override {
         if (vizThread) vizThread->stop();
+        setSharedFrameOutput(false);
+        stopRecording();
+        milkdawp::PresetCostProfile::instance().saveIfDirty();
         apvts.removeParameterListener("beatSensitivity", this);
         apvts.removeParameterListener("transitionDurationSeconds", this);
         apvts.removeParameterListener("shuffle", this);
@@ -340,12 +686,12 @@ public:
     const juce::String getName() const override { return "MilkDAWp"; }
 
     void prepareToPlay(double sampleRate, int /*samplesPerBlockExpected*/) override {
-        juce::ignoreUnused(sampleRate);
-        fftWritePos = 0;
-        runningSamplePos = 0;
-        energyIndex = 0;
-        energyAverage = 0.0f;
-        beatCooldown = 0;
+        // Analysis runs at a fixed internal rate; decimate high host rates before the FFT
+        analyzer.prepare(sampleRate);
+        MDW_LOG_INFO(juce::String("Analysis rate: ") + juce::String(analyzer.getAnalysisRate(), 0)
+                     + " Hz (host " + juce::String(sampleRate, 0) + " Hz, decimation x"
+                     + juce::String(analyzer.getDecimationFactor()) + ")");
+        audioClock.reset();
         analysisQueue.clear();
 #if !defined(MILKDAWP_ENABLE_VIZ_THREAD)
 #define MILKDAWP_ENABLE_VIZ_THREAD 1
@@ -353,6 +699,7 @@ public:
 #if MILKDAWP_ENABLE_VIZ_THREAD
         if (!vizThread)
             vizThread = std::make_unique<milkdawp::VisualizationThread>(analysisQueue);
+        connectVizSync();
         vizThread->start();
         // If a preset path was already selected (e.g., user loaded before audio started or restored state),
         // post it now so the viz thread applies it immediately.
@@ -380,66 +727,32 @@ public:
 
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override {
         juce::ScopedNoDenormals noDenormals;
+        const double blockStartSec = juce::Time::getMillisecondCounterHiRes() * 0.001;
 
         // Zero-latency passthrough: ensure extra outputs are cleared
         for (int ch = getTotalNumInputChannels(); ch < getTotalNumOutputChannels(); ++ch)
             buffer.clear(ch, 0, buffer.getNumSamples());
 
-        // Mix to mono into accumulator and produce analysis snapshots per 1024-sample window
+        // Mix to mono, decimate to the analysis rate and produce snapshots per 1024-sample window
         const int numInCh = juce::jmin(2, getTotalNumInputChannels());
         const int N = buffer.getNumSamples();
         const float* in0 = numInCh > 0 ? buffer.getReadPointer(0) : nullptr;
         const float* in1 = numInCh > 1 ? buffer.getReadPointer(1) : nullptr;
 
-        int i = 0;
-        while (i < N) {
-            const int space = milkdawp::AudioAnalysisSnapshot::fftSize - fftWritePos;
-            const int toCopy = juce::jmin(space, N - i);
-
-            for (int n = 0; n < toCopy; ++n) {
-                float s = 0.0f;
-                if (in0) s += in0[i + n];
-                if (in1) s += in1[i + n];
-                if (numInCh > 1) s *= 0.5f; // average if stereo
-                monoAccum[(size_t)(fftWritePos + n)] = s;
-            }
-
-            fftWritePos += toCopy;
-            i += toCopy;
-
-            if (fftWritePos == milkdawp::AudioAnalysisSnapshot::fftSize) {
-                produceAnalysisSnapshot();
-                fftWritePos = 0;
-            }
-        }
+        // Timestamp the block start so the viz thread can map snapshot positions to wall time
+        audioClock.update(analyzer.getHostSamplePosition(), blockStartSec, N, getSampleRate());
+        analyzer.process(in0, in1, N, analysisQueue);
 
         // Feed raw PCM to visualization path (for GL thread/projectM)
        #if MILKDAWP_ENABLE_VIZ_THREAD
         if (vizThread)
         {
-            std::vector<float> interleaved;
-            interleaved.resize((size_t)N * 2);
-            if (numInCh == 0) {
-                std::fill(interleaved.begin(), interleaved.end(), 0.0f);
-            } else if (numInCh == 1) {
-                for (int n = 0; n < N; ++n) {
-                    const float s = in0[n];
-                    interleaved[(size_t)n * 2 + 0] = s;
-                    interleaved[(size_t)n * 2 + 1] = s;
-                }
-            } else {
-                for (int n = 0; n < N; ++n) {
-                    interleaved[(size_t)n * 2 + 0] = in0[n];
-                    interleaved[(size_t)n * 2 + 1] = in1[n];
-                }
-            }
+            // Interleaved straight into the PCM ring (mono duplicated, no input = silence)
             const double sr = getSampleRate();
-            vizThread->postAudioBlockInterleaved(interleaved.data(), N, sr > 0.0 ? sr : 44100.0);
+            vizThread->postAudioBlock(in0, in1, N, sr > 0.0 ? sr : 44100.0);
         }
        #endif
 
-        runningSamplePos += static_cast<uint64_t>(N);
-
         // DAW playhead sync: drive auto-advance from host transport position when available.
         // Falls back to wall-clock timer (restartAutoAdvanceTimer) when no playhead is present.
         if (auto* ph = getPlayHead())
@@ -477,7 +790,7 @@ public:
                             if (!pendingAutoAdvance_.exchange(true))
                             {
                                 juce::MessageManager::callAsync([this] {
-                                    nextPresetInPlaylist();
+                                    goToPlaylistRelative(1, true);
                                     pendingAutoAdvance_.store(false);
                                     stopAutoAdvanceTimer();
                                 });
@@ -555,6 +868,7 @@ public:
                 // Ensure parameter reflects clamped/actual position to avoid mismatch with host automation
                 syncPresetIndexParam();
                 restartAutoAdvanceTimer();
+                schedulePrefetch();
             } else {
                 // Even if same, if host sent an out-of-range value that clamped to current, resync param
                 syncPresetIndexParam();
@@ -715,6 +1029,24 @@ private:
     juce::Array<int> playlistOrder;           // Order of indices into playlistFiles (shuffled or sequential)
     int playlistPos = -1;                     // Position within playlistOrder (-1 if no playlist)
 
+    // Next presets are read ahead as soon as they are known; in shuffle mode the upcoming
+    // picks are rolled in advance (upcomingShuffle_, positions into playlistOrder) for that
+    milkdawp::PresetPrefetcher presetPrefetcher;
+    milkdawp::FrameCaptureBus frameCaptureBus;
+   #if MDW_HAS_SHARED_FRAME_OUTPUT
+    std::unique_ptr<milkdawp::SharedFrameWriter> sharedFrameWriter;
+   #else
+    std::unique_ptr<milkdawp::FrameCaptureSink> sharedFrameWriter; // never set
+   #endif
+    std::unique_ptr<milkdawp::Y4mRecorder> videoRecorder;
+    juce::Array<int> upcomingShuffle_;
+    static constexpr int prefetchDepth = 2;
+    static_assert(prefetchDepth <= milkdawp::PresetPrefetcher::defaultCapacity, "upcoming presets must fit the prefetch cache");
+
+    // See setSkipHeavyPresets; candidates tried per pick before settling for a heavy preset
+    bool skipHeavyPresets = false;
+    static constexpr int maxHeavySkips = 16;
+
     // Phase 3.3: Auto-advance timer and param sync
     std::unique_ptr<AutoAdvanceTimer> autoTimer; 
     bool ignorePresetIndexParamChange = false;
@@ -755,7 +1087,7 @@ private:
     void onAutoAdvanceTimer() {
         const bool locked = (apvts.getRawParameterValue("lockCurrentPreset") && apvts.getRawParameterValue("lockCurrentPreset")->load() >= 0.5f);
         if (!hasActivePlaylist() || locked) { stopAutoAdvanceTimer(); return; }
-        goToPlaylistRelative(1);
+        goToPlaylistRelative(1, true);
         // restart for next interval
         restartAutoAdvanceTimer();
     }
@@ -780,6 +1112,8 @@ private:
         playlistFiles.clear();
         playlistOrder.clear();
         playlistPos = -1;
+        upcomingShuffle_.clear();
+        presetPrefetcher.prefetch({});
         stopAutoAdvanceTimer();
         // Reset presetIndex parameter to 0 for single-preset mode visibility
         if (auto* rp = dynamic_cast<juce::RangedAudioParameter*>(apvts.getParameter("presetIndex"))) {
@@ -794,6 +1128,7 @@ private:
     void rebuildPlaylistOrder()
     {
         playlistOrder.clear();
+        upcomingShuffle_.clear();
         for (int i = 0; i < playlistFiles.size(); ++i)
             playlistOrder.add(i);
         // Shuffle support via parameter
@@ -821,52 +1156,8 @@ private:
         juce::File dir(folderPath);
         if (dir.isDirectory())
         {
-            juce::Array<juce::File> found;
-            juce::DirectoryIterator it(dir, false, "*.milk", juce::File::findFiles);
-            while (it.next())
-                found.add(it.getFile());
-
-            // Phase 6.3: Handle preset blacklist/filtering via optional ignore file in folder
-            // Supported filenames: ".milkignore" or ".milkdrop-ignore.txt" with one pattern or filename per line
-            juce::StringArray ignoreEntries;
-            auto ignoreA = dir.getChildFile(".milkignore");
-            auto ignoreB = dir.getChildFile(".milkdrop-ignore.txt");
-            auto readIgnore = [&](const juce::File& f){
-                if (f.existsAsFile()) {
-                    juce::String text = f.loadFileAsString();
-                    juce::StringArray lines;
-                    lines.addLines(text);
-                    for (auto& ln : lines) {
-                        auto t = ln.trim();
-                        if (t.isEmpty()) continue;
-                        if (t.startsWithIgnoreCase("#")) continue;
-                        ignoreEntries.addIfNotAlreadyThere(t.toLowerCase());
-                    }
-                }
-            };
-            readIgnore(ignoreA);
-            readIgnore(ignoreB);
-
-            // Apply filtering: entries can be exact filename matches or wildcard substrings
-            if (!ignoreEntries.isEmpty()) {
-                juce::Array<juce::File> filtered;
-                for (auto& f : found) {
-                    const auto name = f.getFileName().toLowerCase();
-                    bool skip = false;
-                    for (auto& pat : ignoreEntries) {
-                        if (pat.containsChar('*') || pat.containsChar('?')) {
-                            if (juce::String(name).matchesWildcard(pat, true)) { skip = true; break; }
-                        } else if (name == pat || name.contains(pat)) { // allow substring match
-                            skip = true; break;
-                        }
-                    }
-                    if (!skip) filtered.add(f);
-                }
-                found.swapWith(filtered);
-            }
-
-            struct FileNameComparator { int compareElements(juce::File a, juce::File b) const { return a.getFileName().compareIgnoreCase(b.getFileName()); } } comp;
-            found.sort(comp);
+            // *.milk in the folder minus .milkignore entries, sorted (shared with tools/PresetBench)
+            auto found = milkdawp::PresetFolderScan::scan(dir);
             playlistFiles = found;
             rebuildPlaylistOrder();
 
@@ -900,12 +1191,15 @@ private:
                     }
                     syncPresetIndexParam();
                     restartAutoAdvanceTimer();
+                    schedulePrefetch();
                 }
             }
         }
     }
 
-    void goToPlaylistRelative(int delta)
+    // autoAdvance: the step comes from the auto-advance timer or the playhead rather than the
+    // user, so sequential playback may pass over heavy presets too
+    void goToPlaylistRelative(int delta, bool autoAdvance = false)
     {
         if (!hasActivePlaylist()) return;
         if (playlistOrder.isEmpty()) return;
@@ -916,12 +1210,19 @@ private:
 
         if (shuffleOn && delta != 0)
         {
-            // Choose a random next position (different from current when possible)
+            // Choose a random next position (different from current when possible); forward
+            // steps take the pick rolled in advance so the prefetched preset is the one shown,
+            // unless it has since been measured as too heavy
             if (N > 1)
             {
-                int newPos = playlistPos;
-                auto& rng = juce::Random::getSystemRandom();
-                do { newPos = rng.nextInt(N); } while (newPos == playlistPos);
+                int newPos = -1;
+                if (delta > 0 && ! upcomingShuffle_.isEmpty())
+                    newPos = upcomingShuffle_.removeAndReturn(0);
+                if (newPos < 0 || newPos >= N || newPos == playlistPos || isOverFrameBudget(newPos))
+                {
+                    newPos = rollShufflePick(playlistPos);
+                    upcomingShuffle_.clear();
+                }
                 playlistPos = newPos;
             }
             else
@@ -929,6 +1230,10 @@ private:
                 playlistPos = 0;
             }
         }
+        else if (autoAdvance && delta > 0)
+        {
+            playlistPos = nextAffordablePos(playlistPos);
+        }
         else
         {
             // Sequential step or reload when delta == 0
@@ -944,6 +1249,90 @@ private:
         }
         syncPresetIndexParam();
         restartAutoAdvanceTimer();
+        schedulePrefetch();
+        milkdawp::PresetCostProfile::instance().saveIfDirty(60000.0);
+    }
+
+    // True if skipping is enabled and the preset at this playlist position is known to overrun
+    // the frame budget of the current adaptive quality rung. Unmeasured presets always pass.
+    bool isOverFrameBudget(int pos) const
+    {
+        if (!skipHeavyPresets || (unsigned)pos >= (unsigned)playlistOrder.size()) return false;
+        const int idx = playlistOrder[pos];
+        if ((unsigned)idx >= (unsigned)playlistFiles.size()) return false;
+        const auto rung = vizThread ? vizThread->getQualityProfile() : milkdawp::QualityProfile{};
+        return milkdawp::PresetCostProfile::instance().exceedsBudget(playlistFiles.getReference(idx), rung);
+    }
+
+    // Random position other than prev, preferring presets that fit the frame budget
+    int rollShufflePick(int prev) const
+    {
+        const int N = playlistOrder.size();
+        auto& rng = juce::Random::getSystemRandom();
+        int pick = prev;
+        for (int tries = 0; tries <= maxHeavySkips; ++tries)
+        {
+            do { pick = rng.nextInt(N); } while (pick == prev);
+            if (!isOverFrameBudget(pick)) break;
+        }
+        return pick;
+    }
+
+    // Next sequential position that fits the frame budget; the plain next one if none nearby does
+    int nextAffordablePos(int from) const
+    {
+        const int N = playlistOrder.size();
+        const int tries = juce::jmin(N - 1, maxHeavySkips);
+        for (int k = 1; k <= tries; ++k)
+            if (!isOverFrameBudget((from + k) % N))
+                return (from + k) % N;
+        return (from + 1) % N;
+    }
+
+    // Hands the next prefetchDepth playlist items to the prefetcher: the following positions in
+    // sequential mode, the pre-rolled picks in shuffle mode. Runs right after every switch, so
+    // the reads finish long before the auto-advance timer or playhead threshold fires.
+    // Switches made from host automation arrive on the audio thread; those are posted to the
+    // message thread, one pending post at most however fast the host sweeps.
+    void schedulePrefetch()
+    {
+        if (!juce::MessageManager::existsAndIsCurrentThread())
+        {
+            if (!pendingPrefetch_.exchange(true))
+                juce::MessageManager::callAsync([this] {
+                    pendingPrefetch_.store(false);
+                    schedulePrefetch();
+                });
+            return;
+        }
+        if (!hasActivePlaylist()) { presetPrefetcher.prefetch({}); return; }
+        const int N = playlistOrder.size();
+        bool shuffleOn = false;
+        if (auto* p = apvts.getRawParameterValue("shuffle")) shuffleOn = p->load() >= 0.5f;
+
+        juce::Array<int> upcoming;
+        if (shuffleOn && N > 1)
+        {
+            while (upcomingShuffle_.size() < prefetchDepth)
+                upcomingShuffle_.add(rollShufflePick(upcomingShuffle_.isEmpty() ? playlistPos : upcomingShuffle_.getLast()));
+            upcoming = upcomingShuffle_;
+        }
+        else
+        {
+            // Follow the auto-advance path (which skips heavy presets when enabled)
+            int pos = playlistPos;
+            for (int k = 1; k <= prefetchDepth && k < N; ++k)
+                upcoming.add(pos = nextAffordablePos(pos));
+        }
+
+        juce::StringArray paths;
+        for (int pos : upcoming)
+        {
+            const int idx = playlistOrder[pos];
+            if ((unsigned)idx < (unsigned)playlistFiles.size() && pos != playlistPos)
+                paths.addIfNotAlreadyThere(playlistFiles.getReference(idx).getFullPathName());
+        }
+        presetPrefetcher.prefetch(paths);
     }
 
     void sendAllParamsToViz()
@@ -966,56 +1355,21 @@ private:
     #endif
         }
 
-    void produceAnalysisSnapshot() noexcept {
-        // Copy mono into FFT buffer and window to compute short-time energy; FFT results are reserved for future phases
-        const int size = milkdawp::AudioAnalysisSnapshot::fftSize;
-        auto* fftData = fftBuffer.get();
-        for (int n = 0; n < size; ++n) fftData[n] = monoAccum[(size_t)n];
-        window.multiplyWithWindowingTable(fftData, size);
-        // zero imaginary part (not used currently)
-        std::fill(fftData + size, fftData + size * 2, 0.0f);
-
-        // Optionally perform FFT (kept for future); results currently unused
-        fft.performRealOnlyForwardTransform(fftData);
-
-        // Short-time energy on time-domain window
-        float energy = 0.0f;
-        for (int n = 0; n < size; ++n) {
-            const float s = monoAccum[(size_t)n];
-            energy += s * s;
-        }
-        energy /= static_cast<float>(size);
-
-        milkdawp::AudioAnalysisSnapshot snap;
-        snap.shortTimeEnergy = energy;
-        snap.samplePosition = runningSamplePos;
-
-        // Maintain moving average internally for future beat detection (no output yet)
-        constexpr int historyLen = (int)energyHistorySize;
-        const float old = energyHistory[(size_t)energyIndex];
-        energyHistory[(size_t)energyIndex] = energy;
-        energyIndex = (energyIndex + 1) % historyLen;
-        energyAverage += (energy - old) / (float)historyLen;
-        if (beatCooldown > 0) --beatCooldown;
-
-        // Enqueue (drop if full)
-        (void)analysisQueue.tryPush(snap);
+    // Analysis state (mono downmix, decimation, FFT window, energy history)
+    milkdawp::AudioAnalyzer analyzer;
+
+    // Audio-clock → wall-clock mapping and user A/V offset, shared with the viz thread
+    milkdawp::AudioClock audioClock;
+    std::atomic<double> avOffsetMs { 0.0 };
+    void connectVizSync() {
+        vizThread->setAudioClock(&audioClock);
+        vizThread->setAvOffsetMs(avOffsetMs.load(std::memory_order_relaxed));
+        vizThread->setBudgetPriority(vizBudgetPriority);
+        vizThread->setQualityPolicy(qualityPolicy);
+        vizThread->setFrameCaptureBus(&frameCaptureBus);
     }
-
-    // Analysis state
-    juce::dsp::FFT fft;
-    juce::dsp::WindowingFunction<float> window;
-    juce::HeapBlock<float> fftBuffer; // size = 2 * fftSize
-    std::vector<float> monoAccum;     // size = fftSize
-    int fftWritePos = 0;
-
-    static constexpr size_t energyHistorySize = 43;
-    std::array<float, energyHistorySize> energyHistory{};
-    int energyIndex = 0;
-    float energyAverage = 0.0f;
-    int beatCooldown = 0;
-
-    uint64_t runningSamplePos = 0;
+    milkdawp::QualityBudgetCoordinator::Priority vizBudgetPriority { milkdawp::QualityBudgetCoordinator::Priority::Background };
+    milkdawp::QualityPolicy qualityPolicy { milkdawp::QualityPolicy::PreferSmoothness };
 
     // DAW playhead sync
     std::atomic<bool>   playheadWasPlaying_ { false };
@@ -1023,6 +1377,7 @@ private:
     std::atomic<double> presetLoadedAtPos_  { 0.0 };  // song-position when current preset loaded
     std::atomic<float>  playheadTargetDur_  { 5.0f }; // sampled once per preset, used by audio thread
     std::atomic<bool>   pendingAutoAdvance_ { false }; // prevents double-fire per threshold crossing
+    std::atomic<bool>   pendingPrefetch_ { false };    // one posted schedulePrefetch() at a time
 
     milkdawp::AudioAnalysisQueue<64> analysisQueue;
     std::unique_ptr<milkdawp::VisualizationThread> vizThread;
@@ -1524,6 +1879,15 @@ public:
         // Apply persisted logging preference. The processor constructor always initialises the
         // file logger so early startup messages are captured; here we honour the user's choice.
         milkdawp::Logging::setEnabled(getSettings().getBoolValue("loggingEnabled", true));
+        // Apply persisted A/V offset (visual delay on top of the measured output latency)
+        processor.setAvOffsetMs(getSettings().getDoubleValue("avOffsetMs", 0.0));
+        // Apply persisted adaptive quality policy
+        processor.setQualityPolicy(getSettings().getBoolValue("aqPreferSharpness", false)
+                                       ? milkdawp::QualityPolicy::PreferSharpness
+                                       : milkdawp::QualityPolicy::PreferSmoothness);
+        processor.setSkipHeavyPresets(getSettings().getBoolValue("skipHeavyPresets", false));
+        if (getSettings().getBoolValue("sharedFrameOutput", false))
+            processor.setSharedFrameOutput(true);
 
         // Capture the state-restored size BEFORE setResizeLimits, because setResizeLimits
         // clamps the component from 0x0 to the minimum size, which fires resized() and
@@ -1700,8 +2064,9 @@ public:
         processor.ensureVizThreadStartedForUI();
         // resized() fired (from setSize above) before owner/vizThread were ready, so
         // setSurfaceSize was skipped. Sync the surface size explicitly now.
-        if (auto* vt = processor.getVizThread())
-            vt->setSurfaceSize(vizCanvas.getWidth(), vizCanvas.getHeight());
+        vizCanvas.syncVizSurface();
+        // Same frames, scaled down, in the editor while the canvas is popped out
+        addChildComponent(previewCanvas);
 
         // Knobs and toggles (Phase 4.2)
         addAndMakeVisible(beatLabel);
@@ -2296,6 +2661,13 @@ public:
     }
 
     ~MilkDAWpAudioProcessorEditor() override {
+        // Without an editor this instance is background work for the render budget
+        processor.setVizBudgetPriority(milkdawp::QualityBudgetCoordinator::Priority::Background);
+        // Mirrors present the canvas's frames, so they go first
+        mirrorWindow.reset();
+        previewCanvas.setVisible(false);
+        // Free projectM while the canvas still has a context, before docking moves it again
+        vizCanvas.releaseRenderer();
         // Ensure external window is closed and canvas is owned by editor
         if (isDetached)
             dockCanvas();
@@ -2479,6 +2851,7 @@ public:
         if (isDetached)
         {
             detachedNotice.setBounds(bounds.reduced(12));
+            previewCanvas.setBounds(bounds.reduced(12));
         }
         else
         {
@@ -2605,28 +2978,52 @@ private:
             juce::Label title { {}, "Fullscreen Options" };
             juce::ComboBox monitorCombo;
             juce::TextButton useAsDefault { "Use as default" };
+            juce::TextButton mirrorButton { "Mirror here" };
             juce::ToggleButton loggingToggle { "Enable file logging" };
+            juce::Label avOffsetLabel { {}, "A/V offset (ms)" };
+            juce::Slider avOffsetSlider { juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight };
+            juce::ToggleButton sharpnessToggle { "Prefer sharpness over frame rate" };
+            juce::ToggleButton skipHeavyToggle { "Skip presets too heavy for the frame budget" };
+            juce::ToggleButton sharedOutputToggle { "Publish frames to shared memory" };
+            enum { sharedOutputRow = MDW_HAS_SHARED_FRAME_OUTPUT ? 32 : 0 }; // POSIX only
+            juce::TextButton recordButton { "Record video..." };
+            enum { recordRow = 36 };
             std::function<void(int)> onSelection; // index in displays
             std::function<void()> onMakeDefault;
             juce::String defaultKey;
             void paint(juce::Graphics& g) override
             {
                 g.fillAll(juce::Colour(0xFF101214));
-                // Divider between fullscreen section and logging section
+                // Divider between fullscreen section and logging/sync section
                 g.setColour(juce::Colours::white.withAlpha(0.12f));
-                auto divY = getHeight() - 58;
+                auto divY = getHeight() - 158 - sharedOutputRow - recordRow;
                 g.drawHorizontalLine(divY, 16.0f, (float)(getWidth() - 16));
             }
             SettingsComp()
             {
-                setSize(420, 190);
+                setSize(420, 290 + sharedOutputRow + recordRow);
                 addAndMakeVisible(title);
                 title.setColour(juce::Label::textColourId, juce::Colours::white);
                 title.setFont(juce::FontOptions(18.0f).withStyle("Bold"));
                 addAndMakeVisible(monitorCombo);
                 addAndMakeVisible(useAsDefault);
+                addAndMakeVisible(mirrorButton);
                 addAndMakeVisible(loggingToggle);
                 loggingToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+                addAndMakeVisible(avOffsetLabel);
+                avOffsetLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+                addAndMakeVisible(avOffsetSlider);
+                avOffsetSlider.setRange(-250.0, 250.0, 1.0);
+                avOffsetSlider.setDoubleClickReturnValue(true, 0.0);
+                addAndMakeVisible(sharpnessToggle);
+                sharpnessToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+                addAndMakeVisible(skipHeavyToggle);
+                skipHeavyToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+               #if MDW_HAS_SHARED_FRAME_OUTPUT
+                addAndMakeVisible(sharedOutputToggle);
+                sharedOutputToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+               #endif
+                addAndMakeVisible(recordButton);
             }
             void resized() override
             {
@@ -2637,8 +3034,24 @@ private:
                 r.removeFromTop(12);
                 auto btnRow = r.removeFromTop(28);
                 useAsDefault.setBounds(btnRow.removeFromLeft(140));
+                btnRow.removeFromLeft(8);
+                mirrorButton.setBounds(btnRow.removeFromLeft(140));
                 r.removeFromTop(16); // divider gap
                 loggingToggle.setBounds(r.removeFromTop(24));
+                r.removeFromTop(8);
+                auto offsetRow = r.removeFromTop(28);
+                avOffsetLabel.setBounds(offsetRow.removeFromLeft(120));
+                avOffsetSlider.setBounds(offsetRow);
+                r.removeFromTop(8);
+                sharpnessToggle.setBounds(r.removeFromTop(24));
+                r.removeFromTop(8);
+                skipHeavyToggle.setBounds(r.removeFromTop(24));
+                if (sharedOutputRow > 0) {
+                    r.removeFromTop(8);
+                    sharedOutputToggle.setBounds(r.removeFromTop(24));
+                }
+                r.removeFromTop(8);
+                recordButton.setBounds(r.removeFromTop(28).removeFromLeft(288));
                 juce::ignoreUnused(btnRow);
             }
         };
@@ -2727,6 +3140,33 @@ private:
         };
         comp->useAsDefault.onClick = [cptr = comp.get()]{ if (cptr->onMakeDefault) cptr->onMakeDefault(); };
 
+        // Mirror: a second, borderless view of the same frames on the selected display. It only
+        // blits the render host's output, so it needs one (see VizMirrorCanvas).
+        auto refreshMirrorButton = [this, cptr = comp.get()]()
+        {
+            cptr->mirrorButton.setButtonText(mirrorWindow != nullptr ? "Close mirror" : "Mirror here");
+            const bool available = vizCanvas.getHostShareHandle() != nullptr;
+            cptr->mirrorButton.setEnabled(mirrorWindow != nullptr || available);
+            const auto fallback = vizCanvas.getRenderHostFallback();
+            if (available || mirrorWindow != nullptr)
+                cptr->mirrorButton.setTooltip("Show the visualization on this display as well, rendered once and presented twice");
+            else if (fallback != milkdawp::RenderHostFallback::none)
+                cptr->mirrorButton.setTooltip(juce::String("Mirroring needs the shared render context, unavailable here: ")
+                                              + milkdawp::describeRenderHostFallback(fallback));
+            else
+                cptr->mirrorButton.setTooltip("Mirroring is available once the visualization is running");
+        };
+        refreshMirrorButton();
+        comp->mirrorButton.onClick = [this, &displays, cptr = comp.get(), refreshMirrorButton]()
+        {
+            const int sel = cptr->monitorCombo.getSelectedItemIndex();
+            if (mirrorWindow != nullptr)
+                setMirrorDisplay(nullptr);
+            else if (sel >= 0 && sel < displays.displays.size())
+                setMirrorDisplay(&displays.displays.getReference(sel));
+            refreshMirrorButton();
+        };
+
         // Logging toggle: initial state from settings, persist on change
         const bool loggingOn = getSettings().getBoolValue("loggingEnabled", true);
         comp->loggingToggle.setToggleState(loggingOn, juce::dontSendNotification);
@@ -2738,6 +3178,98 @@ private:
             getSettings().saveIfNeeded();
         };
 
+        // A/V offset: applied live; the settings file debounces the save
+        comp->avOffsetSlider.setValue(processor.getAvOffsetMs(), juce::dontSendNotification);
+        comp->avOffsetSlider.onValueChange = [this, cptr = comp.get()]()
+        {
+            const double ms = cptr->avOffsetSlider.getValue();
+            processor.setAvOffsetMs(ms);
+            getSettings().setValue("avOffsetMs", ms);
+        };
+
+        // Adaptive quality policy: under load, drop to 45/30 fps before lowering resolution
+        comp->sharpnessToggle.setToggleState(processor.getQualityPolicy() == milkdawp::QualityPolicy::PreferSharpness,
+                                             juce::dontSendNotification);
+        comp->sharpnessToggle.onClick = [this, cptr = comp.get()]()
+        {
+            const bool sharp = cptr->sharpnessToggle.getToggleState();
+            processor.setQualityPolicy(sharp ? milkdawp::QualityPolicy::PreferSharpness
+                                             : milkdawp::QualityPolicy::PreferSmoothness);
+            getSettings().setValue("aqPreferSharpness", sharp);
+            getSettings().saveIfNeeded();
+        };
+
+        // Shuffle/auto-advance pass over presets measured as too heavy for the current rung
+        comp->skipHeavyToggle.setToggleState(processor.getSkipHeavyPresets(), juce::dontSendNotification);
+        comp->skipHeavyToggle.onClick = [this, cptr = comp.get()]()
+        {
+            const bool skip = cptr->skipHeavyToggle.getToggleState();
+            processor.setSkipHeavyPresets(skip);
+            getSettings().setValue("skipHeavyPresets", skip);
+            getSettings().saveIfNeeded();
+        };
+
+        // Shared-memory frame output for local compositors; shows the segment name readers open
+        const auto showSharedOutput = [this](SettingsComp& c)
+        {
+            const bool on = processor.getSharedFrameOutput();
+            c.sharedOutputToggle.setToggleState(on, juce::dontSendNotification);
+            if (on)
+                c.sharedOutputToggle.setButtonText("Publish frames to shared memory (" + processor.getSharedFrameOutputName() + ")");
+            else if (processor.getSharedFrameOutputFailed())
+                c.sharedOutputToggle.setButtonText("Publish frames to shared memory (stopped: no room for larger frames)");
+            else
+                c.sharedOutputToggle.setButtonText("Publish frames to shared memory");
+        };
+        showSharedOutput(*comp);
+        comp->sharedOutputToggle.onClick = [this, showSharedOutput, cptr = comp.get()]()
+        {
+            const bool on = cptr->sharedOutputToggle.getToggleState();
+            if (! processor.setSharedFrameOutput(on))
+                MDW_LOG_WARN("Shared frame output: could not be enabled");
+            showSharedOutput(*cptr);
+            getSettings().setValue("sharedFrameOutput", processor.getSharedFrameOutput());
+            getSettings().saveIfNeeded();
+        };
+
+        // Recording to .y4m: starting asks for the file, the button then stops it
+        const auto showRecording = [this](SettingsComp& c)
+        {
+            const auto* rec = processor.getVideoRecorder();
+            c.recordButton.setButtonText(rec != nullptr ? "Stop recording (" + rec->getFile().getFileName() + ")"
+                                                        : juce::String("Record video..."));
+            c.recordButton.setTooltip("Record the visuals as uncompressed YUV4MPEG2 (.y4m) video. "
+                                      "Frames the disk can't keep up with are dropped and counted in the log.");
+        };
+        showRecording(*comp);
+        comp->recordButton.onClick = [this, showRecording, cptr = comp.get()]()
+        {
+            if (processor.isRecording())
+            {
+                processor.stopRecording();
+                showRecording(*cptr);
+                return;
+            }
+            const auto name = "MilkDAWp " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".y4m";
+            fileChooser = std::make_unique<juce::FileChooser>("Record video to",
+                juce::File::getSpecialLocation(juce::File::userMoviesDirectory).getChildFile(name), "*.y4m");
+            const auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                             | juce::FileBrowserComponent::warnAboutOverwriting;
+            fileChooser->launchAsync(flags, [this, showRecording, safe = juce::Component::SafePointer<SettingsComp>(cptr)](const juce::FileChooser& fc)
+            {
+                const auto f = fc.getResult();
+                fileChooser.reset();
+                if (f == juce::File())
+                    return; // cancelled
+                processor.ensureVizThreadStartedForUI();
+                if (! processor.startRecording(f.withFileExtension(".y4m")))
+                    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Recording",
+                                                           "Could not write " + f.getFullPathName());
+                if (safe != nullptr)
+                    showRecording(*safe);
+            });
+        };
+
         // Hover highlight via LookAndFeel callback: parse item label to index
         hardwareLAF.setPopupHoverCallback([this](const juce::String& text)
         {
@@ -2769,6 +3301,8 @@ private:
     {
         if (!isDetached)
             return;
+        // Keeps projectM (and the preset on screen) alive across the move back into the editor
+        VizOpenGLCanvas::ReparentScope reparent { vizCanvas };
         // Ensure we exit fullscreen (fake fullscreen borderless mode) before docking
         if (isFullscreen) {
             isFullscreen = false;
@@ -2800,14 +3334,51 @@ private:
         isDetached = false;
         detachedNotice.setText({}, juce::dontSendNotification);
         detachedNotice.setVisible(false);
+        previewCanvas.setVisible(false);
         // Sync pop-out toggle off when re-docking
         if (popOutButton.getToggleState())
             popOutButton.setToggleState(false, juce::dontSendNotification);
         resized();
     }
 
+    // While detached the editor shows the same frames through previewCanvas. That needs the
+    // render host, so without one (macOS, or a projectM without the FBO entry point) the
+    // notice is shown instead.
+    void updateDetachedView()
+    {
+        const bool preview = isDetached && vizCanvas.getHostShareHandle() != nullptr;
+        if (previewCanvas.isVisible() != preview)
+            previewCanvas.setVisible(preview);
+        if (isDetached && ! preview) {
+            juce::String text("Visualization is detached. Toggle fullscreen off to reattach.");
+            const auto fallback = vizCanvas.getRenderHostFallback();
+            if (fallback != milkdawp::RenderHostFallback::none)
+                text << "\nNo preview here: the shared render context is unavailable ("
+                     << milkdawp::describeRenderHostFallback(fallback) << ").";
+            detachedNotice.setText(text, juce::dontSendNotification);
+        }
+        if (detachedNotice.isVisible() != (isDetached && ! preview))
+            detachedNotice.setVisible(isDetached && ! preview);
+    }
+
+    // Mirror window covering a display (second monitor); nullptr closes it. Closing from the
+    // window itself is deferred so it isn't deleted inside its own callback.
+    void setMirrorDisplay(const juce::Displays::Display* d)
+    {
+        mirrorWindow.reset();
+        if (d == nullptr) return;
+        juce::Component::SafePointer<MilkDAWpAudioProcessorEditor> safe(this);
+        mirrorWindow = std::make_unique<MirrorVisualizationWindow>(vizCanvas, *d, [safe] {
+            juce::MessageManager::callAsync([safe] { if (safe != nullptr) safe->setMirrorDisplay(nullptr); });
+        });
+        mirrorWindow->toFront(true);
+    }
+
     void toggleFullscreen()
     {
+        // Detaching and switching the window to borderless both recreate the canvas's native
+        // window; projectM stays alive in its render host meanwhile (dockCanvas has its own scope)
+        VizOpenGLCanvas::ReparentScope reparent { vizCanvas };
         // If not detached yet, auto-detach to external window first
         if (!isDetached)
         {
@@ -2835,7 +3406,8 @@ private:
             detachedNotice.setText("Visualization is detached. Toggle fullscreen off to reattach.", juce::dontSendNotification);
             detachedNotice.setJustificationType(juce::Justification::centred);
             detachedNotice.setColour(juce::Label::textColourId, juce::Colours::white);
-            addAndMakeVisible(detachedNotice);
+            addChildComponent(detachedNotice);
+            updateDetachedView();
             resized();
         }
         if (!externalWindow)
@@ -2901,6 +3473,27 @@ private:
         return displays.getDisplayForRect(editorBounds);
     }
 
+    // Fullscreen or focused editors get first claim on the shared render budget, visible ones
+    // next; hidden editors are treated as background and degrade first.
+    void updateBudgetPriority()
+    {
+        using Priority = milkdawp::QualityBudgetCoordinator::Priority;
+        bool focused = isFullscreen;
+        if (! focused)
+        {
+            if (isDetached && externalWindow != nullptr)
+                focused = externalWindow->isActiveWindow();
+            else if (auto* peer = getPeer())
+                focused = peer->isFocused();
+        }
+        const Priority p = focused ? Priority::Focused : (isShowing() ? Priority::Visible : Priority::Background);
+        if (p != lastBudgetPriority)
+        {
+            lastBudgetPriority = p;
+            processor.setVizBudgetPriority(p);
+        }
+    }
+
     void timerCallback() override
     {
         // Watchdog: if fullscreen was exited by any external cause, immediately dock to enforce state model
@@ -2927,6 +3520,9 @@ private:
                 dockCanvas();
             }
         }
+        if (isDetached)
+            updateDetachedView(); // the render host appears with the first preset
+        updateBudgetPriority();
         auto name = currentDisplayName();
         if (name != lastDisplayedName)
         {
@@ -3018,7 +3614,7 @@ private:
         return "(no preset)";
     }
 
-    struct VizOpenGLCanvas : public juce::Component, public juce::OpenGLRenderer, private juce::Timer {
+    struct VizOpenGLCanvas : public juce::Component, public juce::OpenGLRenderer {
         VizOpenGLCanvas()
         {
             // Configure GL context for an embedded canvas
@@ -3027,24 +3623,74 @@ private:
             // (Previously requested openGL3_2.)
             setOpaque(false); // allow per-pixel transparency for OBS/window compositing
             context.setRenderer(this);
+            // A single vsync-paced loop: renderOpenGL draws projectM, or the CPU fallback while
+            // projectM isn't rendering (drawCpuFallback). With component painting on, JUCE would
+            // also take the message-thread lock, paint the component into its own texture and
+            // blend that over the frame every vsync, even though there is nothing to paint.
+            context.setComponentPaintingEnabled(false);
             context.setContinuousRepainting(true);
-            // Re-enable JUCE component painting so we can show a CPU fallback when projectM/GL is unavailable.
-            // The paint() implementation will avoid overdrawing when GL is active.
-            context.setComponentPaintingEnabled(true);
             context.attachTo(*this);
-            // Drive CPU fallback repaints at ~60 FPS
-            startTimerHz(60);
         }
         ~VizOpenGLCanvas() override
         {
-            stopTimer();
             context.detach();
+           #if MILKDAWP_HAS_PROJECTM
+            if (pmHandle != nullptr)
+                MDW_LOG_WARN("projectM: canvas destroyed without a GL context; instance abandoned");
+            pmHost_.destroy(); // emptied in openGLContextClosing
+           #endif
+        }
+
+        // Message thread: the editor moves the canvas between native windows (pop-out, fullscreen,
+        // docking), which recreates its GL context. While a ReparentScope is alive the context is
+        // detached with projectM kept in the render host; when the outermost scope ends the canvas
+        // re-attaches with a context that shares the host's objects, so the visual resumes at once.
+        struct ReparentScope {
+            explicit ReparentScope(VizOpenGLCanvas& c) : canvas(c) { canvas.beginReparent(); }
+            ~ReparentScope() { canvas.endReparent(); }
+            VizOpenGLCanvas& canvas;
+        };
+        void beginReparent()
+        {
+            if (reparentDepth_++ > 0) return;
+            reparentStartMs_.store(juce::Time::getMillisecondCounterHiRes());
+            keepRenderHost_.store(true);
+            context.detach();
+            keepRenderHost_.store(false);
         }
+        void endReparent()
+        {
+            if (--reparentDepth_ > 0 || rendererReleased_) return;
+            void* host = hostShareHandle_.load();
+            context.setNativeSharedContext(host);
+            sharedContextSet_.store(host);
+            context.attachTo(*this);
+        }
+        // Message thread: final teardown while the canvas can still get a context to do it in
+        void releaseRenderer()
+        {
+            rendererReleased_ = true;
+            context.detach();
+        }
+
+        // Any thread: what mirror canvases share with to present the render host's frames (null
+        // while there is no host), and a counter that changes whenever the host is replaced
+        void* getHostShareHandle() const { return hostShareHandle_.load(); }
+        uint32_t getHostGeneration() const { return hostGeneration_.load(); }
+        // Any thread: why there is no render host, once the canvas has tried to create one
+        milkdawp::RenderHostFallback getRenderHostFallback() const { return hostFallback_.load(); }
+       #if MILKDAWP_HAS_PROJECTM
+        RenderHost& getRenderHost() { return pmHost_; }
+       #endif
+
         void newOpenGLContextCreated() override
         {
             // Initialise GL resources if needed later (textures, FBOs). For now just set a start time.
             startTimeMs = juce::Time::getMillisecondCounterHiRes();
             glContextCreated.store(true, std::memory_order_relaxed);
+           #if MILKDAWP_HAS_PROJECTM
+            canvasSharesHost_ = pmHost_.isCreated() && sharedContextSet_.load() == pmHost_.nativeHandle();
+           #endif
             MDW_LOG_INFO("VizOpenGLCanvas: OpenGL context created");
             // Log GL strings for diagnosis
             const GLubyte* ver = juce::gl::glGetString(juce::gl::GL_VERSION);
@@ -3197,6 +3843,10 @@ private:
             g_pm_set_preset_duration      = (PFN_PM_SET_PRESET_DURATION)      gp("projectm_set_preset_duration");
             g_pm_set_soft_cut_duration    = (PFN_PM_SET_SOFT_CUT_DURATION)    gp("projectm_set_soft_cut_duration");
             g_pm_set_preset_switch_cb     = (PFN_PM_SET_PRESET_SWITCH_CB)     gp("projectm_set_preset_switch_requested_event_callback");
+            // Adaptive quality (non-critical)
+            g_pm_set_mesh_size            = (PFN_PM_SET_MESH_SIZE)            gp("projectm_set_mesh_size");
+            g_pm_opengl_render_frame_fbo  = (PFN_PM_OPENGL_RENDER_FRAME_FBO)  gp("projectm_opengl_render_frame_fbo");
+            g_pm_load_preset_data         = (PFN_PM_LOAD_PRESET_DATA)         gp("projectm_load_preset_data");
             if (!g_pm_create || !g_pm_destroy || !g_pm_set_window_size || !g_pm_set_fps || !g_pm_set_aspect || !g_pm_load_preset_file || !g_pm_opengl_render_frame) {
                 MDW_LOG_ERROR("projectM: one or more required API symbols missing; will use CPU fallback");
             } else {
@@ -3269,6 +3919,9 @@ private:
                g_pm_set_preset_duration      = (PFN_PM_SET_PRESET_DURATION)      gp("projectm_set_preset_duration");
                g_pm_set_soft_cut_duration    = (PFN_PM_SET_SOFT_CUT_DURATION)    gp("projectm_set_soft_cut_duration");
                g_pm_set_preset_switch_cb     = (PFN_PM_SET_PRESET_SWITCH_CB)     gp("projectm_set_preset_switch_requested_event_callback");
+               g_pm_set_mesh_size            = (PFN_PM_SET_MESH_SIZE)            gp("projectm_set_mesh_size");
+               g_pm_opengl_render_frame_fbo  = (PFN_PM_OPENGL_RENDER_FRAME_FBO)  gp("projectm_opengl_render_frame_fbo");
+               g_pm_load_preset_data         = (PFN_PM_LOAD_PRESET_DATA)         gp("projectm_load_preset_data");
                if (!g_pm_create || !g_pm_destroy || !g_pm_set_window_size || !g_pm_set_fps || !g_pm_set_aspect || !g_pm_load_preset_file || !g_pm_opengl_render_frame) {
                    MDW_LOG_ERROR("projectM: one or more required API symbols missing; visualization unavailable");
                } else {
@@ -3286,7 +3939,21 @@ private:
             const double nowMs = juce::Time::getMillisecondCounterHiRes();
             lastGLFrameMs.store((uint64_t) nowMs, std::memory_order_relaxed);
             juce::OpenGLHelpers::clear(juce::Colours::transparentBlack);
+           #if MILKDAWP_HAS_PROJECTM
+            // GPU times of earlier frames, read back without waiting; each ring is read in its own
+            // context (see GpuFrameTimer.h)
+            collectGpuTimes(canvasGpuTimer_);
+            // projectM runs in its own context where possible (see RenderHost); it stays current
+            // for all projectM work until the present step at the end of the frame
+            hosted_ = enterRenderHost();
+            if (hosted_)
+                collectGpuTimes(hostGpuTimer_);
+            ++gpuFrameId_;
+            gpuParts_ = 0;
+            renderedThisFrame_ = false;
+           #endif
             // Ensure viewport matches the physical drawable size each frame.
+            int viewW = 1, viewH = 1;
             // cachedDisplayScale_ is updated on the message thread in resized(); fall back to
             // context.getRenderingScale() if the cache hasn't been populated yet.
             {
@@ -3305,12 +3972,41 @@ private:
                 }
 
                 juce::gl::glViewport(0, 0, w, h);
+                viewW = w;
+                viewH = h;
 
-                // Keep projectM informed of the current drawable size (prevents asserts and wrong aspect)
                #if MILKDAWP_HAS_PROJECTM
-                if (pmHandle != nullptr) {
-                    if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) w, (size_t) h);
+                // projectM renders at drawable x adaptive render scale (see renderProjectMFrame)
+                drawableW_ = w;
+                drawableH_ = h;
+                if (owner != nullptr)
+                    if (auto* vt = owner->getVizThread())
+                        pmScale_ = milkdawp::steppedRenderScale(pmScale_, vt->getRenderScale());
+                // In the render host the frame also feeds mirror outputs; it is sized for the
+                // largest of them and the smaller ones present a scaled-down copy
+                int baseW = w, baseH = h;
+                if (hosted_) {
+                    const auto largest = pmHost_.largestOutputSize();
+                    if ((int64_t) largest.x * largest.y > (int64_t) w * h) {
+                        baseW = largest.x;
+                        baseH = largest.y;
+                    }
+                }
+                const auto rs = milkdawp::scaledRenderSize(baseW, baseH, pmScale_);
+                pmRenderW_ = rs.width;
+                pmRenderH_ = rs.height;
+                // No offscreen target could be allocated at this drawable size: stay at full size
+                // rather than retrying every frame; a resize or a new context tries again
+                if (! hosted_ && w == targetFailedW_ && h == targetFailedH_) {
+                    pmRenderW_ = w;
+                    pmRenderH_ = h;
+                } else if (w != targetFailedW_ || h != targetFailedH_) {
+                    targetFailedW_ = targetFailedH_ = -1;
                 }
+
+                // Keep projectM informed of the current render size (prevents asserts and wrong aspect)
+                if (pmHandle != nullptr)
+                    setProjectMWindowSize(pmRenderW_, pmRenderH_);
                #endif
             }
         #if MILKDAWP_HAS_PROJECTM
@@ -3322,19 +4018,24 @@ private:
                     if (pmHandle == nullptr) {
                         MDW_LOG_ERROR("projectM: failed to create instance (is GL context current?)");
                     } else {
-                        MDW_LOG_INFO("projectM: instance created (lazy)");
+                        pmInHost_ = hosted_;
+                        MDW_LOG_INFO(juce::String("projectM: instance created (lazy") + (pmInHost_ ? ", render host)" : ")"));
                         // Optional: set preset search directory to the preset's parent folder to keep internal lookups happy
                         // Note: projectM v4 C API may not expose set_preset_directory; we proceed to explicit file load below.
                         if (g_pm_set_fps) g_pm_set_fps(pmHandle, 60);
                         if (g_pm_set_aspect) g_pm_set_aspect(pmHandle, true);
+                        // Force the adaptive quality rung to be (re)applied to the new instance
+                        appliedMeshW_ = appliedMeshH_ = appliedFps_ = -1;
                         float sc0 = cachedDisplayScale_.load(std::memory_order_relaxed);
                         if (sc0 <= 0.0f) sc0 = (float) context.getRenderingScale();
                         const int w0 = juce::jmax(2, juce::roundToInt(getWidth()  * sc0));
                         const int h0 = juce::jmax(2, juce::roundToInt(getHeight() * sc0));
-                        if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) w0, (size_t) h0);
+                        pmWindowW_ = pmWindowH_ = -1;
+                        setProjectMWindowSize(w0, h0);
                         pmReady = true;
                         pmCanRender = false;
                         lastPMPath.clear();
+                        requestedPMPath_.clear();
                         // Apply initial parameter values from APVTS
                         {
                             auto& vts = owner->getValueTreeState();
@@ -3395,24 +4096,57 @@ private:
             }
             if (pmHandle != nullptr)
             {
-                // If user selected a new preset path, load it here on the GL thread
+                // If user selected a new preset path, have it read off-thread. The current preset
+                // keeps rendering meanwhile; this thread only performs the swap once the text is
+                // in memory (parsing and shader compilation need the GL context).
                 if (owner != nullptr) {
                     auto path = owner->getCurrentPresetPath();
-                    if (path.isNotEmpty() && path != lastPMPath) {
-                        isLoadingPreset = true;
-                        pmCanRender = false;
-                        // Ensure window size is valid before swap
-                        const int pw = juce::jmax(2, getWidth());
-                        const int ph = juce::jmax(2, getHeight());
-                        if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) pw, (size_t) ph);
-                        if (g_pm_load_preset_file) g_pm_load_preset_file(pmHandle, path.toRawUTF8(), true);
-                        MDW_LOG_INFO(juce::String("Loaded preset (GL): ") + path);
-                        lastPMPath = path;
-                        // After preset swap, re-affirm window size and allow rendering
-                        if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) pw, (size_t) ph);
-                        isLoadingPreset = false;
-                        pmCanRender = true;
+                    if (path.isNotEmpty() && path != requestedPMPath_) {
+                        presetLoader_.setPrefetcher(&owner->getPresetPrefetcher());
+                        presetLoader_.request(path);
+                        requestedPMPath_ = path;
+                        presetRequestMs_ = juce::Time::getMillisecondCounterHiRes();
+                    }
+                }
+                double swapMs = 0.0; // preset swap in this frame, reported apart from the render cost
+                if (presetLoader_.takeReady(presetSlot_)) {
+                    const juce::String& path = presetSlot_.path;
+                    const double swapStartMs = juce::Time::getMillisecondCounterHiRes();
+                    isLoadingPreset = true;
+                    // Ensure window size is valid before swap
+                    const int pw = juce::jmax(2, pmRenderW_);
+                    const int ph = juce::jmax(2, pmRenderH_);
+                    if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) pw, (size_t) ph);
+                    if (presetSlot_.ok && g_pm_load_preset_data)
+                        g_pm_load_preset_data(pmHandle, presetSlot_.data.c_str(), true);
+                    else if (g_pm_load_preset_file)
+                        g_pm_load_preset_file(pmHandle, path.toRawUTF8(), true); // file is in the OS cache now
+                    const double swapEndMs = juce::Time::getMillisecondCounterHiRes();
+                    swapMs = swapEndMs - swapStartMs;
+                    juce::String prefetchNote;
+                    if (owner != nullptr) {
+                        // Switch latency from request to swapped-in, split by prefetch hit/miss
+                        auto& pf = owner->getPresetPrefetcher();
+                        pf.recordSwitch(presetSlot_.prefetched, swapEndMs - presetRequestMs_);
+                        const auto st = pf.getStats();
+                        prefetchNote = juce::String(presetSlot_.prefetched ? ", prefetch hit" : ", prefetch miss")
+                                     + " (hits=" + juce::String((double) st.hits, 0) + " avg " + juce::String(st.avgHitMs, 1)
+                                     + " ms, misses=" + juce::String((double) st.misses, 0) + " avg " + juce::String(st.avgMissMs, 1) + " ms)";
                     }
+                    MDW_LOG_INFO(juce::String("Loaded preset (GL): ") + path + " (read " + juce::String(presetSlot_.readMs, 1)
+                                 + " ms off-thread, swap " + juce::String(swapEndMs - swapStartMs, 1) + " ms" + prefetchNote + ")");
+                    lastPMPath = path;
+                    // After preset swap, re-affirm window size and allow rendering
+                    if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) pw, (size_t) ph);
+                    isLoadingPreset = false;
+                    pmCanRender = true;
+                    switchWatchFrames_ = switchWatchLength;
+                    switchWorstMs_ = 0.0;
+                    costPath_ = path;
+                    costModified_ = presetSlot_.modified;
+                    costFrames_.clear();
+                    costFrames_.reserve(costWindowLength);
+                    costWindowActive_ = presetSlot_.ok;
                 }
                 // Render the projectM frame into the current framebuffer (guarded)
                 {
@@ -3429,22 +4163,28 @@ private:
                         juce::gl::glDisable(juce::gl::GL_BLEND);
                         juce::gl::glDisable(juce::gl::GL_CULL_FACE);
                         juce::gl::glDisable(juce::gl::GL_DITHER);
-                        // Feed latest PCM to projectM (if audio available)
+                        // Feed the PCM posted since the previous GL frame to projectM (each sample once)
                         if (owner != nullptr) {
                             if (auto* vt = owner->getVizThread()) {
-                                std::vector<float> pcm;
+                                // Persistent feed buffers, sized once to the most a single read can return
+                                if (pcmFeed_.empty()) {
+                                    pcmFeed_.assign((size_t) vt->getPcmCapacityFrames() * 2, 0.0f);
+                                    pcmFeedI16_.assign(pcmFeed_.size(), 0);
+                                }
                                 double sr = 0.0;
-                                // Request around 1024 frames for responsiveness; VisualizationThread will clamp to available
-                                vt->getLatestPcmWindow(pcm, 1024, sr);
                                 // Determine bypass and recent-audio status
                                 bool bypassed = false;
                                 if (auto* bp = owner->getBypassParameter())
                                     bypassed = (bp->getValue() >= 0.5f);
                                 const bool haveRecent = vt->hasRecentPcm(200.0);
-                                // If bypassed or no recent audio, feed a small silence block
-                                if (bypassed || !haveRecent || pcm.empty()) {
-                                    pcm.assign((size_t)512 * 2, 0.0f);
-                                    if (sr <= 0.0) sr = 44100.0;
+                                size_t frames = 0;
+                                if (bypassed || !haveRecent) {
+                                    // Feed a small silence block; resync to live audio when it returns
+                                    pcmCursor_.detach();
+                                    frames = 512;
+                                    std::fill(pcmFeed_.begin(), pcmFeed_.begin() + (std::ptrdiff_t)(frames * 2), 0.0f);
+                                } else {
+                                    frames = (size_t) vt->readNewPcm(pcmCursor_, pcmFeed_.data(), (int)(pcmFeed_.size() / 2), sr);
                                 }
                                 // Runtime resolve projectM audio input APIs (cross-platform via g_pmModule)
                                 typedef void (*PFN_PM_PCM_ADD_FLOAT)(projectm_handle, const float*, size_t, int);
@@ -3471,20 +4211,15 @@ private:
                                         MDW_LOG_INFO("projectM: PCM feed API resolved");
                                     }
                                 }
-                                const size_t frames = pcm.size() / 2;
                                 if (frames > 0) {
                                     if (s_pmAddFloat) {
-                                        s_pmAddFloat(pmHandle, pcm.data(), frames, 2);
+                                        // NaN/inf/denormals from upstream would stick in projectM's state
+                                        milkdawp::simd::active().scrubPcm(pcmFeed_.data(), (int)(frames * 2));
+                                        s_pmAddFloat(pmHandle, pcmFeed_.data(), frames, 2);
                                     } else if (s_pmAddI16) {
-                                        // Convert to int16 with clipping
-                                        std::vector<int16_t> tmpI16;
-                                        tmpI16.resize(pcm.size());
-                                        for (size_t i = 0; i < pcm.size(); ++i) {
-                                            float v = juce::jlimit(-1.0f, 1.0f, pcm[i]);
-                                            int iv = (int) std::lround(v * 32767.0f);
-                                            tmpI16[i] = (int16_t) juce::jlimit(-32768, 32767, iv);
-                                        }
-                                        s_pmAddI16(pmHandle, tmpI16.data(), frames, 2);
+                                        // Scrub, clip and round to int16 in one SIMD-dispatched pass
+                                        milkdawp::simd::active().floatToInt16(pcmFeed_.data(), pcmFeedI16_.data(), (int)(frames * 2));
+                                        s_pmAddI16(pmHandle, pcmFeedI16_.data(), frames, 2);
                                     }
                                 }
                                #if defined(_DEBUG)
@@ -3492,7 +4227,8 @@ private:
                                 const double nowDbg = juce::Time::getMillisecondCounterHiRes();
                                 if (nowDbg - lastPcmLogMs > 3000.0) {
                                     MDW_LOG_INFO(juce::String("projectM PCM feed: ") + juce::String((int)frames) + " frames @ " + juce::String(sr, 1) + " Hz"
-                                                 + (bypassed ? " (bypassed→silence)" : haveRecent ? "" : " (stale→silence)"));
+                                                 + (bypassed ? " (bypassed→silence)" : haveRecent ? "" : " (stale→silence)")
+                                                 + ", dropped=" + juce::String((juce::int64) pcmCursor_.droppedFrames));
                                     lastPcmLogMs = nowDbg;
                                 }
                                #endif
@@ -3538,7 +4274,46 @@ private:
                                 }
                             }
                         }
-                        if (g_pm_opengl_render_frame) g_pm_opengl_render_frame(pmHandle);
+                        // Adaptive quality and the cost profile see the render alone: a preset
+                        // swap, the PCM feed and parameter sync aren't a sign the rung is too heavy
+                        const double renderStartMs = juce::Time::getMillisecondCounterHiRes();
+                        applyQualityProfile();
+                        // False when the render host had no free slot: the outputs keep the last frame
+                        if (renderProjectMFrame()) {
+                            renderedThisFrame_ = true;
+                            ++renderedFrames_;
+                            const double frameMs = juce::Time::getMillisecondCounterHiRes() - renderStartMs;
+                            if (owner != nullptr)
+                                if (auto* vt = owner->getVizThread())
+                                    vt->reportGlFrame(frameMs);
+                            // Worst GL frame in the second following a preset switch; the swap frame
+                            // counts its swap too, as that is the hitch a viewer sees
+                            if (switchWatchFrames_ > 0) {
+                                switchWorstMs_ = juce::jmax(switchWorstMs_, frameMs + swapMs);
+                                if (--switchWatchFrames_ == 0)
+                                    MDW_LOG_INFO(juce::String("Preset switch: worst GL frame ") + juce::String(switchWorstMs_, 2)
+                                                 + " ms over " + juce::String(switchWatchLength) + " frames");
+                            }
+                            // Steady-state cost once the switch has settled: median frame of the next
+                            // window, recorded against the quality rung it was rendered at (a rung
+                            // change mid-window restarts the window)
+                            else if (costWindowActive_ && owner != nullptr) {
+                                if (auto* vt = owner->getVizThread()) {
+                                    const auto rung = vt->getQualityProfile();
+                                    if (costFrames_.empty() || rung != costRung_) {
+                                        costFrames_.clear();
+                                        costRung_ = rung;
+                                    }
+                                    costFrames_.push_back(frameMs);
+                                    if ((int) costFrames_.size() == costWindowLength) {
+                                        const auto mid = costFrames_.begin() + costWindowLength / 2;
+                                        std::nth_element(costFrames_.begin(), mid, costFrames_.end());
+                                        milkdawp::PresetCostProfile::instance().record(costPath_, costModified_, *mid, costRung_);
+                                        costWindowActive_ = false;
+                                    }
+                                }
+                            }
+                        }
                     } else {
                         static double lastSkipLogMs = 0.0;
                         if (nowMs - lastSkipLogMs > 3000.0) {
@@ -3557,35 +4332,309 @@ private:
                 }
                #endif
             }
+            bool hostFrameShown = false;
+            if (hosted_) {
+                pmHost_.leave();
+                // Only frames projectM rendered in are timed; a present alone isn't a frame's cost
+                const bool timed = gpuParts_ > 0 && beginGpuTimer(canvasGpuTimer_);
+                hostFrameShown = pmHost_.present(drawableW_, drawableH_);
+                if (timed)
+                    canvasGpuTimer_.end();
+                hosted_ = false;
+            }
+            if (gpuParts_ > 0)
+                gpuFrames_.close(gpuFrameId_, gpuParts_);
+            if (pmHandle == nullptr || ! pmCanRender)
+                drawCpuFallback(viewW, viewH);
+            // Capture consumers get the finished projectM frame as presented (the CPU fallback
+            // reaches them from the viz thread instead)
+            if (owner != nullptr) {
+                auto& bus = owner->getFrameCaptureBus();
+                if (! bus.hasSinks()) {
+                    if (frameReadback_.isCreated())
+                        frameReadback_.release();
+                } else if (renderedThisFrame_) {
+                    frameReadback_.capture(bus, drawableW_, drawableH_, renderedFrames_, nowMs);
+                }
+            }
+            // What a pop-out, fullscreen or dock costs as seen: detaching the old context to the
+            // first projectM frame in the new one
+            if ((hostFrameShown || renderedThisFrame_) && reparentStartMs_.load() > 0.0) {
+                const double ms = juce::Time::getMillisecondCounterHiRes() - reparentStartMs_.exchange(0.0);
+                MDW_LOG_INFO(juce::String("Reparent: first frame ") + juce::String(ms, 1) + " ms after detaching"
+                             + (pmInHost_ ? " (projectM kept in the render host)" : " (projectM recreated)"));
+            }
+            // Swap interval belongs to the canvas context, so it's applied once that is current again
+            if (wantedSwapInterval_ != appliedSwapInterval_) {
+                context.setSwapInterval(wantedSwapInterval_);
+                appliedSwapInterval_ = wantedSwapInterval_;
+            }
+        #else
+            drawCpuFallback(viewW, viewH);
         #endif
-            // When projectM is not available, nothing is drawn here; CPU blit in paint() remains as fallback.
         }
+
+        // GL thread: stretches the viz thread's CPU-rendered frame over the drawable while projectM
+        // isn't rendering. A new snapshot (and texture upload) is only taken when the viz thread
+        // has rendered a frame since the last one.
+        void drawCpuFallback(int w, int h)
+        {
+            if (owner == nullptr) return;
+            auto* vt = owner->getVizThread();
+            if (vt == nullptr) return;
+            const uint64_t rendered = vt->getFramesRendered();
+            if (rendered != fallbackFrame_ || ! fallbackImage_.isValid()) {
+                milkdawp::VisualizationThread::FrameSnapshot snap;
+                if (! vt->getFrameSnapshot(snap) || ! snap.image.isValid()) return;
+                fallbackImage_ = snap.image;
+                fallbackFrame_ = rendered;
+            }
+            if (auto glg = juce::createOpenGLGraphicsContext(context, w, h)) {
+                juce::Graphics g(*glg);
+                g.drawImageWithin(fallbackImage_, 0, 0, w, h, juce::RectanglePlacement::stretchToFit);
+            }
+        }
+       #if MILKDAWP_HAS_PROJECTM
+        // GL thread: passes the render size to projectM when it changes rather than every frame
+        void setProjectMWindowSize(int w, int h)
+        {
+            if (w == pmWindowW_ && h == pmWindowH_) return;
+            if (g_pm_set_window_size) g_pm_set_window_size(pmHandle, (size_t) w, (size_t) h);
+            pmWindowW_ = w;
+            pmWindowH_ = h;
+        }
+
+        void setHostShareHandle(void* handle)
+        {
+            hostShareHandle_.store(handle);
+            ++hostGeneration_;
+        }
+
+        // GL thread, canvas context current. Makes the render host current when projectM lives
+        // there (or is about to be created there); false means projectM uses the canvas context,
+        // because no preset is selected yet or the host isn't available on this platform/driver.
+        bool enterRenderHost()
+        {
+            if (hostUnavailable_ || owner == nullptr) return false;
+            if (pmHandle != nullptr && ! pmInHost_) return false;
+            if (pmHandle == nullptr) {
+                if (owner->getCurrentPresetPath().isEmpty()) return false;
+                // An (empty) host left over from a context this one doesn't share with is useless
+                if (pmHost_.isCreated() && ! canvasSharesHost_) {
+                    hostGpuTimer_.destroy(false);
+                    pmHost_.destroy();
+                    setHostShareHandle(nullptr);
+                }
+                if (! pmHost_.isCreated()) {
+                    const auto fallback = pmHost_.create(juce::SystemStats::getEnvironmentVariable("MDW_DISABLE_RENDER_HOST", "0") == "1",
+                                                         g_pm_opengl_render_frame_fbo != nullptr);
+                    if (fallback != milkdawp::RenderHostFallback::none) {
+                        hostUnavailable_ = true;
+                        hostFallback_.store(fallback);
+                        MDW_LOG_WARN(juce::String("projectM GL: no render host (") + milkdawp::describeRenderHostFallback(fallback)
+                                     + "); pop-out/fullscreen recreate projectM, the detached preview and mirror windows are unavailable");
+                        return false;
+                    }
+                    canvasSharesHost_ = true;
+                    setHostShareHandle(pmHost_.nativeHandle());
+                    MDW_LOG_INFO("projectM GL: render host context created");
+                }
+            }
+            if (! pmHost_.enter()) {
+                // projectM can't be destroyed outside its context, so an instance in the host is
+                // dropped; it is recreated in the canvas context from the next frame on
+                MDW_LOG_ERROR("projectM GL: could not make the render host current; falling back to the canvas context");
+                if (pmHandle != nullptr) {
+                    pmHandle = nullptr;
+                    pmReady = false;
+                    pmCanRender = false;
+                    lastPMPath.clear();
+                }
+                requestedPMPath_.clear();
+                pmInHost_ = false;
+                hostGpuTimer_.destroy(false);
+                pmHost_.destroy();
+                setHostShareHandle(nullptr);
+                hostUnavailable_ = true;
+                hostFallback_.store(milkdawp::RenderHostFallback::noSharedContext);
+                return false;
+            }
+            return true;
+        }
+
+        // GL thread: render projectM at pmRenderW_ x pmRenderH_. Below full scale it draws into
+        // an offscreen FBO that is stretched over the drawable with one linear-filtered blit, so
+        // the per-pixel warp/composite shaders run on scale^2 of the pixels. Falls back to the
+        // default framebuffer if the FBO cannot be created. In the render host it always draws
+        // into the host's target and the stretch happens in RenderHost::present; false if the
+        // host had no free target and the frame was skipped.
+        bool renderProjectMFrame()
+        {
+            using namespace juce::gl;
+            if (hosted_ && pmInHost_) {
+                // Always offscreen in the host; present() does the stretch in the canvas context
+                const bool timed = beginGpuTimer(hostGpuTimer_);
+                const GLuint fbo = pmHost_.prepareTarget(pmRenderW_, pmRenderH_);
+                if (fbo != 0) {
+                    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+                    glViewport(0, 0, pmRenderW_, pmRenderH_);
+                    g_pm_opengl_render_frame_fbo(pmHandle, (uint32_t) fbo);
+                    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                    pmHost_.markFrameRendered();
+                }
+                if (timed)
+                    hostGpuTimer_.end();
+                return fbo != 0;
+            }
+            const bool offscreen = pmRenderW_ != drawableW_ || pmRenderH_ != drawableH_;
+            GLuint target = 0;
+            if (offscreen) {
+                if (pmTarget.getWidth() != pmRenderW_ || pmTarget.getHeight() != pmRenderH_) {
+                    if (! pmTarget.initialise(context, pmRenderW_, pmRenderH_)) {
+                        MDW_LOG_ERROR(juce::String("projectM GL: offscreen render target allocation failed; rendering at full size while the drawable stays ")
+                                      + juce::String(drawableW_) + "x" + juce::String(drawableH_));
+                        pmTarget.release();
+                        targetFailedW_ = drawableW_;
+                        targetFailedH_ = drawableH_;
+                    } else {
+                        MDW_LOG_INFO(juce::String("projectM GL: render target ") + juce::String(pmRenderW_) + "x" + juce::String(pmRenderH_)
+                                     + " for drawable " + juce::String(drawableW_) + "x" + juce::String(drawableH_));
+                    }
+                }
+                target = pmTarget.getFrameBufferID();
+            }
+            if (target == 0 && offscreen) {
+                // No FBO: projectM must cover the whole drawable
+                pmRenderW_ = drawableW_;
+                pmRenderH_ = drawableH_;
+                setProjectMWindowSize(pmRenderW_, pmRenderH_);
+            }
+
+            const bool timed = beginGpuTimer(canvasGpuTimer_);
+            glBindFramebuffer(GL_FRAMEBUFFER, target);
+            glViewport(0, 0, pmRenderW_, pmRenderH_);
+            if (g_pm_opengl_render_frame_fbo)
+                g_pm_opengl_render_frame_fbo(pmHandle, (uint32_t) target);
+            else if (g_pm_opengl_render_frame)
+                g_pm_opengl_render_frame(pmHandle);
+
+            if (target != 0) {
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                glBlitFramebuffer(0, 0, pmRenderW_, pmRenderH_, 0, 0, drawableW_, drawableH_, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                glViewport(0, 0, drawableW_, drawableH_);
+            } else if (pmTarget.isValid()) {
+                pmTarget.release(); // back at full scale
+            }
+            if (timed)
+                canvasGpuTimer_.end();
+            return true;
+        }
+
+        // GL thread: starts timing this frame's work in the current context's ring, creating the
+        // ring on first use. Drivers without timer queries leave the GPU time unreported.
+        bool beginGpuTimer(milkdawp::GpuTimerRing& ring)
+        {
+            if (! ring.isCreated()) {
+                if (gpuTimingUnavailable_) return false;
+                const auto api = milkdawp::GpuTimerApi::resolve([](const char* name) {
+                    return juce::OpenGLHelpers::getExtensionFunction(name);
+                });
+                if (! ring.create(api)) {
+                    gpuTimingUnavailable_ = true;
+                    MDW_LOG_INFO("projectM GL: no timer queries; GPU frame time is not measured");
+                    return false;
+                }
+            }
+            if (! ring.begin(gpuFrameId_)) return false;
+            ++gpuParts_;
+            return true;
+        }
+
+        // GL thread, ring's context current: forwards finished frames' GPU time to adaptive quality
+        void collectGpuTimes(milkdawp::GpuTimerRing& ring)
+        {
+            ring.collect([this](uint64_t frameId, double ms) {
+                double frameMs = 0.0;
+                if (gpuFrames_.add(frameId, ms, frameMs) && owner != nullptr)
+                    if (auto* vt = owner->getVizThread())
+                        vt->reportGpuFrame(frameMs);
+            });
+        }
+
+        // GL thread: apply the viz thread's adaptive quality rung to projectM. Mesh size sets the
+        // per-vertex warp/shape cost; the frame rate is paced with the swap interval (integer
+        // divisors of the canvas display's refresh rate, see swapPacingFor) and the rate that
+        // gives is passed to projectM as its fps hint, so preset timing matches the rate frames
+        // are actually shown at. The render scale is applied by renderProjectMFrame.
+        void applyQualityProfile()
+        {
+            if (owner == nullptr) return;
+            auto* vt = owner->getVizThread();
+            if (vt == nullptr) return;
+            const auto q = vt->getQualityProfile();
+            if (q.meshWidth != appliedMeshW_ || q.meshHeight != appliedMeshH_) {
+                if (g_pm_set_mesh_size) g_pm_set_mesh_size(pmHandle, (size_t) q.meshWidth, (size_t) q.meshHeight);
+                appliedMeshW_ = q.meshWidth;
+                appliedMeshH_ = q.meshHeight;
+            }
+            const double refreshHz = displayRefreshHz_.load(std::memory_order_relaxed);
+            const auto pacing = milkdawp::swapPacingFor(q.targetFps, refreshHz);
+            const int fps = juce::jmax(1, juce::roundToInt(pacing.fps));
+            if (fps != appliedFps_ || pacing.interval != wantedSwapInterval_) {
+                wantedSwapInterval_ = pacing.interval;
+                if (g_pm_set_fps) g_pm_set_fps(pmHandle, fps);
+                appliedFps_ = fps;
+                MDW_LOG_INFO(juce::String("projectM GL: quality mesh=") + juce::String(q.meshWidth) + "x" + juce::String(q.meshHeight)
+                             + " fps=" + juce::String(fps) + " (swap interval " + juce::String(pacing.interval)
+                             + " at " + juce::String(refreshHz, 2) + " Hz)");
+            }
+        }
+       #endif
         void openGLContextClosing() override
         {
             // Free GL resources if any
         #if MILKDAWP_HAS_PROJECTM
+            pmHost_.releasePresenter();
+            canvasGpuTimer_.destroy();
+            frameReadback_.release();
+            appliedSwapInterval_ = -1;
+            if (pmInHost_ && pmHandle != nullptr && keepRenderHost_.load()) {
+                // Reparenting: projectM, its target and the current preset stay in the render host
+                MDW_LOG_INFO("VizOpenGLCanvas: OpenGL context closing for reparent; projectM kept in render host");
+                return;
+            }
+            const bool inHost = pmInHost_ && pmHost_.enter();
             if (pmHandle != nullptr) {
-                if (g_pm_destroy) g_pm_destroy(pmHandle);
+                if (pmInHost_ && ! inHost)
+                    MDW_LOG_ERROR("projectM: render host could not be made current; instance abandoned");
+                else if (g_pm_destroy)
+                    g_pm_destroy(pmHandle);
                 pmHandle = nullptr;
                 pmReady = false;
                 lastPMPath.clear();
             }
+            if (inHost) {
+                pmHost_.releaseTarget();
+                hostGpuTimer_.destroy();
+                pmHost_.leave();
+            } else {
+                hostGpuTimer_.destroy(false);
+            }
+            pmInHost_ = false;
+            requestedPMPath_.clear();
+            costWindowActive_ = false;
+            pmTarget.release();
+            targetFailedW_ = targetFailedH_ = -1;
+            appliedMeshW_ = appliedMeshH_ = appliedFps_ = -1;
         #endif
-        }
-        void timerCallback() override
-        {
-            // Unconditionally repaint; ensures CPU fallback animates even if a host attaches a GL context but never renders.
-            repaint();
+            fallbackImage_ = {};
         }
         void paint(juce::Graphics& g) override
         {
-           #if MILKDAWP_HAS_PROJECTM
-            // If projectM is ready and can render into GL, avoid drawing over it
-            if (pmHandle != nullptr && pmCanRender) {
-                return; // GL renderOpenGL will draw the frame
-            }
-           #endif
-            // CPU fallback: blit the latest frame produced by the VisualizationThread
+            // Only reached while no GL context is attached (reparenting, teardown); otherwise
+            // renderOpenGL draws everything, including the CPU fallback
             if (owner != nullptr) {
                 if (auto* vt = owner->getVizThread()) {
                     milkdawp::VisualizationThread::FrameSnapshot snap;
@@ -3607,19 +4656,61 @@ private:
             MDW_LOG_INFO(juce::String("VizCanvas resized: ") + juce::String(getWidth()) + "x" + juce::String(getHeight())
                          + " scale=" + juce::String(cachedDisplayScale_.load(), 2));
 
-            if (owner != nullptr) {
-                if (auto* vt = owner->getVizThread()) {
-                    vt->setSurfaceSize(getWidth(), getHeight());
-                }
+            syncVizSurface();
+            updateDisplayRefresh();
+        }
+        // Message thread: sizes the CPU renderer's surface to the canvas, and its captures to the
+        // GL drawable, so a recording keeps one frame size when the GL path comes and goes
+        void syncVizSurface()
+        {
+            if (owner == nullptr)
+                return;
+            if (auto* vt = owner->getVizThread()) {
+                vt->setSurfaceSize(getWidth(), getHeight());
+                const float scale = cachedDisplayScale_.load(std::memory_order_relaxed);
+                vt->setCaptureSize(juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+                                   juce::jmax(1, juce::roundToInt(getHeight() * scale)));
             }
         }
+        // Message thread: refresh rate of the display showing the canvas, for GL pacing. Checked
+        // whenever the canvas or a window above it moves, so dragging a pop-out to another
+        // monitor is picked up; platforms that don't report it are paced for 60 Hz.
+        void updateDisplayRefresh()
+        {
+            double hz = 60.0;
+            if (isShowing())
+                if (auto* d = juce::Desktop::getInstance().getDisplays().getDisplayForRect(getScreenBounds()))
+                    if (d->verticalFrequencyHz.has_value() && *d->verticalFrequencyHz >= 20.0)
+                        hz = *d->verticalFrequencyHz;
+            if (hz != displayRefreshHz_.exchange(hz, std::memory_order_relaxed))
+                MDW_LOG_INFO(juce::String("VizCanvas display refresh: ") + juce::String(hz, 2) + " Hz");
+        }
+        struct DisplayWatcher : juce::ComponentMovementWatcher {
+            explicit DisplayWatcher(VizOpenGLCanvas& c) : juce::ComponentMovementWatcher(&c), canvas(c) {}
+            void componentMovedOrResized(bool, bool) override { canvas.updateDisplayRefresh(); }
+            void componentPeerChanged() override { canvas.updateDisplayRefresh(); }
+            void componentVisibilityChanged() override { canvas.updateDisplayRefresh(); }
+            VizOpenGLCanvas& canvas;
+        };
         void setOwner(MilkDAWpAudioProcessor* p) { owner = p; }
         std::atomic<float> cachedDisplayScale_ { 1.0f };
+        std::atomic<double> displayRefreshHz_ { 60.0 };
+        DisplayWatcher displayWatcher_ { *this };
         juce::OpenGLContext context;
         double startTimeMs { 0.0 };
         std::atomic<bool> glContextCreated { false };
+        std::atomic<bool> keepRenderHost_ { false };      // closing is a reparent (see beginReparent)
+        std::atomic<void*> hostShareHandle_ { nullptr };  // native render host context, for the next canvas context
+        std::atomic<uint32_t> hostGeneration_ { 0 };      // bumped with every hostShareHandle_ change (mirrors rejoin)
+        std::atomic<milkdawp::RenderHostFallback> hostFallback_ { milkdawp::RenderHostFallback::none };
+        std::atomic<void*> sharedContextSet_ { nullptr }; // what the canvas context was last told to share with
+        int reparentDepth_ { 0 };                         // nested ReparentScopes (message thread)
+        std::atomic<double> reparentStartMs_ { 0.0 };     // outermost beginReparent, until its first frame
+        bool rendererReleased_ { false };                 // releaseRenderer() ran (message thread)
         std::atomic<uint64_t> lastGLFrameMs { 0 };
         MilkDAWpAudioProcessor* owner { nullptr };
+        juce::Image fallbackImage_;                       // CPU frame drawn while projectM isn't rendering (GL thread)
+        uint64_t fallbackFrame_ { 0 };                    // viz thread frame fallbackImage_ was taken at
 
        #if MILKDAWP_HAS_PROJECTM
         projectm_handle pmHandle { nullptr };
@@ -3633,12 +4724,176 @@ private:
         float lastAppliedSoftCutDur_  { -1.0f }; // last value sent to projectm_set_soft_cut_duration
         float lastAppliedHardCutDur_  { -1.0f }; // last value sent to projectm_set_hard_cut_duration
         std::atomic<double> lastHardCutMs { 0.0 }; // wall-clock time of last hard cut we processed
+        int appliedMeshW_ { -1 };                  // adaptive quality rung last applied (GL thread)
+        int appliedMeshH_ { -1 };
+        int appliedFps_   { -1 };
+        juce::OpenGLFrameBuffer pmTarget;          // offscreen projectM target below full scale (GL thread)
+        double pmScale_   { 1.0 };                 // stepped render scale in use (GL thread)
+        int drawableW_    { 2 };
+        int drawableH_    { 2 };
+        int pmRenderW_    { 2 };
+        int pmRenderH_    { 2 };
+        int pmWindowW_    { -1 };                  // size last passed to g_pm_set_window_size
+        int pmWindowH_    { -1 };
+        int targetFailedW_ { -1 };                 // drawable size pmTarget failed to allocate at
+        int targetFailedH_ { -1 };
+        milkdawp::PcmRing::ReadCursor pcmCursor_;  // PCM already fed to projectM (GL thread)
+        std::vector<float> pcmFeed_;               // persistent projectM feed buffers (GL thread)
+        std::vector<int16_t> pcmFeedI16_;
+        milkdawp::AsyncPresetLoader presetLoader_; // preset file reads off the GL thread
+        milkdawp::AsyncPresetLoader::Loaded presetSlot_; // GL thread side of the handoff
+        juce::String requestedPMPath_;             // last path handed to presetLoader_ (GL thread)
+        double presetRequestMs_ { 0.0 };           // when requestedPMPath_ was requested
+        static constexpr int switchWatchLength = 60;
+        int switchWatchFrames_ { 0 };              // frames left in the post-switch hitch window
+        double switchWorstMs_ { 0.0 };
+        RenderHost pmHost_ { renderHostGl() };     // projectM's own context, survives reparenting (GL thread)
+        bool hosted_ { false };                    // pmHost_ is current for this frame
+        bool pmInHost_ { false };                  // pmHandle was created in pmHost_
+        bool hostUnavailable_ { false };           // projectM lives in the canvas context instead
+        bool canvasSharesHost_ { false };          // the current canvas context is in pmHost_'s share group
+        int wantedSwapInterval_ { 1 };             // adaptive quality pacing, applied in the canvas context
+        milkdawp::GpuTimerRing canvasGpuTimer_;    // canvas context: present blit, or the whole frame off the host
+        milkdawp::GpuTimerRing hostGpuTimer_;      // render host: projectM and the preview levels
+        milkdawp::GpuFrameTimeAccumulator gpuFrames_;
+        uint64_t gpuFrameId_ { 0 };
+        int gpuParts_ { 0 };                       // timer queries begun for gpuFrameId_
+        bool gpuTimingUnavailable_ { false };
+        FrameReadback frameReadback_;              // canvas context, while the capture bus has sinks
+        uint64_t renderedFrames_ { 0 };            // projectM frames rendered, numbers captured frames
+        bool renderedThisFrame_ { false };
+        int appliedSwapInterval_ { -1 };
+        static constexpr int costWindowLength = 120;
+        bool costWindowActive_ { false };          // measuring the current preset for PresetCostProfile
+        std::vector<double> costFrames_;
+        juce::String costPath_;
+        juce::Time costModified_;
+        milkdawp::QualityProfile costRung_;
        #ifdef _WIN32
         /* Removed experimental PCM injection hooks after instability reports */
        #endif
        #endif
     };
 
+    // A second view of the canvas's visual: the editor preview while the canvas is popped out,
+    // and mirror windows on other displays. Its GL context joins the canvas's render host share
+    // group and only blits the latest frame (RenderHost::present) at its own size, so a mirror
+    // adds no projectM work. Without a render host it stays black; the editor doesn't show
+    // mirrors then.
+    struct VizMirrorCanvas : public juce::Component, public juce::OpenGLRenderer, private juce::Timer {
+        explicit VizMirrorCanvas(VizOpenGLCanvas& src) : source(src)
+        {
+            setOpaque(true);
+            context.setRenderer(this);
+            context.setContinuousRepainting(true);
+            context.setComponentPaintingEnabled(false);
+            // Joining the share group waits for the host; polled because it appears on the GL thread
+            startTimerHz(10);
+        }
+        ~VizMirrorCanvas() override
+        {
+            stopTimer();
+            context.detach();
+        }
+
+        void newOpenGLContextCreated() override
+        {
+           #if MILKDAWP_HAS_PROJECTM
+            source.getRenderHost().addOutput(output);
+           #endif
+            MDW_LOG_INFO("VizMirrorCanvas: OpenGL context created");
+        }
+        void renderOpenGL() override
+        {
+            float scale = cachedDisplayScale_.load(std::memory_order_relaxed);
+            if (scale <= 0.0f) scale = (float) context.getRenderingScale();
+            const int w = juce::jmax(1, juce::roundToInt(getWidth()  * scale));
+            const int h = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+            juce::gl::glViewport(0, 0, w, h);
+            juce::OpenGLHelpers::clear(juce::Colours::black);
+           #if MILKDAWP_HAS_PROJECTM
+            source.getRenderHost().present(output, w, h);
+           #endif
+        }
+        void openGLContextClosing() override
+        {
+           #if MILKDAWP_HAS_PROJECTM
+            source.getRenderHost().releaseOutput(output);
+            source.getRenderHost().removeOutput(output);
+           #endif
+        }
+        void timerCallback() override
+        {
+            // Follow the canvas's render host: join once it exists, rejoin when it is replaced,
+            // and let go of the context while hidden so it doesn't blit for nothing
+            void* handle = isShowing() ? source.getHostShareHandle() : nullptr;
+            const uint32_t generation = source.getHostGeneration();
+            if (handle == joinedHandle && generation == joinedGeneration) return;
+            context.detach();
+            joinedHandle = handle;
+            joinedGeneration = generation;
+            if (handle != nullptr) {
+                context.setNativeSharedContext(handle);
+                context.attachTo(*this);
+            }
+            repaint();
+        }
+        void paint(juce::Graphics& g) override
+        {
+            g.fillAll(juce::Colours::black);
+        }
+        void resized() override
+        {
+            if (auto* peer = getTopLevelComponent()->getPeer())
+                cachedDisplayScale_.store((float) peer->getPlatformScaleFactor(), std::memory_order_relaxed);
+        }
+        void visibilityChanged() override { timerCallback(); }
+
+        VizOpenGLCanvas& source;
+        juce::OpenGLContext context;
+        std::atomic<float> cachedDisplayScale_ { 1.0f };
+        void* joinedHandle { nullptr };            // share handle of the attached context (message thread)
+        uint32_t joinedGeneration { 0 };
+       #if MILKDAWP_HAS_PROJECTM
+        RenderHost::Output output;                 // GL thread of this mirror's context
+       #endif
+    };
+
+    // Borderless window showing a mirror canvas over a whole display, for a second monitor.
+    // Closed with Escape, a double click or from the settings.
+    class MirrorVisualizationWindow : public juce::DocumentWindow {
+    public:
+        MirrorVisualizationWindow(VizOpenGLCanvas& source, const juce::Displays::Display& d, std::function<void()> onCloseCb)
+            : juce::DocumentWindow("MilkDAWp Mirror", juce::Colours::black, DocumentWindow::closeButton),
+              mirror(source), onClose(std::move(onCloseCb))
+        {
+            setUsingNativeTitleBar(false);
+            setTitleBarHeight(0);
+            setResizable(false, false);
+            setDropShadowEnabled(false);
+            setOpaque(true);
+            setContentNonOwned(&mirror, false);
+            mirror.addMouseListener(this, false);
+            setBounds(d.totalArea);
+            setVisible(true);
+        }
+        ~MirrorVisualizationWindow() override
+        {
+            mirror.removeMouseListener(this);
+            clearContentComponent();
+        }
+        void closeButtonPressed() override { if (onClose) onClose(); }
+        bool keyPressed(const juce::KeyPress& key) override
+        {
+            if (key.getKeyCode() == juce::KeyPress::escapeKey) { closeButtonPressed(); return true; }
+            return juce::DocumentWindow::keyPressed(key);
+        }
+        void mouseDoubleClick(const juce::MouseEvent&) override { closeButtonPressed(); }
+    private:
+        VizMirrorCanvas mirror;
+        std::function<void()> onClose;
+    };
+
     HardwareLookAndFeel hardwareLAF;
     juce::Label logoLabel;
     juce::ImageComponent logoImage;
@@ -3646,6 +4901,7 @@ private:
     bool logoLoaded { false };
     juce::Rectangle<int> logoTargetBounds;
     VizOpenGLCanvas vizCanvas;
+    VizMirrorCanvas previewCanvas { vizCanvas }; // editor view of the frames while vizCanvas is detached
 
     // Detached window support (Phase 5.1)
     juce::DrawableButton popOutButton { "popOutButton", juce::DrawableButton::ImageFitted };
@@ -3653,6 +4909,7 @@ private:
     juce::DrawableButton settingsButton { "settingsButton", juce::DrawableButton::ImageFitted };
     juce::Label detachedNotice;
     std::unique_ptr<ExternalVisualizationWindow> externalWindow;
+    std::unique_ptr<MirrorVisualizationWindow> mirrorWindow; // second-display mirror (settings)
     bool isDetached { false };
     bool isFullscreen { false };
 
@@ -3673,6 +4930,7 @@ private:
     juce::DrawableButton nextButton { "nextButton", juce::DrawableButton::ImageFitted };
     juce::Label presetNameLabel;
     juce::String lastDisplayedName;
+    milkdawp::QualityBudgetCoordinator::Priority lastBudgetPriority { milkdawp::QualityBudgetCoordinator::Priority::Background };
     int lastKnownPlaylistSize { 0 }; // Phase 6.2 tracking
     bool updatingPresetCombo { false }; // guard to avoid feedback
 
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace milkdawp {
+
+// Per-preset results of tools/PresetBench and the report it writes. Kept free of GL so the
+// statistics and the output format are covered by the unit tests.
+struct PresetBenchResult {
+    juce::String path;
+    bool loaded = false;        // false if projectM rejected the preset
+    juce::String error;
+    double loadMs = 0.0;        // projectm_load_preset_file, parse and program build
+    double firstFrameMs = 0.0;  // first render after the load (lazy shader compiles land here)
+    double warmUpMs = 0.0;      // --warm: building the preset on a small instance before the load
+    double p50Ms = 0.0;         // steady-state frames after the first one
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    int frames = 0;             // steady-state frames measured
+
+    // What a switch to this preset costs on the render thread
+    double switchHitchMs() const noexcept { return loadMs + firstFrameMs; }
+    // Ranking key: the larger of the switch hitch and the steady-state tail
+    double worstMs() const noexcept { return juce::jmax(switchHitchMs(), p99Ms); }
+};
+
+struct PresetBenchReport {
+    // Nearest-rank percentile (p in 0..100) of unsorted samples; 0 for no samples
+    static double percentile(std::vector<double> samples, double p)
+    {
+        if (samples.empty()) return 0.0;
+        std::sort(samples.begin(), samples.end());
+        const double rank = std::ceil(juce::jlimit(0.0, 100.0, p) / 100.0 * (double)samples.size());
+        const size_t idx = (size_t)juce::jlimit(1.0, (double)samples.size(), rank) - 1;
+        return samples[idx];
+    }
+
+    static void setSteadyFrames(PresetBenchResult& r, const std::vector<double>& frameMs)
+    {
+        r.frames = (int)frameMs.size();
+        r.p50Ms = percentile(frameMs, 50.0);
+        r.p99Ms = percentile(frameMs, 99.0);
+        r.maxMs = frameMs.empty() ? 0.0 : *std::max_element(frameMs.begin(), frameMs.end());
+    }
+
+    // Presets that failed to load first (blacklist candidates), then by worstMs descending
+    static void sortWorstFirst(std::vector<PresetBenchResult>& results)
+    {
+        std::stable_sort(results.begin(), results.end(), [](const PresetBenchResult& a, const PresetBenchResult& b)
+        {
+            if (a.loaded != b.loaded) return ! a.loaded;
+            return a.worstMs() > b.worstMs();
+        });
+    }
+
+    static juce::String toCsv(const std::vector<PresetBenchResult>& results)
+    {
+        juce::String out = "path,loaded,load_ms,first_frame_ms,switch_hitch_ms,warm_up_ms,p50_ms,p99_ms,max_ms,frames,error\n";
+        for (const auto& r : results)
+            out << csvField(r.path) << "," << (r.loaded ? "1" : "0") << ","
+                << ms(r.loadMs) << "," << ms(r.firstFrameMs) << "," << ms(r.switchHitchMs()) << "," << ms(r.warmUpMs) << ","
+                << ms(r.p50Ms) << "," << ms(r.p99Ms) << "," << ms(r.maxMs) << ","
+                << juce::String(r.frames) << "," << csvField(r.error) << "\n";
+        return out;
+    }
+
+    static juce::String toJson(const std::vector<PresetBenchResult>& results)
+    {
+        juce::String out = "[\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            out << "  {\"path\": " << jsonString(r.path)
+                << ", \"loaded\": " << (r.loaded ? "true" : "false")
+                << ", \"load_ms\": " << ms(r.loadMs)
+                << ", \"first_frame_ms\": " << ms(r.firstFrameMs)
+                << ", \"switch_hitch_ms\": " << ms(r.switchHitchMs())
+                << ", \"warm_up_ms\": " << ms(r.warmUpMs)
+                << ", \"p50_ms\": " << ms(r.p50Ms)
+                << ", \"p99_ms\": " << ms(r.p99Ms)
+                << ", \"max_ms\": " << ms(r.maxMs)
+                << ", \"frames\": " << juce::String(r.frames)
+                << ", \"error\": " << jsonString(r.error) << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+        return out;
+    }
+
+private:
+    static juce::String ms(double v) { return juce::String(v, 3); }
+
+    static juce::String csvField(const juce::String& s)
+    {
+        if (! s.containsAnyOf(",\"\r\n")) return s;
+        return "\"" + s.replace("\"", "\"\"") + "\"";
+    }
+
+    static juce::String jsonString(const juce::String& s)
+    {
+        juce::String out = "\"";
+        for (auto c : s)
+        {
+            switch (c)
+            {
+                case '"':  out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\r': out << "\\r"; break;
+                case '\t': out << "\\t"; break;
+                default:
+                    if (c < 0x20) out << "\\u" << juce::String::toHexString((int)c).paddedLeft('0', 4);
+                    else out << juce::String::charToString(c);
+            }
+        }
+        return out + "\"";
+    }
+};
+
+} // namespace milkdawp
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "AdaptiveQuality.h"
+#include "Logging.h"
+
+namespace milkdawp {
+
+// Observed steady-state render cost per preset, shared by all instances in the process and
+// persisted to a small table next to the log so it survives sessions. Keyed by full path like
+// SharedAssetCache; an entry only counts while the file's modification time still matches the
+// one it was measured against, so editing a preset discards its cost.
+//
+// Costs are stored normalised to the top quality rung (measured ms / relativeFrameCost() of the
+// rung it was rendered at), so measurements taken while adaptive quality had stepped down stay
+// comparable and can be projected onto whatever rung is current.
+//
+// Table format (UTF-8 text): a "# MilkDAWp preset cost v1" line, then one
+// "path<TAB>modifiedMs<TAB>frameMs<TAB>samples" line per preset.
+class PresetCostProfile {
+public:
+    struct Entry {
+        double frameMs = 0.0;     // steady-state frame time at the top rung (EMA over samples)
+        int samples = 0;          // measurement windows folded into frameMs
+        juce::Time lastModified;  // file timestamp the measurements belong to
+    };
+
+    static PresetCostProfile& instance()
+    {
+        static PresetCostProfile inst;
+        return inst;
+    }
+
+    static juce::File defaultFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("MilkDAWp").getChildFile("preset-costs.tsv");
+    }
+
+    // Folds one steady-state measurement (frame time at the given rung) into the preset's entry.
+    // A changed modification time restarts the entry.
+    void record(const juce::String& fullPath, const juce::Time& modified, double observedMs, const QualityProfile& rung)
+    {
+        if (fullPath.isEmpty() || ! (observedMs > 0.0)) return;
+        const double normalisedMs = observedMs / juce::jmax(0.01, rung.relativeFrameCost());
+        const juce::ScopedLock sl(lock);
+        Entry e;
+        if (map.contains(fullPath))
+            e = map[fullPath];
+        if (e.samples == 0 || e.lastModified != modified)
+            e = Entry{ normalisedMs, 1, modified };
+        else
+        {
+            e.frameMs += emaWeight * (normalisedMs - e.frameMs);
+            e.samples = juce::jmin(e.samples + 1, 1000);
+        }
+        map.set(fullPath, e);
+        dirty = true;
+    }
+
+    // True if a measurement exists for this exact file version
+    bool lookup(const juce::String& fullPath, const juce::Time& modified, Entry& out) const
+    {
+        const juce::ScopedLock sl(lock);
+        if (! map.contains(fullPath)) return false;
+        const auto e = map[fullPath];
+        if (e.samples <= 0 || e.lastModified != modified) return false;
+        out = e;
+        return true;
+    }
+
+    // Projected frame time of the preset at the given rung; 0 if unknown or stale
+    double projectedMs(const juce::String& fullPath, const juce::Time& modified, const QualityProfile& rung) const
+    {
+        Entry e;
+        return lookup(fullPath, modified, e) ? e.frameMs * rung.relativeFrameCost() : 0.0;
+    }
+
+    // True only for presets known to overrun the rung's frame budget; unmeasured presets never are
+    bool exceedsBudget(const juce::String& fullPath, const juce::Time& modified, const QualityProfile& rung) const
+    {
+        return projectedMs(fullPath, modified, rung) > rung.budgetMs();
+    }
+
+    bool exceedsBudget(const juce::File& file, const QualityProfile& rung) const
+    {
+        return exceedsBudget(file.getFullPathName(), file.getLastModificationTime(), rung);
+    }
+
+    // Replaces the in-memory table with the file's contents. Returns false if unreadable.
+    bool load(const juce::File& file)
+    {
+        if (! file.existsAsFile()) return false;
+        juce::StringArray lines;
+        lines.addLines(file.loadFileAsString());
+        if (lines.isEmpty() || ! lines[0].startsWith(header)) return false;
+
+        const juce::ScopedLock sl(lock);
+        map.clear();
+        for (int i = 1; i < lines.size(); ++i)
+        {
+            juce::StringArray fields;
+            fields.addTokens(lines[i], "\t", {});
+            if (fields.size() != 4 || fields[0].isEmpty()) continue;
+            Entry e;
+            e.lastModified = juce::Time(fields[1].getLargeIntValue());
+            e.frameMs = fields[2].getDoubleValue();
+            e.samples = fields[3].getIntValue();
+            if (e.frameMs > 0.0 && e.samples > 0)
+                map.set(fields[0], e);
+        }
+        dirty = false;
+        return true;
+    }
+
+    bool save(const juce::File& file)
+    {
+        juce::String text = juce::String(header) + "\n";
+        {
+            const juce::ScopedLock sl(lock);
+            for (juce::HashMap<juce::String, Entry>::Iterator it(map); it.next();)
+            {
+                const auto& e = it.getValue();
+                text << it.getKey() << "\t" << juce::String(e.lastModified.toMilliseconds()) << "\t"
+                     << juce::String(e.frameMs, 3) << "\t" << juce::String(e.samples) << "\n";
+            }
+            dirty = false;
+        }
+        file.getParentDirectory().createDirectory();
+        if (file.replaceWithText(text)) return true;
+        MDW_LOG_WARN(juce::String("Preset cost profile: could not write ") + file.getFullPathName());
+        return false;
+    }
+
+    // Loads defaultFile() once per process
+    void ensureLoaded()
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            if (loadedDefault) return;
+            loadedDefault = true;
+        }
+        load(defaultFile());
+    }
+
+    // Writes defaultFile() if anything was recorded since the last save and at least
+    // minIntervalMs passed since then
+    void saveIfDirty(double minIntervalMs = 0.0)
+    {
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        {
+            const juce::ScopedLock sl(lock);
+            if (! dirty || (lastSaveMs > 0.0 && now - lastSaveMs < minIntervalMs)) return;
+            lastSaveMs = now;
+        }
+        save(defaultFile());
+    }
+
+    int size() const
+    {
+        const juce::ScopedLock sl(lock);
+        return map.size();
+    }
+
+    void clear()
+    {
+        const juce::ScopedLock sl(lock);
+        map.clear();
+        dirty = false;
+    }
+
+private:
+    PresetCostProfile() = default;
+
+    static constexpr const char* header = "# MilkDAWp preset cost v1";
+    static constexpr double emaWeight = 0.3;
+
+    mutable juce::CriticalSection lock;
+    juce::HashMap<juce::String, Entry> map; // key: full path
+    bool dirty = false;
+    bool loadedDefault = false;
+    double lastSaveMs = 0.0;
+};
+
+} // namespace milkdawp
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace milkdawp {
+
+// Preset discovery shared by the playlist and the preset benchmark tool: the *.milk files
+// directly inside a folder, minus those matched by the folder's ignore file(s), sorted by name.
+//
+// Phase 6.3 ignore files: ".milkignore" or ".milkdrop-ignore.txt", one pattern or filename per
+// line, '#' starts a comment. Entries containing '*' or '?' are wildcards matched against the
+// whole file name; anything else matches as a substring (case-insensitive throughout).
+struct PresetFolderScan {
+    // Adds the entries of one ignore file's text (lower-cased, de-duplicated)
+    static void addIgnoreEntries(const juce::String& text, juce::StringArray& entries)
+    {
+        juce::StringArray lines;
+        lines.addLines(text);
+        for (auto& ln : lines) {
+            auto t = ln.trim();
+            if (t.isEmpty()) continue;
+            if (t.startsWithIgnoreCase("#")) continue;
+            entries.addIfNotAlreadyThere(t.toLowerCase());
+        }
+    }
+
+    static juce::StringArray readIgnoreEntries(const juce::File& dir)
+    {
+        juce::StringArray entries;
+        for (auto* name : { ".milkignore", ".milkdrop-ignore.txt" }) {
+            const auto f = dir.getChildFile(name);
+            if (f.existsAsFile())
+                addIgnoreEntries(f.loadFileAsString(), entries);
+        }
+        return entries;
+    }
+
+    static bool isIgnored(const juce::String& fileName, const juce::StringArray& entries)
+    {
+        const auto name = fileName.toLowerCase();
+        for (auto& pat : entries) {
+            if (pat.containsChar('*') || pat.containsChar('?')) {
+                if (name.matchesWildcard(pat, true)) return true;
+            } else if (name == pat || name.contains(pat)) { // allow substring match
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Empty if dir is not a directory
+    static juce::Array<juce::File> scan(const juce::File& dir)
+    {
+        juce::Array<juce::File> found;
+        if (! dir.isDirectory()) return found;
+
+        juce::DirectoryIterator it(dir, false, "*.milk", juce::File::findFiles);
+        const auto ignoreEntries = readIgnoreEntries(dir);
+        while (it.next())
+            if (! isIgnored(it.getFile().getFileName(), ignoreEntries))
+                found.add(it.getFile());
+
+        struct FileNameComparator { int compareElements(juce::File a, juce::File b) const { return a.getFileName().compareIgnoreCase(b.getFileName()); } } comp;
+        found.sort(comp);
+        return found;
+    }
+};
+
+} // namespace milkdawp
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Logging.h"
+#include "SharedAssetCache.h"
+
+namespace milkdawp {
+
+// Warms the presets the playlist will switch to next. The processor hands over the upcoming
+// paths (next items in sequential mode, pre-rolled picks in shuffle mode) right after each
+// switch; a background thread reads them into memory and publishes their metadata to
+// SharedAssetCache, so the switch that follows seconds later finds the file already read.
+//
+// Entries are consumed by take() (AsyncPresetLoader's worker). Paths that drop out of the
+// upcoming set are kept until the cache is over capacity, so the preset being switched to
+// right now is not evicted by the prefetch scheduled for the one after it. Upcoming paths are
+// never evicted; prefetch() keeps at most capacity of them, so they always fit.
+class PresetPrefetcher {
+public:
+    struct Stats {
+        uint64_t hits = 0;      // switches served from the prefetch cache
+        uint64_t misses = 0;    // switches that had to read from disk
+        double avgHitMs = 0.0;  // EMA of request-to-swap latency
+        double avgMissMs = 0.0;
+    };
+
+    static constexpr int defaultCapacity = 4;
+
+    explicit PresetPrefetcher(int capacityEntries = defaultCapacity) : capacity(juce::jmax(1, capacityEntries)) {}
+    ~PresetPrefetcher() { stop(); }
+
+    // Message thread: replaces the set of upcoming presets, nearest first (starts the worker on
+    // first use). Beyond capacity only the nearest are read.
+    void prefetch(const juce::StringArray& upcoming)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            wanted = upcoming;
+            wanted.removeEmptyStrings();
+            wanted.removeDuplicates(false);
+            wanted.removeRange(capacity, wanted.size() - capacity);
+        }
+        if (upcoming.isEmpty()) return;
+        if (! worker.joinable())
+        {
+            exitFlag.store(false, std::memory_order_relaxed);
+            worker = std::thread([this] { run(); });
+        }
+        wake.signal();
+    }
+
+    // Any thread: moves the prefetched contents of path into out and drops the entry.
+    // Returns false if path was not prefetched (yet) or could not be read.
+    bool take(const juce::String& path, std::string& out)
+    {
+        const juce::ScopedLock sl(lock);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (entries[i].path != path) continue;
+            const bool ok = entries[i].ok;
+            if (ok) out.swap(entries[i].data);
+            entries.erase(entries.begin() + (std::ptrdiff_t)i);
+            wanted.removeString(path); // consumed; don't read it again
+            return ok;
+        }
+        return false;
+    }
+
+    bool isCached(const juce::String& path) const
+    {
+        const juce::ScopedLock sl(lock);
+        for (const auto& e : entries)
+            if (e.path == path) return e.ok;
+        return false;
+    }
+
+    // Switch latency (request to swap) and whether the preset came from this cache
+    void recordSwitch(bool hit, double latencyMs)
+    {
+        const juce::ScopedLock sl(lock);
+        const double alpha = 0.2;
+        if (hit) { ++stats.hits;   stats.avgHitMs  = stats.hits == 1   ? latencyMs : (1.0 - alpha) * stats.avgHitMs  + alpha * latencyMs; }
+        else     { ++stats.misses; stats.avgMissMs = stats.misses == 1 ? latencyMs : (1.0 - alpha) * stats.avgMissMs + alpha * latencyMs; }
+    }
+
+    Stats getStats() const
+    {
+        const juce::ScopedLock sl(lock);
+        return stats;
+    }
+
+    void stop()
+    {
+        exitFlag.store(true, std::memory_order_relaxed);
+        wake.signal();
+        if (worker.joinable())
+            worker.join();
+    }
+
+private:
+    struct Entry {
+        juce::String path;
+        std::string data;
+        bool ok = false;
+    };
+
+    void run()
+    {
+        while (! exitFlag.load(std::memory_order_relaxed))
+        {
+            juce::String path;
+            {
+                const juce::ScopedLock sl(lock);
+                for (const auto& p : wanted)
+                {
+                    bool have = false;
+                    for (const auto& e : entries)
+                        if (e.path == p) { have = true; break; }
+                    if (! have) { path = p; break; }
+                }
+            }
+            if (path.isEmpty())
+            {
+                wake.wait(100.0);
+                continue;
+            }
+
+            Entry e;
+            e.path = path;
+            const juce::File f(path);
+            if (f.existsAsFile())
+                e.data = f.loadFileAsString().toStdString();
+            e.ok = ! e.data.empty();
+            if (e.ok)
+            {
+                // Same metadata the viz thread derives on a cache miss, so its switch is a hit
+                SharedAssetCache::PresetMeta meta;
+                meta.name = f.getFileNameWithoutExtension();
+                meta.paletteIndex = SharedAssetCache::derivePaletteIndex(meta.name);
+                meta.lastModified = f.getLastModificationTime();
+                auto& cache = SharedAssetCache::instance();
+                SharedAssetCache::PresetMeta existing;
+                if (cache.getPresetMeta(path, existing)) meta.refCount = existing.refCount;
+                cache.upsertPresetMeta(path, meta);
+            }
+            else
+            {
+                MDW_LOG_WARN(juce::String("Prefetch: could not read ") + path);
+            }
+
+            const juce::ScopedLock sl(lock);
+            entries.push_back(std::move(e));
+            evictOverCapacity();
+        }
+    }
+
+    // Oldest entries that are no longer upcoming go first. An upcoming one would only be read
+    // again on the next pass, and as wanted holds at most capacity distinct paths there is always
+    // another entry to drop.
+    void evictOverCapacity()
+    {
+        while ((int)entries.size() > capacity)
+        {
+            auto victim = std::find_if(entries.begin(), entries.end(), [this](const Entry& e) { return ! wanted.contains(e.path); });
+            if (victim == entries.end()) break;
+            entries.erase(victim);
+        }
+    }
+
+    const int capacity;
+    mutable juce::CriticalSection lock;
+    juce::StringArray wanted;       // guarded by lock
+    std::vector<Entry> entries;     // guarded by lock, oldest first
+    Stats stats;                    // guarded by lock
+
+    juce::WaitableEvent wake;
+    std::atomic<bool> exitFlag{ false };
+    std::thread worker;
+};
+
+} // namespace milkdawp
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cmath>
+#include <vector>
+#include "Logging.h"
+
+namespace milkdawp {
+
+// Phase 8.2: process-global render budget shared by all plugin instances in the host.
+// Each VisualizationThread reports its per-frame render cost; the coordinator estimates what
+// every instance would cost at full resolution and divides a global CPU budget among them by
+// priority (focused/fullscreen first, then visible, then background). The result is a
+// per-instance cap on the resolution scale, applied on top of that instance's own AQ decision,
+// so background instances degrade before the one the user is looking at.
+class QualityBudgetCoordinator {
+public:
+    enum class Priority { Background = 0, Visible = 1, Focused = 2 };
+
+    static constexpr double minCap = 0.25;   // never starve an instance below this scale
+    static constexpr double costSmoothing = 0.1;
+
+    static QualityBudgetCoordinator& instance()
+    {
+        static QualityBudgetCoordinator inst;
+        return inst;
+    }
+
+    QualityBudgetCoordinator()
+    {
+        // Default: half of the machine's cores worth of render time per second
+        setGlobalBudgetMsPerSecond(1000.0 * juce::jmax(1, juce::SystemStats::getNumCpus() / 2));
+    }
+
+    int registerInstance()
+    {
+        const juce::ScopedLock sl(lock);
+        Entry e;
+        e.id = nextId++;
+        entries.push_back(e);
+        reallocate();
+        return e.id;
+    }
+
+    void unregisterInstance(int id)
+    {
+        const juce::ScopedLock sl(lock);
+        for (size_t i = 0; i < entries.size(); ++i)
+            if (entries[i].id == id) { entries.erase(entries.begin() + (std::ptrdiff_t)i); break; }
+        reallocate();
+    }
+
+    void setPriority(int id, Priority p)
+    {
+        const juce::ScopedLock sl(lock);
+        if (auto* e = find(id))
+            if (e->priority != p) { e->priority = p; reallocate(); }
+    }
+
+    // Viz thread, once per frame: render time at the scale actually used, and the frame rate.
+    // Returns the cap on this instance's resolution scale.
+    double reportFrame(int id, double renderMs, double scale, double fps)
+    {
+        const juce::ScopedLock sl(lock);
+        auto* e = find(id);
+        if (e == nullptr) return 1.0;
+        // Render cost scales with pixel count, so normalise to full resolution
+        const double s = juce::jlimit(minCap, 1.0, scale);
+        const double fullCost = juce::jmax(0.0, renderMs) * juce::jmax(1.0, fps) / (s * s);
+        e->fullCostMsPerSec = e->fullCostMsPerSec <= 0.0 ? fullCost
+                            : e->fullCostMsPerSec + costSmoothing * (fullCost - e->fullCostMsPerSec);
+        reallocate();
+        return e->cap;
+    }
+
+    double getScaleCap(int id) const
+    {
+        const juce::ScopedLock sl(lock);
+        for (auto& e : entries)
+            if (e.id == id) return e.cap;
+        return 1.0;
+    }
+
+    void setGlobalBudgetMsPerSecond(double ms)
+    {
+        const juce::ScopedLock sl(lock);
+        budgetMsPerSec = juce::jmax(1.0, ms);
+        reallocate();
+    }
+
+    double getGlobalBudgetMsPerSecond() const { const juce::ScopedLock sl(lock); return budgetMsPerSec; }
+    int getNumInstances() const { const juce::ScopedLock sl(lock); return (int)entries.size(); }
+
+private:
+    struct Entry {
+        int id = 0;
+        Priority priority = Priority::Background;
+        double fullCostMsPerSec = 0.0; // EMA of render cost at scale 1.0
+        double cap = 1.0;
+    };
+
+    Entry* find(int id)
+    {
+        for (auto& e : entries)
+            if (e.id == id) return &e;
+        return nullptr;
+    }
+
+    // Serve priority groups in order. Each group gets a uniform scale s with
+    // sum(cost) * s^2 <= remaining budget; whatever it does not use passes down.
+    void reallocate()
+    {
+        double remaining = budgetMsPerSec;
+        for (auto p : { Priority::Focused, Priority::Visible, Priority::Background })
+        {
+            double groupCost = 0.0;
+            for (auto& e : entries)
+                if (e.priority == p) groupCost += e.fullCostMsPerSec;
+
+            double s = 1.0;
+            if (groupCost > 0.0)
+                s = juce::jlimit(minCap, 1.0, std::sqrt(juce::jmax(0.0, remaining) / groupCost));
+            for (auto& e : entries)
+                if (e.priority == p) e.cap = s;
+            remaining -= groupCost * s * s;
+        }
+    }
+
+    juce::CriticalSection lock;
+    std::vector<Entry> entries;
+    int nextId = 1;
+    double budgetMsPerSec = 1000.0;
+};
+
+} // namespace milkdawp
@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_graphics/juce_graphics.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "Logging.h"
+
+namespace milkdawp {
+
+// The GL work RenderHost issues, as plain function pointers so this header needs no GL headers
+// and the slot, reader and fence bookkeeping can be tested without a context (the plugin fills
+// it from juce::gl, see renderHostGl() in PluginProcessor.cpp). Each entry is one short GL
+// sequence in the context named in its comment.
+struct RenderHostGl {
+    using Sync = void*; // GLsync
+
+    Sync (*fenceSync)() = nullptr;      // glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)
+    void (*waitSync)(Sync) = nullptr;   // glWaitSync: the GPU waits, the calling thread doesn't
+    void (*deleteSync)(Sync) = nullptr;
+    void (*flush)() = nullptr;
+    // Host context: creates fbo and tex when they are 0, then allocates tex at w x h (level 0
+    // only) as fbo's colour attachment
+    void (*allocateTarget)(unsigned int& fbo, unsigned int& tex, int w, int h) = nullptr;
+    void (*deleteTarget)(unsigned int fbo, unsigned int tex) = nullptr;
+    void (*buildLevels)(unsigned int tex, int levels) = nullptr; // mip levels 1..levels
+    // Output context: reads through readFbo (created when 0), attaching tex at level first if
+    // attach is set, and stretches srcW x srcH over the drawable
+    void (*blitToDrawable)(unsigned int& readFbo, unsigned int tex, int level, bool attach,
+                           int srcW, int srcH, int drawW, int drawH) = nullptr;
+    void (*deleteFramebuffer)(unsigned int fbo) = nullptr;
+};
+
+// Why projectM has no render host, in the order create() checks. Without one projectM lives in
+// the canvas context: pop-out, fullscreen and docking recreate it, and the outputs that only
+// present the host's frames (the editor preview while detached, mirror windows) are unavailable.
+enum class RenderHostFallback {
+    none,                // the host was created
+    unsupportedPlatform, // canvas contexts can't join its share group (macOS)
+    disabled,            // MDW_DISABLE_RENDER_HOST=1
+    noFboEntryPoint,     // projectM can't render into the host's framebuffer
+    noSharedContext      // the driver wouldn't create a context sharing with the canvas
+};
+
+inline const char* describeRenderHostFallback(RenderHostFallback f)
+{
+    switch (f)
+    {
+        case RenderHostFallback::none:                return "available";
+        case RenderHostFallback::unsupportedPlatform: return "not supported on this platform";
+        case RenderHostFallback::disabled:            return "disabled by MDW_DISABLE_RENDER_HOST";
+        case RenderHostFallback::noFboEntryPoint:     return "projectM lacks projectm_opengl_render_frame_fbo";
+        case RenderHostFallback::noSharedContext:     return "no shared GL context from the driver";
+    }
+    return "unknown";
+}
+
+// projectM's own GL context. The canvas's context is destroyed whenever the canvas moves to
+// another native window (pop-out, fullscreen, docking back), and a projectM instance can't
+// outlive the context it was created in. So projectM lives in a context of its own that
+// shares objects with the canvas: each frame the GL thread switches to it on the canvas's
+// drawable, renders into the host's texture, switches back and blits that texture. A canvas
+// context created later joins the host's share group (OpenGLContext::setNativeSharedContext),
+// so the projectM instance, its programs and textures and the loaded preset carry over.
+//
+// The rendered frame is also the only thing other outputs see. Mirror canvases (the editor
+// preview while the visual is popped out, mirror windows on other displays) and capture
+// readers join the same share group and present the latest published frame at their own
+// size, so any number of outputs cost one projectM render plus one blit each. Frames rotate
+// through frameSlots textures: projectM never draws into the published one or one a reader
+// holds, and fences order the GPU work between contexts in both directions. When an output
+// is at most half the render size, the producer also builds mip levels once per frame and
+// that output blits from the level nearest its size instead of filtering the whole frame.
+//
+// Context is the platform's shared context (BackgroundGLContext in the plugin): sharesWithCanvas,
+// create() and destroy() with the canvas context current, makeCurrentOnCurrentDrawable()/restorePrevious()
+// around the host's work, and nativeHandle() for the canvases that join its share group.
+template <typename Context>
+class BasicRenderHost
+{
+public:
+    static constexpr int frameSlots = 3;
+    static constexpr int maxPreviewLevel = 4; // 1/16 of the render size
+    static constexpr double maxTargetWaitMs = 2.0;
+
+    // One presenting context's state. Registered while the output is alive; all members
+    // but the FBO bookkeeping are guarded by the host's lock.
+    struct Output {
+        unsigned int readFbo = 0;              // output context, reads the slot texture
+        unsigned int attachedTex = 0;
+        int attachedLevel = -1;
+        uint64_t attachedEpoch = 0;
+        int wantLevel = 0;                     // mip level that matches this output's size
+        int drawW = 0, drawH = 0;              // drawable size at the last present
+        RenderHostGl::Sync readDone[frameSlots] {}; // last blit from each slot, for the producer
+    };
+
+    explicit BasicRenderHost(const RenderHostGl& api) : gl(api) { addOutput(primary); }
+    ~BasicRenderHost() { removeOutput(primary); }
+
+    // GL thread, canvas context current: creates the host context, or says why projectM stays
+    // in the canvas context
+    RenderHostFallback create(bool disabled, bool hasFboEntryPoint)
+    {
+        if (! Context::sharesWithCanvas) return RenderHostFallback::unsupportedPlatform;
+        if (disabled) return RenderHostFallback::disabled;
+        if (! hasFboEntryPoint) return RenderHostFallback::noFboEntryPoint;
+        if (! ctx.create()) return RenderHostFallback::noSharedContext;
+        if (ctx.nativeHandle() != nullptr) return RenderHostFallback::none;
+        ctx.destroy(); // nothing a later canvas context could share with
+        return RenderHostFallback::noSharedContext;
+    }
+    // Not current on any thread; GL objects go with the context (or with the last mirror
+    // still in the share group)
+    void destroy()
+    {
+        ctx.destroy();
+        const juce::ScopedLock sl(lock);
+        for (auto& s : slots)
+            s = Slot{};
+        for (auto* o : outputs) // fences of the old share group; mirrors rejoin the new one
+            for (auto& f : o->readDone)
+                f = nullptr;
+        published = -1;
+        writing = -1;
+        ++epoch;
+    }
+    bool isCreated() const { return ctx.nativeHandle() != nullptr; }
+    void* nativeHandle() const { return ctx.nativeHandle(); }
+    uint64_t getSkippedFrames() const noexcept { return skippedFrames; }
+
+    // GL thread: switch from the canvas context to the host and back
+    bool enter()
+    {
+        if (ctx.makeCurrentOnCurrentDrawable()) return true;
+        ctx.restorePrevious();
+        return false;
+    }
+    void leave()
+    {
+        gl.flush();
+        ctx.restorePrevious();
+    }
+
+    // Host current: the framebuffer projectM renders the next frame into, w x h. Picks a
+    // slot no reader holds and waits (on the GPU) for the blits that last read it. 0 if the
+    // spare slots stayed held for maxTargetWaitMs: the frame is skipped and the outputs keep
+    // presenting the last one.
+    unsigned int prepareTarget(int w, int h)
+    {
+        std::vector<RenderHostGl::Sync> reads;
+        const double startMs = juce::Time::getMillisecondCounterHiRes();
+        for (;;) {
+            {
+                const juce::ScopedLock sl(lock);
+                int pick = -1;
+                for (int i = 0; i < frameSlots; ++i)
+                    if (i != published && slots[i].readers == 0 && (pick < 0 || slots[i].serial < slots[pick].serial))
+                        pick = i;
+                if (pick >= 0) {
+                    writing = pick;
+                    for (auto* o : outputs)
+                        if (o->readDone[pick] != nullptr) {
+                            reads.push_back(o->readDone[pick]);
+                            o->readDone[pick] = nullptr;
+                        }
+                    break;
+                }
+            }
+            // Both spare slots are held by outputs that picked up older frames. A hold only
+            // spans issuing one blit, but the thread issuing it can be descheduled.
+            if (juce::Time::getMillisecondCounterHiRes() - startMs >= maxTargetWaitMs) {
+                if (skippedFrames++ % 100 == 0)
+                    MDW_LOG_WARN(juce::String("projectM GL: no free render host target; frames skipped: ")
+                                 + juce::String((juce::int64) skippedFrames));
+                return 0;
+            }
+            std::this_thread::yield();
+        }
+        for (auto f : reads) {
+            gl.waitSync(f);
+            gl.deleteSync(f);
+        }
+        auto& s = slots[writing];
+        if (s.fbo == 0 || w != s.w || h != s.h) {
+            gl.allocateTarget(s.fbo, s.tex, w, h);
+            const juce::ScopedLock sl(lock);
+            s.w = w;
+            s.h = h;
+            s.levels = 0;
+            if (w != loggedW || h != loggedH) {
+                MDW_LOG_INFO(juce::String("projectM GL: render host target ") + juce::String(w) + "x" + juce::String(h));
+                loggedW = w;
+                loggedH = h;
+            }
+        }
+        return s.fbo;
+    }
+
+    // Host current, after projectM drew into prepareTarget(): builds the preview levels the
+    // registered outputs asked for, fences the frame and makes it the one outputs present
+    void markFrameRendered()
+    {
+        if (writing < 0) return;
+        auto& s = slots[writing];
+        int levels = 0;
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* o : outputs)
+                levels = juce::jmax(levels, o->wantLevel);
+        }
+        levels = juce::jmin(levels, maxLevelFor(s.w, s.h));
+        if (levels > 0)
+            gl.buildLevels(s.tex, levels);
+        RenderHostGl::Sync done = gl.fenceSync();
+        gl.flush(); // other contexts may only wait on fences that reached the GPU
+        RenderHostGl::Sync old = nullptr;
+        {
+            const juce::ScopedLock sl(lock);
+            old = s.written;
+            s.written = done;
+            s.levels = levels;
+            s.serial = ++frameSerial;
+            published = writing;
+            writing = -1;
+        }
+        if (old != nullptr) gl.deleteSync(old); // no reader can hold it: the slot had none
+    }
+
+    // Host current: frees the targets before the projectM instance goes away
+    void releaseTarget()
+    {
+        const juce::ScopedLock sl(lock);
+        for (auto& s : slots) {
+            if (s.fbo != 0) gl.deleteTarget(s.fbo, s.tex);
+            if (s.written != nullptr) gl.deleteSync(s.written);
+            s = Slot{};
+        }
+        for (auto* o : outputs)
+            for (auto& f : o->readDone)
+                if (f != nullptr) { gl.deleteSync(f); f = nullptr; }
+        published = -1;
+        writing = -1;
+        ++epoch; // texture names may come back for new objects
+    }
+
+    // Any thread, before the output's context first presents / after it closed
+    void addOutput(Output& o)
+    {
+        const juce::ScopedLock sl(lock);
+        outputs.addIfNotAlreadyThere(&o);
+    }
+    void removeOutput(Output& o)
+    {
+        const juce::ScopedLock sl(lock);
+        outputs.removeFirstMatchingValue(&o);
+    }
+
+    // Output context current (the canvas after leave(), or a mirror's own context): stretches
+    // the latest frame over the drawable. Keeps showing the last frame while projectM isn't
+    // rendering (preset swap, reparenting). False if there is no frame yet.
+    bool present(Output& o, int drawableW, int drawableH)
+    {
+        int idx, level;
+        uint64_t texEpoch;
+        Slot s;
+        {
+            const juce::ScopedLock sl(lock);
+            idx = published;
+            if (idx < 0) return false;
+            s = slots[idx];
+            o.wantLevel = juce::jmin(maxPreviewLevel, levelFor(s.w, s.h, drawableW, drawableH));
+            o.drawW = drawableW;
+            o.drawH = drawableH;
+            level = juce::jmin(o.wantLevel, s.levels);
+            texEpoch = epoch;
+            ++slots[idx].readers;
+        }
+        gl.waitSync(s.written);
+        const bool attach = o.attachedTex != s.tex || o.attachedLevel != level || o.attachedEpoch != texEpoch;
+        o.attachedTex = s.tex;
+        o.attachedLevel = level;
+        o.attachedEpoch = texEpoch;
+        gl.blitToDrawable(o.readFbo, s.tex, level, attach,
+                          juce::jmax(1, s.w >> level), juce::jmax(1, s.h >> level), drawableW, drawableH);
+        RenderHostGl::Sync done = gl.fenceSync();
+        gl.flush(); // the producer waits on this from the host context
+        RenderHostGl::Sync old = nullptr;
+        {
+            const juce::ScopedLock sl(lock);
+            if (epoch != texEpoch) {
+                old = done; // the slots were released while this blit was being issued
+            } else {
+                --slots[idx].readers;
+                if (outputs.contains(&o)) {
+                    old = o.readDone[idx];
+                    o.readDone[idx] = done;
+                } else {
+                    old = done;
+                }
+            }
+        }
+        if (old != nullptr) gl.deleteSync(old);
+        return true;
+    }
+    bool present(int drawableW, int drawableH) { return present(primary, drawableW, drawableH); }
+
+    // Output context current, before it closes: framebuffer objects aren't shared. The
+    // output keeps its registration; its pending fences are dropped.
+    void releaseOutput(Output& o)
+    {
+        if (o.readFbo != 0) gl.deleteFramebuffer(o.readFbo);
+        o.readFbo = 0;
+        o.attachedTex = 0;
+        o.attachedLevel = -1;
+        o.attachedEpoch = 0;
+        const juce::ScopedLock sl(lock);
+        o.wantLevel = 0;
+        o.drawW = o.drawH = 0;
+        for (auto& f : o.readDone)
+            if (f != nullptr) { gl.deleteSync(f); f = nullptr; }
+    }
+    void releasePresenter() { releaseOutput(primary); }
+
+    // Any thread: drawable size of the largest output (by area) that presented since it was
+    // registered or released; projectM renders for that one and the others scale down
+    juce::Point<int> largestOutputSize() const
+    {
+        const juce::ScopedLock sl(lock);
+        juce::Point<int> best;
+        for (auto* o : outputs)
+            if ((int64_t) o->drawW * o->drawH > (int64_t) best.x * best.y)
+                best = { o->drawW, o->drawH };
+        return best;
+    }
+
+    // Deepest mip level whose size still covers an output of outW x outH
+    static int levelFor(int srcW, int srcH, int outW, int outH)
+    {
+        int level = 0;
+        while (level < maxPreviewLevel && (srcW >> (level + 1)) >= outW && (srcH >> (level + 1)) >= outH)
+            ++level;
+        return level;
+    }
+    static int maxLevelFor(int w, int h)
+    {
+        int level = 0;
+        while (level < maxPreviewLevel && (w >> (level + 1)) > 0 && (h >> (level + 1)) > 0)
+            ++level;
+        return level;
+    }
+
+private:
+    struct Slot {
+        unsigned int fbo = 0, tex = 0;         // host context
+        int w = 0, h = 0;
+        int levels = 0;                        // mip levels built for the frame in tex
+        RenderHostGl::Sync written = nullptr;  // projectM's frame in tex is complete
+        int readers = 0;                       // outputs blitting from tex right now
+        uint64_t serial = 0;                   // frame number, 0 = never written
+    };
+
+    RenderHostGl gl;
+    Context ctx;
+    mutable juce::CriticalSection lock;        // slot bookkeeping is shared with mirror GL threads
+    Slot slots[frameSlots];
+    int published = -1;                        // slot outputs present, -1 = none yet
+    int writing = -1;                          // slot between prepareTarget and markFrameRendered
+    uint64_t frameSerial = 0;
+    uint64_t epoch = 1;                        // bumped whenever the slot textures are deleted
+    int loggedW = 0, loggedH = 0;
+    uint64_t skippedFrames = 0;                // prepareTarget found no free slot (producer only)
+    juce::Array<Output*> outputs;
+    Output primary;                            // the canvas projectM renders on
+};
+
+} // namespace milkdawp
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "SimdDispatch.h"
+
+namespace milkdawp {
+
+// Internal render target size for a surface and resolution scale.
+// The CPU renderer draws at this size and BilinearUpscaler stretches the result to the
+// surface once per frame, so pixel work scales with scale^2.
+struct RenderSize {
+    int width = 2;
+    int height = 2;
+    uint64_t pixels() const noexcept { return (uint64_t)width * (uint64_t)height; }
+};
+
+inline RenderSize scaledRenderSize(int surfaceW, int surfaceH, double scale) noexcept
+{
+    if (! (scale > 0.25)) scale = 0.25; // also catches NaN
+    if (scale > 1.0) scale = 1.0;
+    RenderSize s;
+    s.width = (int)std::lround((double)surfaceW * scale);
+    s.height = (int)std::lround((double)surfaceH * scale);
+    if (s.width < 2) s.width = 2;
+    if (s.height < 2) s.height = 2;
+    return s;
+}
+
+// Scale actually applied to a GPU render target. Reallocating an FBO (and projectM's own
+// textures behind projectm_set_window_size) costs far more than one frame, while the requested
+// scale can move a little every frame once the process-wide budget cap applies. Snap to
+// `step` increments and keep the current scale until the request moves a full step away.
+inline double steppedRenderScale(double current, double requested, double step = 0.05) noexcept
+{
+    if (! (requested > 0.25)) requested = 0.25;
+    if (requested > 1.0) requested = 1.0;
+    if (current > 0.0 && std::abs(requested - current) < step)
+        return current;
+    const double snapped = std::round(requested / step) * step;
+    return snapped < 0.25 ? 0.25 : (snapped > 1.0 ? 1.0 : snapped);
+}
+
+// Bilinear stretch of opaque 0xAARRGGBB pixels, pixel-centre aligned.
+// Separable: each source row is expanded horizontally once into planar float R/G/B (scalar
+// gather), then every destination row is a dispatched SIMD blend of two expanded rows.
+// Scratch buffers persist between frames, so steady-state upscaling does not allocate.
+class BilinearUpscaler {
+public:
+    // Strides are in pixels. Equal sizes degrade to a row copy.
+    void upscale(const uint32_t* src, int sw, int sh, int srcStride,
+                 uint32_t* dst, int dw, int dh, int dstStride)
+    {
+        if (sw <= 0 || sh <= 0 || dw <= 0 || dh <= 0) return;
+        if (sw == dw && sh == dh)
+        {
+            for (int y = 0; y < dh; ++y)
+                std::memcpy(dst + (size_t)y * (size_t)dstStride, src + (size_t)y * (size_t)srcStride, sizeof(uint32_t) * (size_t)dw);
+            return;
+        }
+
+        prepareColumns(sw, dw);
+        rows[0].resize((size_t)dw * 3);
+        rows[1].resize((size_t)dw * 3);
+        rowIndex[0] = rowIndex[1] = -1;
+
+        const auto& k = simd::active();
+        const float sy = (float)sh / (float)dh;
+        for (int y = 0; y < dh; ++y)
+        {
+            float fy = ((float)y + 0.5f) * sy - 0.5f;
+            if (fy < 0.0f) fy = 0.0f;
+            int y0 = (int)fy;
+            if (y0 > sh - 1) y0 = sh - 1;
+            const int y1 = y0 + 1 < sh ? y0 + 1 : sh - 1;
+            const float wy = fy - (float)y0 < 1.0f ? fy - (float)y0 : 1.0f;
+
+            const float* a = expandedRow(src, srcStride, y0, y1, dw);
+            const float* b = expandedRow(src, srcStride, y1, y0, dw);
+            k.lerpRowsToArgb(a, b, wy, dst + (size_t)y * (size_t)dstStride, dw);
+        }
+    }
+
+private:
+    void prepareColumns(int sw, int dw)
+    {
+        if (colSrcW == sw && colDstW == dw) return;
+        colSrcW = sw; colDstW = dw;
+        x0.resize((size_t)dw);
+        x1.resize((size_t)dw);
+        wx.resize((size_t)dw);
+        const float sx = (float)sw / (float)dw;
+        for (int x = 0; x < dw; ++x)
+        {
+            float fx = ((float)x + 0.5f) * sx - 0.5f;
+            if (fx < 0.0f) fx = 0.0f;
+            int i0 = (int)fx;
+            if (i0 > sw - 1) i0 = sw - 1;
+            x0[(size_t)x] = i0;
+            x1[(size_t)x] = i0 + 1 < sw ? i0 + 1 : sw - 1;
+            wx[(size_t)x] = fx - (float)i0 < 1.0f ? fx - (float)i0 : 1.0f;
+        }
+    }
+
+    // Horizontally expanded source row sy as planar R/G/B. Two rows are cached since consecutive
+    // destination rows mostly share their source rows when upscaling; `keep` is never evicted.
+    const float* expandedRow(const uint32_t* src, int srcStride, int sy, int keep, int dw)
+    {
+        for (int s = 0; s < 2; ++s)
+            if (rowIndex[s] == sy) return rows[s].data();
+
+        // Rows are visited top to bottom, so the lower index is the stale one
+        int slot = rowIndex[0] <= rowIndex[1] ? 0 : 1;
+        if (rowIndex[slot] == keep) slot ^= 1;
+        rowIndex[slot] = sy;
+        float* r = rows[slot].data();
+        float* g = r + dw;
+        float* b = r + 2 * dw;
+        const uint32_t* line = src + (size_t)sy * (size_t)srcStride;
+        for (int x = 0; x < dw; ++x)
+        {
+            const uint32_t p0 = line[x0[(size_t)x]];
+            const uint32_t p1 = line[x1[(size_t)x]];
+            const float w1 = wx[(size_t)x], w0 = 1.0f - w1;
+            r[x] = (float)((p0 >> 16) & 0xFF) * w0 + (float)((p1 >> 16) & 0xFF) * w1;
+            g[x] = (float)((p0 >> 8) & 0xFF) * w0 + (float)((p1 >> 8) & 0xFF) * w1;
+            b[x] = (float)(p0 & 0xFF) * w0 + (float)(p1 & 0xFF) * w1;
+        }
+        return r;
+    }
+
+    std::vector<int> x0, x1;
+    std::vector<float> wx;
+    int colSrcW = -1, colDstW = -1;
+    std::vector<float> rows[2];
+    int rowIndex[2] = { -1, -1 };
+};
+
+} // namespace milkdawp
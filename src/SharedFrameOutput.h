@@ -0,0 +1,396 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include "FrameCapture.h"
+#include "Logging.h"
+
+#if ! defined(_WIN32)
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #if defined(__linux__)
+  #include <climits>
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+ #endif
+ #define MDW_HAS_SHARED_FRAME_OUTPUT 1
+#else
+ #define MDW_HAS_SHARED_FRAME_OUTPUT 0
+#endif
+
+namespace milkdawp {
+
+// Publishes captured frames into a POSIX shared-memory segment (shm_open name, e.g.
+// "/milkdawp") so a compositor or streaming tool on the same machine can read them without a
+// screen grab. The segment holds a SharedFrameHeader followed by slotCount pixel areas; frames
+// are written round-robin, so a reader has about two frame periods to use a slot in place
+// before it is overwritten.
+//
+// Each slot is a seqlock: its seq is odd while the writer fills it and even once the frame is
+// complete. A reader takes seq, reads the slot's fields and pixels in place, and keeps the
+// result only if seq is unchanged afterwards (SharedFrameReader does this). On Linux readers
+// can sleep on frameCounter with FUTEX_WAIT; elsewhere they poll it.
+//
+// A segment is replaced (state set to closed, name unlinked and recreated) when a frame outgrows
+// its slots; readers that see closed reopen the name. A segment left behind by a process that
+// died is taken over by the next writer.
+struct SharedFrameLayout {
+    static constexpr uint32_t magic = 0x4644574Du; // "MDWF"
+    static constexpr uint32_t version = 1;
+    static constexpr int slotCount = 3;
+    static constexpr uint32_t formatBgra8 = 1;     // 8-bit B, G, R, A; rows top to bottom
+    static constexpr uint32_t stateOpen = 1;
+    static constexpr uint32_t stateClosed = 2;     // writer stopped or moved to a new segment
+    static constexpr uint64_t minSlotBytes = 1920ull * 1080ull * 4ull;
+};
+
+struct SharedFrameSlot {
+    std::atomic<uint64_t> seq;      // odd while being written
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                // bytes per row
+    uint32_t format;                // SharedFrameLayout::format*
+    uint64_t frameIndex;            // the plugin's rendered frame number; gaps are frames not published
+    int64_t timestampNs;            // CLOCK_MONOTONIC time the frame was rendered
+};
+
+struct SharedFrameHeader {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> state;
+    uint32_t slotCount;
+    uint64_t headerBytes;           // offset of slot 0's pixels
+    uint64_t slotBytes;             // pixel capacity of each slot
+    int32_t writerPid;
+    std::atomic<uint32_t> frameCounter; // bumped per published frame; futex word on Linux
+    std::atomic<uint32_t> latestSlot;   // slot of the newest complete frame
+    SharedFrameSlot slots[SharedFrameLayout::slotCount];
+
+    static constexpr uint64_t alignedSize() { return (sizeof(SharedFrameHeader) + 4095u) & ~(uint64_t)4095u; }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory frame header needs address-free atomics");
+
+#if MDW_HAS_SHARED_FRAME_OUTPUT
+namespace SharedFrameClock {
+    inline int64_t nowNs() noexcept
+    {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+    }
+}
+
+namespace SharedFrameSignal {
+    inline void wakeAll(std::atomic<uint32_t>& word) noexcept
+    {
+       #if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+       #else
+        juce::ignoreUnused(word);
+       #endif
+    }
+
+    // Sleeps while word == expected, up to timeoutMs; may return early
+    inline void wait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) noexcept
+    {
+       #if defined(__linux__)
+        timespec ts{ timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000000l };
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+       #else
+        juce::ignoreUnused(word, expected);
+        juce::Thread::sleep(juce::jmin(timeoutMs, 1));
+       #endif
+    }
+}
+
+// Writer side; a FrameCaptureSink, so deliver() runs on the GL canvas's capture thread and the
+// one copy per frame goes straight from the mapped readback buffer into the segment (flipped to
+// top-down rows on the way).
+class SharedFrameWriter : public FrameCaptureSink {
+public:
+    ~SharedFrameWriter() override { close(); }
+
+    // name must start with '/'. If it is held by a live writer, "-2", "-3", ... are tried; the
+    // name actually used is returned by getName().
+    bool open(const juce::String& baseName)
+    {
+        close();
+        failed.store(false, std::memory_order_relaxed);
+        for (int n = 1; n <= maxNameSuffix; ++n)
+        {
+            const auto candidate = n == 1 ? baseName : baseName + "-" + juce::String(n);
+            if (create(candidate, SharedFrameLayout::minSlotBytes))
+            {
+                MDW_LOG_INFO(juce::String("Shared frame output: publishing to ") + candidate);
+                return true;
+            }
+        }
+        MDW_LOG_WARN(juce::String("Shared frame output: could not create ") + baseName);
+        return false;
+    }
+
+    void close()
+    {
+        if (header == nullptr) return;
+        // Unlinked first, so readers woken by the state change don't map this segment again
+        shm_unlink(name.toRawUTF8());
+        header->state.store(SharedFrameLayout::stateClosed, std::memory_order_release);
+        header->frameCounter.fetch_add(1, std::memory_order_release);
+        SharedFrameSignal::wakeAll(header->frameCounter);
+        munmap(mapping, mappingBytes);
+        MDW_LOG_INFO(juce::String("Shared frame output: closed ") + name + " after " + juce::String((juce::int64)published)
+                     + " frames");
+        mapping = nullptr;
+        header = nullptr;
+        mappingBytes = 0;
+    }
+
+    bool isOpen() const noexcept { return header != nullptr; }
+    // Any thread: a larger frame needed a bigger segment that couldn't be created, so the output
+    // stopped publishing; open() starts it again
+    bool hasFailed() const noexcept { return failed.load(std::memory_order_acquire); }
+    juce::String getName() const { return name; }
+    uint64_t getPublishedFrames() const noexcept { return published; }
+
+    void deliver(const CapturedFrameView& v) override
+    {
+        if (header == nullptr) return;
+        const uint64_t rowBytes = (uint64_t)v.width * 4u;
+        const uint64_t bytes = rowBytes * (uint64_t)v.height;
+        if (bytes > header->slotBytes && ! create(name, bytes))
+        {
+            // create() already closed the old segment, so this is the last frame that gets here
+            failed.store(true, std::memory_order_release);
+            MDW_LOG_ERROR(juce::String("Shared frame output: could not grow ") + name + " for "
+                          + juce::String(v.width) + "x" + juce::String(v.height) + " frames; output stopped");
+            return;
+        }
+
+        const uint32_t slot = (header->latestSlot.load(std::memory_order_relaxed) + 1u) % (uint32_t)SharedFrameLayout::slotCount;
+        auto& s = header->slots[slot];
+        const uint64_t seq = s.seq.load(std::memory_order_relaxed);
+        s.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint8_t* dst = mapping + header->headerBytes + (uint64_t)slot * header->slotBytes;
+        for (int y = 0; y < v.height; ++y)
+            std::memcpy(dst + (uint64_t)y * rowBytes, v.row(y), (size_t)rowBytes);
+        s.width = (uint32_t)v.width;
+        s.height = (uint32_t)v.height;
+        s.stride = (uint32_t)rowBytes;
+        s.format = SharedFrameLayout::formatBgra8;
+        s.frameIndex = v.frameIndex;
+        // The capture timestamp is on JUCE's clock; carry its age over to CLOCK_MONOTONIC
+        const double ageMs = juce::Time::getMillisecondCounterHiRes() - v.timestampMs;
+        s.timestampNs = SharedFrameClock::nowNs() - (int64_t)(ageMs * 1.0e6);
+
+        s.seq.store(seq + 2, std::memory_order_release);
+        header->latestSlot.store(slot, std::memory_order_release);
+        header->frameCounter.fetch_add(1, std::memory_order_release);
+        SharedFrameSignal::wakeAll(header->frameCounter);
+        ++published;
+    }
+
+private:
+    static constexpr int maxNameSuffix = 16;
+
+    // (Re)creates the segment under name with room for slotBytes per slot
+    bool create(const juce::String& newName, uint64_t slotBytes)
+    {
+        const bool growing = header != nullptr && name == newName;
+        close();
+        if (! growing)
+            name = newName; // only changes while no capture thread delivers
+        if (growing)
+            MDW_LOG_INFO(juce::String("Shared frame output: growing ") + name + " to " + juce::String((juce::int64)(slotBytes >> 20)) + " MB per slot");
+
+        int fd = shm_open(name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0 && errno == EEXIST && ! isHeldByLiveWriter(name))
+        {
+            shm_unlink(name.toRawUTF8());
+            fd = shm_open(name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        }
+        if (fd < 0) return false;
+
+        const uint64_t total = SharedFrameHeader::alignedSize() + slotBytes * (uint64_t)SharedFrameLayout::slotCount;
+        void* p = MAP_FAILED;
+        if (ftruncate(fd, (off_t)total) == 0)
+            p = mmap(nullptr, (size_t)total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            shm_unlink(name.toRawUTF8());
+            return false;
+        }
+
+        mapping = static_cast<uint8_t*>(p);
+        mappingBytes = (size_t)total;
+        header = new (mapping) SharedFrameHeader();
+        header->version = SharedFrameLayout::version;
+        header->slotCount = SharedFrameLayout::slotCount;
+        header->headerBytes = SharedFrameHeader::alignedSize();
+        header->slotBytes = slotBytes;
+        header->writerPid = (int32_t)getpid();
+        header->frameCounter.store(0, std::memory_order_relaxed);
+        header->latestSlot.store(SharedFrameLayout::slotCount - 1, std::memory_order_relaxed);
+        for (auto& s : header->slots)
+            s.seq.store(0, std::memory_order_relaxed);
+        header->state.store(SharedFrameLayout::stateOpen, std::memory_order_relaxed);
+        // Readers check magic last
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SharedFrameLayout::magic;
+        return true;
+    }
+
+    static bool isHeldByLiveWriter(const juce::String& segmentName)
+    {
+        const int fd = shm_open(segmentName.toRawUTF8(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        bool live = false;
+        // A segment shorter than a header (its writer died before ftruncate, or another tool made
+        // it) isn't held, and reading past its end would raise SIGBUS
+        struct stat st{};
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= SharedFrameHeader::alignedSize())
+            p = mmap(nullptr, sizeof(SharedFrameHeader), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p != MAP_FAILED)
+        {
+            const auto* h = static_cast<const SharedFrameHeader*>(p);
+            live = h->magic == SharedFrameLayout::magic
+                && h->state.load(std::memory_order_acquire) == SharedFrameLayout::stateOpen
+                && h->writerPid > 0 && (kill(h->writerPid, 0) == 0 || errno == EPERM);
+            munmap(p, sizeof(SharedFrameHeader));
+        }
+        return live;
+    }
+
+    juce::String name;
+    uint8_t* mapping = nullptr;
+    size_t mappingBytes = 0;
+    SharedFrameHeader* header = nullptr;
+    uint64_t published = 0;
+    std::atomic<bool> failed { false };
+};
+
+// Reader side, for tools and tests. Frames are used in place: take latest(), work on its pixels,
+// then confirm with stillValid() that the writer didn't overwrite the slot meanwhile.
+class SharedFrameReader {
+public:
+    struct FrameRef {
+        const uint8_t* pixels = nullptr;
+        uint32_t width = 0, height = 0, stride = 0, format = 0;
+        uint64_t frameIndex = 0;
+        int64_t timestampNs = 0;
+        uint32_t slot = 0;
+        uint64_t seq = 0;
+    };
+
+    ~SharedFrameReader() { close(); }
+
+    bool open(const juce::String& segmentName)
+    {
+        close();
+        const int fd = shm_open(segmentName.toRawUTF8(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st{};
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= SharedFrameHeader::alignedSize())
+            p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        mapping = static_cast<const uint8_t*>(p);
+        mappingBytes = (size_t)st.st_size;
+        header = reinterpret_cast<const SharedFrameHeader*>(mapping);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const bool valid = header->magic == SharedFrameLayout::magic && header->version == SharedFrameLayout::version
+            && header->state.load(std::memory_order_acquire) == SharedFrameLayout::stateOpen
+            && header->slotCount == (uint32_t)SharedFrameLayout::slotCount
+            && header->headerBytes + header->slotBytes * header->slotCount <= (uint64_t)mappingBytes;
+        if (! valid)
+        {
+            close();
+            return false;
+        }
+        name = segmentName;
+        return true;
+    }
+
+    void close()
+    {
+        if (mapping != nullptr)
+            munmap(const_cast<uint8_t*>(mapping), mappingBytes);
+        mapping = nullptr;
+        header = nullptr;
+        mappingBytes = 0;
+    }
+
+    bool isOpen() const noexcept { return header != nullptr; }
+    // The writer stopped or replaced the segment; open() the name again
+    bool isClosed() const noexcept { return header == nullptr || header->state.load(std::memory_order_acquire) != SharedFrameLayout::stateOpen; }
+    uint32_t getFrameCounter() const noexcept { return header != nullptr ? header->frameCounter.load(std::memory_order_acquire) : 0u; }
+
+    // Waits up to timeoutMs for frameCounter to move past lastSeen; true if it did
+    bool waitForFrame(uint32_t lastSeen, int timeoutMs)
+    {
+        if (header == nullptr) return false;
+        // FUTEX_WAIT only reads the word, so the read-only mapping is enough
+        auto& counter = const_cast<SharedFrameHeader*>(header)->frameCounter;
+        const double deadline = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+        for (;;)
+        {
+            if (counter.load(std::memory_order_acquire) != lastSeen) return true;
+            const double left = deadline - juce::Time::getMillisecondCounterHiRes();
+            if (left <= 0.0) return false;
+            SharedFrameSignal::wait(counter, lastSeen, juce::jmax(1, (int)left));
+        }
+    }
+
+    // Newest complete frame; false if none has been published or it is being overwritten
+    bool latest(FrameRef& f) const
+    {
+        if (header == nullptr || header->frameCounter.load(std::memory_order_acquire) == 0) return false;
+        const uint32_t slot = header->latestSlot.load(std::memory_order_acquire) % (uint32_t)SharedFrameLayout::slotCount;
+        const auto& s = header->slots[slot];
+        f.seq = s.seq.load(std::memory_order_acquire);
+        if ((f.seq & 1u) != 0 || f.seq == 0) return false;
+        f.slot = slot;
+        f.width = s.width;
+        f.height = s.height;
+        f.stride = s.stride;
+        f.format = s.format;
+        f.frameIndex = s.frameIndex;
+        f.timestampNs = s.timestampNs;
+        f.pixels = mapping + header->headerBytes + (uint64_t)slot * header->slotBytes;
+        if ((uint64_t)f.stride * f.height > header->slotBytes) return false;
+        return stillValid(f);
+    }
+
+    // True if the slot still holds the frame f was taken from, i.e. everything read from it
+    // since latest() is consistent
+    bool stillValid(const FrameRef& f) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header != nullptr && header->slots[f.slot].seq.load(std::memory_order_relaxed) == f.seq;
+    }
+
+private:
+    juce::String name;
+    const uint8_t* mapping = nullptr;
+    size_t mappingBytes = 0;
+    const SharedFrameHeader* header = nullptr;
+};
+#endif
+
+} // namespace milkdawp
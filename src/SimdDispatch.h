@@ -0,0 +1,469 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "Logging.h"
+
+// Runtime CPU feature dispatch for the hot loops (downmix, analysis window/energy, band
+// power, PCM float->int16, CPU renderer pixel fill and upscale, video colour conversion). The plugin ships one binary built with
+// baseline ISA flags; each kernel is additionally compiled for wider instruction sets via
+// target pragmas and the best supported set is picked once at startup via cpuid.
+//
+// Every variant is bit-identical to the scalar one (see SimdKernelsImpl.h), so switching
+// variants never changes analysis results or rendered pixels. This relies on FP contraction
+// being off (no FMA fusion), which CMake sets for GCC/Clang.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define MDW_SIMD_X86 1
+ #include <immintrin.h>
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#else
+ #define MDW_SIMD_X86 0
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+ #define MDW_SIMD_NEON 1
+ #include <arm_neon.h>
+#else
+ #define MDW_SIMD_NEON 0
+#endif
+
+// Force a specific variant for debugging (0 = auto, 1 = scalar)
+#ifndef MDW_SIMD_FORCE_SCALAR
+#define MDW_SIMD_FORCE_SCALAR 0
+#endif
+
+#if defined(__clang__)
+ #pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace milkdawp {
+namespace simd {
+
+enum class Level { Scalar = 0, SSE2, AVX2, AVX512, NEON };
+
+constexpr int lanes = 16;
+
+struct EnergyPeak {
+    float energy = 0.0f; // mean of squared (unwindowed) samples
+    float peak   = 0.0f; // max |sample|
+};
+
+struct Kernels {
+    Level level;
+    const char* name;
+    void (*downmixStereo)(const float* l, const float* r, float* out, int n) noexcept;
+    EnergyPeak (*windowedCopyEnergyPeak)(const float* src, const float* window, float* dst, int n) noexcept;
+    float (*sumSquares)(const float* x, int n) noexcept;
+    void (*floatToInt16)(const float* src, int16_t* dst, int n) noexcept;
+    void (*scrubPcm)(float* x, int n) noexcept;
+    void (*fillGradientRow)(uint32_t* dst, int n, const float* c0, const float* dc, float t0, float dt) noexcept;
+    void (*lerpRowsToArgb)(const float* a, const float* b, float fy, uint32_t* dst, int n) noexcept;
+    void (*argbToI420Rows)(const uint32_t* row0, const uint32_t* row1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int n) noexcept;
+};
+
+// Pairwise reduction of the lane accumulators in a fixed order
+inline float reduceSum(const float* acc) noexcept
+{
+    float t[lanes / 2];
+    for (int i = 0; i < lanes / 2; ++i) t[i] = acc[i] + acc[i + lanes / 2];
+    for (int w = lanes / 4; w >= 1; w /= 2)
+        for (int i = 0; i < w; ++i) t[i] = t[i] + t[i + w];
+    return t[0];
+}
+
+inline float reduceMax(const float* acc) noexcept
+{
+    float m = acc[0];
+    for (int i = 1; i < lanes; ++i) m = m > acc[i] ? m : acc[i];
+    return m;
+}
+
+// BT.709 limited-range ("TV levels") RGB -> Y'CbCr coefficients for 8-bit channels, as used by
+// argbToI420Rows. The offsets carry +0.5 so truncation rounds; chroma weights are pre-divided
+// by 4 because they apply to the sum of a 2x2 block.
+namespace yuv {
+constexpr float yr = 0.182586f, yg = 0.614231f, yb = 0.062007f, yOffset = 16.5f;
+constexpr float ur = -0.100644f * 0.25f, ug = -0.338572f * 0.25f, ub = 0.439216f * 0.25f;
+constexpr float vr = 0.439216f * 0.25f, vg = -0.398942f * 0.25f, vb = -0.040274f * 0.25f;
+constexpr float cOffset = 128.5f;
+} // namespace yuv
+
+//==============================================================================
+// Scalar reference (also the fallback on unknown architectures)
+namespace scalar {
+constexpr Level level = Level::Scalar;
+constexpr const char* name = "scalar";
+struct V {
+    using F = float;
+    using I = int32_t;
+    static constexpr int width = 1;
+    static F loadu(const float* p) noexcept { return *p; }
+    static void storeu(float* p, F v) noexcept { *p = v; }
+    static F set1(float v) noexcept { return v; }
+    static F zero() noexcept { return 0.0f; }
+    static F iota() noexcept { return 0.0f; }
+    static F add(F a, F b) noexcept { return a + b; }
+    static F mul(F a, F b) noexcept { return a * b; }
+    static F maxv(F a, F b) noexcept { return a > b ? a : b; }
+    static F minv(F a, F b) noexcept { return a < b ? a : b; }
+    static F absv(F a) noexcept { return std::fabs(a); }
+    static F keepNormal(F a) noexcept { const float m = std::fabs(a); return m >= FLT_MIN && m <= FLT_MAX ? a : 0.0f; }
+    static I cvtt(F a) noexcept { return (int32_t)a; }
+    static I cvtn(F a) noexcept { return (int32_t)std::lrintf(a); }
+    static I packOpaque(I r, I g, I b) noexcept { return (int32_t)(0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b); }
+    static void storeU32(uint32_t* p, I v) noexcept { *p = (uint32_t)v; }
+    static void storeI16(int16_t* p, I v) noexcept { *p = (int16_t)v; }
+    static I loadU32(const uint32_t* p) noexcept { return (int32_t)*p; }
+    template <int shift> static I channel(I px) noexcept { return (int32_t)(((uint32_t)px >> shift) & 0xffu); }
+    static void loadEvenOdd(const uint32_t* p, I& even, I& odd) noexcept { even = (int32_t)p[0]; odd = (int32_t)p[1]; }
+    static I addi(I a, I b) noexcept { return a + b; }
+    static F cvtf(I a) noexcept { return (float)a; }
+    static void storeU8(uint8_t* p, I v) noexcept { *p = (uint8_t)v; }
+};
+#include "SimdKernelsImpl.h"
+} // namespace scalar
+
+//==============================================================================
+#if MDW_SIMD_X86
+namespace sse2 {
+constexpr Level level = Level::SSE2;
+constexpr const char* name = "SSE2";
+struct V {
+    using F = __m128;
+    using I = __m128i;
+    static constexpr int width = 4;
+    static F loadu(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static void storeu(float* p, F v) noexcept { _mm_storeu_ps(p, v); }
+    static F set1(float v) noexcept { return _mm_set1_ps(v); }
+    static F zero() noexcept { return _mm_setzero_ps(); }
+    static F iota() noexcept { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+    static F add(F a, F b) noexcept { return _mm_add_ps(a, b); }
+    static F mul(F a, F b) noexcept { return _mm_mul_ps(a, b); }
+    static F maxv(F a, F b) noexcept { return _mm_max_ps(a, b); }
+    static F minv(F a, F b) noexcept { return _mm_min_ps(a, b); }
+    static F absv(F a) noexcept { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+    static F keepNormal(F a) noexcept
+    {
+        const F m = absv(a);
+        return _mm_and_ps(a, _mm_and_ps(_mm_cmpge_ps(m, _mm_set1_ps(FLT_MIN)), _mm_cmple_ps(m, _mm_set1_ps(FLT_MAX))));
+    }
+    static I cvtt(F a) noexcept { return _mm_cvttps_epi32(a); }
+    static I cvtn(F a) noexcept { return _mm_cvtps_epi32(a); }
+    static I packOpaque(I r, I g, I b) noexcept
+    {
+        return _mm_or_si128(_mm_or_si128(_mm_set1_epi32((int)0xFF000000u), _mm_slli_epi32(r, 16)),
+                            _mm_or_si128(_mm_slli_epi32(g, 8), b));
+    }
+    static void storeU32(uint32_t* p, I v) noexcept { _mm_storeu_si128((__m128i*)p, v); }
+    static void storeI16(int16_t* p, I v) noexcept { _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(v, v)); }
+    static I loadU32(const uint32_t* p) noexcept { return _mm_loadu_si128((const __m128i*)p); }
+    template <int shift> static I channel(I px) noexcept { return _mm_and_si128(_mm_srli_epi32(px, shift), _mm_set1_epi32(0xff)); }
+    static void loadEvenOdd(const uint32_t* p, I& even, I& odd) noexcept
+    {
+        const __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)p));
+        const __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(p + 4)));
+        even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    static I addi(I a, I b) noexcept { return _mm_add_epi32(a, b); }
+    static F cvtf(I a) noexcept { return _mm_cvtepi32_ps(a); }
+    static void storeU8(uint8_t* p, I v) noexcept
+    {
+        const __m128i w = _mm_packs_epi32(v, v);
+        const int32_t b = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+        std::memcpy(p, &b, 4);
+    }
+};
+#include "SimdKernelsImpl.h"
+} // namespace sse2
+
+#if defined(__GNUC__) && ! defined(__clang__)
+ #pragma GCC push_options
+ #pragma GCC target("avx2")
+#elif defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#endif
+namespace avx2 {
+constexpr Level level = Level::AVX2;
+constexpr const char* name = "AVX2";
+struct V {
+    using F = __m256;
+    using I = __m256i;
+    static constexpr int width = 8;
+    static F loadu(const float* p) noexcept { return _mm256_loadu_ps(p); }
+    static void storeu(float* p, F v) noexcept { _mm256_storeu_ps(p, v); }
+    static F set1(float v) noexcept { return _mm256_set1_ps(v); }
+    static F zero() noexcept { return _mm256_setzero_ps(); }
+    static F iota() noexcept { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+    static F add(F a, F b) noexcept { return _mm256_add_ps(a, b); }
+    static F mul(F a, F b) noexcept { return _mm256_mul_ps(a, b); }
+    static F maxv(F a, F b) noexcept { return _mm256_max_ps(a, b); }
+    static F minv(F a, F b) noexcept { return _mm256_min_ps(a, b); }
+    static F absv(F a) noexcept { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+    static F keepNormal(F a) noexcept
+    {
+        const F m = absv(a);
+        return _mm256_and_ps(a, _mm256_and_ps(_mm256_cmp_ps(m, _mm256_set1_ps(FLT_MIN), _CMP_GE_OQ),
+                                              _mm256_cmp_ps(m, _mm256_set1_ps(FLT_MAX), _CMP_LE_OQ)));
+    }
+    static I cvtt(F a) noexcept { return _mm256_cvttps_epi32(a); }
+    static I cvtn(F a) noexcept { return _mm256_cvtps_epi32(a); }
+    static I packOpaque(I r, I g, I b) noexcept
+    {
+        return _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32((int)0xFF000000u), _mm256_slli_epi32(r, 16)),
+                               _mm256_or_si256(_mm256_slli_epi32(g, 8), b));
+    }
+    static void storeU32(uint32_t* p, I v) noexcept { _mm256_storeu_si256((__m256i*)p, v); }
+    static void storeI16(int16_t* p, I v) noexcept
+    {
+        _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+    }
+    static I loadU32(const uint32_t* p) noexcept { return _mm256_loadu_si256((const __m256i*)p); }
+    template <int shift> static I channel(I px) noexcept { return _mm256_and_si256(_mm256_srli_epi32(px, shift), _mm256_set1_epi32(0xff)); }
+    static void loadEvenOdd(const uint32_t* p, I& even, I& odd) noexcept
+    {
+        // In-lane shuffles leave the 64-bit quarters as a0a2 b0b2 a4a6 b4b6; swap the middle two
+        const __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)p));
+        const __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(p + 8)));
+        even = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8);
+        odd = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8);
+    }
+    static I addi(I a, I b) noexcept { return _mm256_add_epi32(a, b); }
+    static F cvtf(I a) noexcept { return _mm256_cvtepi32_ps(a); }
+    static void storeU8(uint8_t* p, I v) noexcept
+    {
+        const __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(w, w));
+    }
+};
+#include "SimdKernelsImpl.h"
+} // namespace avx2
+#if defined(__GNUC__) && ! defined(__clang__)
+ #pragma GCC pop_options
+#elif defined(__clang__)
+ #pragma clang attribute pop
+#endif
+
+#if defined(__GNUC__) && ! defined(__clang__)
+ #pragma GCC push_options
+ #pragma GCC target("avx512f")
+#elif defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#endif
+namespace avx512 {
+constexpr Level level = Level::AVX512;
+constexpr const char* name = "AVX-512";
+struct V {
+    using F = __m512;
+    using I = __m512i;
+    static constexpr int width = 16;
+    static F loadu(const float* p) noexcept { return _mm512_loadu_ps(p); }
+    static void storeu(float* p, F v) noexcept { _mm512_storeu_ps(p, v); }
+    static F set1(float v) noexcept { return _mm512_set1_ps(v); }
+    static F zero() noexcept { return _mm512_setzero_ps(); }
+    static F iota() noexcept
+    {
+        return _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                              8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+    }
+    static F add(F a, F b) noexcept { return _mm512_add_ps(a, b); }
+    static F mul(F a, F b) noexcept { return _mm512_mul_ps(a, b); }
+    static F maxv(F a, F b) noexcept { return _mm512_max_ps(a, b); }
+    static F minv(F a, F b) noexcept { return _mm512_min_ps(a, b); }
+    static F absv(F a) noexcept { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_set1_epi32(0x7fffffff))); }
+    static F keepNormal(F a) noexcept
+    {
+        const F m = absv(a);
+        return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(m, _mm512_set1_ps(FLT_MIN), _CMP_GE_OQ)
+                                   & _mm512_cmp_ps_mask(m, _mm512_set1_ps(FLT_MAX), _CMP_LE_OQ), a);
+    }
+    static I cvtt(F a) noexcept { return _mm512_cvttps_epi32(a); }
+    static I cvtn(F a) noexcept { return _mm512_cvtps_epi32(a); }
+    static I packOpaque(I r, I g, I b) noexcept
+    {
+        return _mm512_or_si512(_mm512_or_si512(_mm512_set1_epi32((int)0xFF000000u), _mm512_slli_epi32(r, 16)),
+                               _mm512_or_si512(_mm512_slli_epi32(g, 8), b));
+    }
+    static void storeU32(uint32_t* p, I v) noexcept { _mm512_storeu_si512((void*)p, v); }
+    static void storeI16(int16_t* p, I v) noexcept { _mm256_storeu_si256((__m256i*)p, _mm512_cvtsepi32_epi16(v)); }
+    static I loadU32(const uint32_t* p) noexcept { return _mm512_loadu_si512((const void*)p); }
+    template <int shift> static I channel(I px) noexcept { return _mm512_and_si512(_mm512_srli_epi32(px, shift), _mm512_set1_epi32(0xff)); }
+    static void loadEvenOdd(const uint32_t* p, I& even, I& odd) noexcept
+    {
+        const I a = _mm512_loadu_si512((const void*)p);
+        const I b = _mm512_loadu_si512((const void*)(p + 16));
+        even = _mm512_permutex2var_epi32(a, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), b);
+        odd = _mm512_permutex2var_epi32(a, _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), b);
+    }
+    static I addi(I a, I b) noexcept { return _mm512_add_epi32(a, b); }
+    static F cvtf(I a) noexcept { return _mm512_cvtepi32_ps(a); }
+    static void storeU8(uint8_t* p, I v) noexcept { _mm_storeu_si128((__m128i*)p, _mm512_cvtusepi32_epi8(v)); }
+};
+#include "SimdKernelsImpl.h"
+} // namespace avx512
+#if defined(__GNUC__) && ! defined(__clang__)
+ #pragma GCC pop_options
+#elif defined(__clang__)
+ #pragma clang attribute pop
+#endif
+#endif // MDW_SIMD_X86
+
+//==============================================================================
+#if MDW_SIMD_NEON
+namespace neon {
+constexpr Level level = Level::NEON;
+constexpr const char* name = "NEON";
+struct V {
+    using F = float32x4_t;
+    using I = int32x4_t;
+    static constexpr int width = 4;
+    static F loadu(const float* p) noexcept { return vld1q_f32(p); }
+    static void storeu(float* p, F v) noexcept { vst1q_f32(p, v); }
+    static F set1(float v) noexcept { return vdupq_n_f32(v); }
+    static F zero() noexcept { return vdupq_n_f32(0.0f); }
+    static F iota() noexcept { const float k[4] = { 0.0f, 1.0f, 2.0f, 3.0f }; return vld1q_f32(k); }
+    static F add(F a, F b) noexcept { return vaddq_f32(a, b); }
+    static F mul(F a, F b) noexcept { return vmulq_f32(a, b); }
+    // vmaxq/vminq propagate NaN; select explicitly to match the scalar/SSE operand rule
+    static F maxv(F a, F b) noexcept { return vbslq_f32(vcgtq_f32(a, b), a, b); }
+    static F minv(F a, F b) noexcept { return vbslq_f32(vcltq_f32(a, b), a, b); }
+    static F absv(F a) noexcept { return vabsq_f32(a); }
+    static F keepNormal(F a) noexcept
+    {
+        const F m = vabsq_f32(a);
+        const uint32x4_t ok = vandq_u32(vcgeq_f32(m, vdupq_n_f32(FLT_MIN)), vcleq_f32(m, vdupq_n_f32(FLT_MAX)));
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), ok));
+    }
+    static I cvtt(F a) noexcept { return vcvtq_s32_f32(a); }
+    static I cvtn(F a) noexcept { return vcvtnq_s32_f32(a); }
+    static I packOpaque(I r, I g, I b) noexcept
+    {
+        return vorrq_s32(vorrq_s32(vdupq_n_s32((int32_t)0xFF000000u), vshlq_n_s32(r, 16)),
+                         vorrq_s32(vshlq_n_s32(g, 8), b));
+    }
+    static void storeU32(uint32_t* p, I v) noexcept { vst1q_u32(p, vreinterpretq_u32_s32(v)); }
+    static void storeI16(int16_t* p, I v) noexcept { vst1_s16(p, vmovn_s32(v)); }
+    static I loadU32(const uint32_t* p) noexcept { return vreinterpretq_s32_u32(vld1q_u32(p)); }
+    template <int shift> static I channel(I px) noexcept
+    {
+        uint32x4_t u = vreinterpretq_u32_s32(px);
+        if constexpr (shift > 0) u = vshrq_n_u32(u, shift); // immediate must be 1..32
+        return vreinterpretq_s32_u32(vandq_u32(u, vdupq_n_u32(0xff)));
+    }
+    static void loadEvenOdd(const uint32_t* p, I& even, I& odd) noexcept
+    {
+        const uint32x4x2_t d = vld2q_u32(p);
+        even = vreinterpretq_s32_u32(d.val[0]);
+        odd = vreinterpretq_s32_u32(d.val[1]);
+    }
+    static I addi(I a, I b) noexcept { return vaddq_s32(a, b); }
+    static F cvtf(I a) noexcept { return vcvtq_f32_s32(a); }
+    static void storeU8(uint8_t* p, I v) noexcept
+    {
+        const int16x4_t w = vmovn_s32(v);
+        const uint32_t b = vget_lane_u32(vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(w, w))), 0);
+        std::memcpy(p, &b, 4);
+    }
+};
+#include "SimdKernelsImpl.h"
+} // namespace neon
+#endif // MDW_SIMD_NEON
+
+//==============================================================================
+inline bool isSupported(Level level) noexcept
+{
+    switch (level)
+    {
+        case Level::Scalar: return true;
+       #if MDW_SIMD_X86
+        case Level::SSE2:
+        case Level::AVX2:
+        case Level::AVX512:
+        {
+            unsigned int r1[4] = {}, r7[4] = {};
+           #if defined(_MSC_VER)
+            int a[4];
+            __cpuid(a, 0);
+            const int maxLeaf = a[0];
+            __cpuidex(a, 1, 0); for (int i = 0; i < 4; ++i) r1[i] = (unsigned int)a[i];
+            if (maxLeaf >= 7) { __cpuidex(a, 7, 0); for (int i = 0; i < 4; ++i) r7[i] = (unsigned int)a[i]; }
+           #else
+            const unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+            __cpuid_count(1, 0, r1[0], r1[1], r1[2], r1[3]);
+            if (maxLeaf >= 7) __cpuid_count(7, 0, r7[0], r7[1], r7[2], r7[3]);
+           #endif
+            const bool sse2 = (r1[3] & (1u << 26)) != 0;
+            if (level == Level::SSE2) return sse2;
+
+            // Wide registers also need the OS to save their state (OSXSAVE + XCR0)
+            const bool osxsave = (r1[2] & (1u << 27)) != 0;
+            const bool avx = (r1[2] & (1u << 28)) != 0;
+            if (! (osxsave && avx)) return false;
+           #if defined(_MSC_VER)
+            const unsigned long long xcr0 = _xgetbv(0);
+           #else
+            unsigned int xlo = 0, xhi = 0;
+            __asm__ volatile ("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+            const unsigned long long xcr0 = ((unsigned long long)xhi << 32) | xlo;
+           #endif
+            const bool ymmState = (xcr0 & 0x6) == 0x6;
+            const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+            if (level == Level::AVX2) return ymmState && (r7[1] & (1u << 5)) != 0;
+            return zmmState && (r7[1] & (1u << 16)) != 0;
+        }
+       #endif
+       #if MDW_SIMD_NEON
+        case Level::NEON: return true;
+       #endif
+        default: return false;
+    }
+}
+
+// Kernel table for a specific variant, or nullptr if it is not compiled in or not supported here.
+inline const Kernels* getKernels(Level level) noexcept
+{
+    if (! isSupported(level)) return nullptr;
+    switch (level)
+    {
+        case Level::Scalar: return &scalar::kernels();
+       #if MDW_SIMD_X86
+        case Level::SSE2:   return &sse2::kernels();
+        case Level::AVX2:   return &avx2::kernels();
+        case Level::AVX512: return &avx512::kernels();
+       #endif
+       #if MDW_SIMD_NEON
+        case Level::NEON:   return &neon::kernels();
+       #endif
+        default: return nullptr;
+    }
+}
+
+// Best supported variant, selected once per process.
+inline const Kernels& active() noexcept
+{
+    static const Kernels& k = [] () -> const Kernels& {
+       #if ! MDW_SIMD_FORCE_SCALAR
+        for (auto level : { Level::AVX512, Level::AVX2, Level::SSE2, Level::NEON })
+            if (auto* kt = getKernels(level))
+            {
+                MDW_LOG_INFO(juce::String("SIMD dispatch: ") + kt->name);
+                return *kt;
+            }
+       #endif
+        MDW_LOG_INFO("SIMD dispatch: scalar");
+        return scalar::kernels();
+    }();
+    return k;
+}
+
+} // namespace simd
+} // namespace milkdawp
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+//
+// Kernel bodies shared by every SIMD variant. Deliberately has no include guard:
+// SimdDispatch.h includes it once per ISA, inside a namespace that defines the vector
+// traits struct V and under the matching target pragma, so the compiler emits one copy
+// of each kernel per instruction set.
+//
+// All reductions use `lanes` (16) fixed accumulators; a vector of width W covers W of them.
+// Scalar tails and final reductions are plain float code shared by every variant, so the
+// result does not depend on the vector width.
+
+inline void downmixStereo(const float* l, const float* r, float* out, int n) noexcept
+{
+    const V::F h = V::set1(0.5f);
+    int i = 0;
+    for (; i + V::width <= n; i += V::width)
+        V::storeu(out + i, V::mul(V::add(V::loadu(l + i), V::loadu(r + i)), h));
+    for (; i < n; ++i)
+        out[i] = (l[i] + r[i]) * 0.5f;
+}
+
+inline EnergyPeak windowedCopyEnergyPeak(const float* src, const float* window, float* dst, int n) noexcept
+{
+    constexpr int numAcc = lanes / V::width;
+    V::F acc[numAcc];
+    V::F pk[numAcc];
+    for (int a = 0; a < numAcc; ++a) { acc[a] = V::zero(); pk[a] = V::zero(); }
+
+    int i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int a = 0; a < numAcc; ++a)
+        {
+            const int o = i + a * V::width;
+            const V::F s = V::loadu(src + o);
+            V::storeu(dst + o, V::mul(s, V::loadu(window + o)));
+            acc[a] = V::add(acc[a], V::mul(s, s));
+            pk[a] = V::maxv(pk[a], V::absv(s));
+        }
+    }
+
+    float accL[lanes], pkL[lanes];
+    for (int a = 0; a < numAcc; ++a) { V::storeu(accL + a * V::width, acc[a]); V::storeu(pkL + a * V::width, pk[a]); }
+    for (; i < n; ++i)
+    {
+        const int l = i & (lanes - 1);
+        const float s = src[i];
+        dst[i] = s * window[i];
+        accL[l] = accL[l] + s * s;
+        const float m = std::fabs(s);
+        pkL[l] = pkL[l] > m ? pkL[l] : m;
+    }
+
+    EnergyPeak r;
+    r.energy = n > 0 ? reduceSum(accL) / (float)n : 0.0f;
+    r.peak = reduceMax(pkL);
+    return r;
+}
+
+inline float sumSquares(const float* x, int n) noexcept
+{
+    constexpr int numAcc = lanes / V::width;
+    V::F acc[numAcc];
+    for (int a = 0; a < numAcc; ++a) acc[a] = V::zero();
+
+    int i = 0;
+    for (; i + lanes <= n; i += lanes)
+        for (int a = 0; a < numAcc; ++a)
+        {
+            const V::F s = V::loadu(x + i + a * V::width);
+            acc[a] = V::add(acc[a], V::mul(s, s));
+        }
+
+    float accL[lanes];
+    for (int a = 0; a < numAcc; ++a) V::storeu(accL + a * V::width, acc[a]);
+    for (; i < n; ++i)
+        accL[i & (lanes - 1)] = accL[i & (lanes - 1)] + x[i] * x[i];
+    return reduceSum(accL);
+}
+
+// Full-scale float to int16: scale by 32767, clamp to +/-32767, round to nearest even.
+// NaN, infinities and denormals are scrubbed to 0 first (see scrubPcm).
+inline void floatToInt16(const float* src, int16_t* dst, int n) noexcept
+{
+    const V::F scale = V::set1(32767.0f);
+    const V::F lo = V::set1(-32767.0f);
+    const V::F hi = V::set1(32767.0f);
+    int i = 0;
+    for (; i + V::width <= n; i += V::width)
+    {
+        V::F v = V::mul(V::keepNormal(V::loadu(src + i)), scale);
+        v = V::maxv(v, lo);
+        v = V::minv(v, hi);
+        V::storeI16(dst + i, V::cvtn(v));
+    }
+    for (; i < n; ++i)
+    {
+        float v = scalar::V::keepNormal(src[i]) * 32767.0f;
+        v = v > -32767.0f ? v : -32767.0f;
+        v = v < 32767.0f ? v : 32767.0f;
+        dst[i] = (int16_t)std::lrintf(v);
+    }
+}
+
+// In place: anything that is not a finite normal float (NaN, +/-inf, denormal) becomes 0,
+// so one misbehaving plugin upstream cannot poison projectM's waveform and FFT state.
+inline void scrubPcm(float* x, int n) noexcept
+{
+    int i = 0;
+    for (; i + V::width <= n; i += V::width)
+        V::storeu(x + i, V::keepNormal(V::loadu(x + i)));
+    for (; i < n; ++i)
+        x[i] = scalar::V::keepNormal(x[i]);
+}
+
+// One row of opaque 0xAARRGGBB pixels along a linear gradient: colour = c0 + t * dc,
+// with t = clamp(t0 + x * dt, 0, 1) and channels in [0, 1].
+inline void fillGradientRow(uint32_t* dst, int n, const float* c0, const float* dc, float t0, float dt) noexcept
+{
+    const V::F r0 = V::set1(c0[0]), g0 = V::set1(c0[1]), b0 = V::set1(c0[2]);
+    const V::F dr = V::set1(dc[0]), dg = V::set1(dc[1]), db = V::set1(dc[2]);
+    const V::F vt0 = V::set1(t0), vdt = V::set1(dt);
+    const V::F zero = V::zero(), one = V::set1(1.0f), s255 = V::set1(255.0f), half = V::set1(0.5f);
+    const V::F iota = V::iota();
+    int i = 0;
+    for (; i + V::width <= n; i += V::width)
+    {
+        const V::F x = V::add(V::set1((float)i), iota);
+        V::F t = V::add(vt0, V::mul(x, vdt));
+        t = V::maxv(t, zero);
+        t = V::minv(t, one);
+        const V::I r = V::cvtt(V::add(V::mul(V::add(r0, V::mul(t, dr)), s255), half));
+        const V::I g = V::cvtt(V::add(V::mul(V::add(g0, V::mul(t, dg)), s255), half));
+        const V::I b = V::cvtt(V::add(V::mul(V::add(b0, V::mul(t, db)), s255), half));
+        V::storeU32(dst + i, V::packOpaque(r, g, b));
+    }
+    for (; i < n; ++i)
+    {
+        float t = t0 + (float)i * dt;
+        t = t > 0.0f ? t : 0.0f;
+        t = t < 1.0f ? t : 1.0f;
+        const uint32_t r = (uint32_t)(int)((c0[0] + t * dc[0]) * 255.0f + 0.5f);
+        const uint32_t g = (uint32_t)(int)((c0[1] + t * dc[1]) * 255.0f + 0.5f);
+        const uint32_t b = (uint32_t)(int)((c0[2] + t * dc[2]) * 255.0f + 0.5f);
+        dst[i] = 0xFF000000u | (r << 16) | (g << 8) | b;
+    }
+}
+
+// Vertical half of a separable bilinear upscale: blends two planar float rows (R, G, B planes of
+// n values each, channels in [0, 255]) as a * (1 - fy) + b * fy and packs opaque 0xAARRGGBB.
+inline void lerpRowsToArgb(const float* a, const float* b, float fy, uint32_t* dst, int n) noexcept
+{
+    const float wa = 1.0f - fy;
+    const V::F vwa = V::set1(wa), vwb = V::set1(fy), half = V::set1(0.5f);
+    const float* ar = a; const float* ag = a + n; const float* ab = a + 2 * n;
+    const float* br = b; const float* bg = b + n; const float* bb = b + 2 * n;
+    int i = 0;
+    for (; i + V::width <= n; i += V::width)
+    {
+        const V::I r = V::cvtt(V::add(V::add(V::mul(V::loadu(ar + i), vwa), V::mul(V::loadu(br + i), vwb)), half));
+        const V::I g = V::cvtt(V::add(V::add(V::mul(V::loadu(ag + i), vwa), V::mul(V::loadu(bg + i), vwb)), half));
+        const V::I bl = V::cvtt(V::add(V::add(V::mul(V::loadu(ab + i), vwa), V::mul(V::loadu(bb + i), vwb)), half));
+        V::storeU32(dst + i, V::packOpaque(r, g, bl));
+    }
+    for (; i < n; ++i)
+    {
+        const uint32_t r = (uint32_t)(int)(ar[i] * wa + br[i] * fy + 0.5f);
+        const uint32_t g = (uint32_t)(int)(ag[i] * wa + bg[i] * fy + 0.5f);
+        const uint32_t bl = (uint32_t)(int)(ab[i] * wa + bb[i] * fy + 0.5f);
+        dst[i] = 0xFF000000u | (r << 16) | (g << 8) | bl;
+    }
+}
+
+// Two rows of 0xAARRGGBB pixels (alpha ignored) to I420: full-resolution luma for each row, plus
+// one Cb and one Cr sample per 2x2 block, centred (see simd::yuv). n is the row width and must be
+// even; the caller crops odd frame sizes.
+inline void argbToI420Rows(const uint32_t* row0, const uint32_t* row1, uint8_t* y0, uint8_t* y1,
+                           uint8_t* u, uint8_t* v, int n) noexcept
+{
+    const V::F yr = V::set1(yuv::yr), yg = V::set1(yuv::yg), yb = V::set1(yuv::yb), yo = V::set1(yuv::yOffset);
+    for (int row = 0; row < 2; ++row)
+    {
+        const uint32_t* src = row == 0 ? row0 : row1;
+        uint8_t* dst = row == 0 ? y0 : y1;
+        int i = 0;
+        for (; i + V::width <= n; i += V::width)
+        {
+            const V::I px = V::loadU32(src + i);
+            const V::F r = V::cvtf(V::channel<16>(px)), g = V::cvtf(V::channel<8>(px)), b = V::cvtf(V::channel<0>(px));
+            V::storeU8(dst + i, V::cvtt(V::add(V::add(V::add(V::mul(r, yr), V::mul(g, yg)), V::mul(b, yb)), yo)));
+        }
+        for (; i < n; ++i)
+        {
+            const float r = (float)((src[i] >> 16) & 0xffu), g = (float)((src[i] >> 8) & 0xffu), b = (float)(src[i] & 0xffu);
+            dst[i] = (uint8_t)(int)(r * yuv::yr + g * yuv::yg + b * yuv::yb + yuv::yOffset);
+        }
+    }
+
+    const V::F ur = V::set1(yuv::ur), ug = V::set1(yuv::ug), ub = V::set1(yuv::ub);
+    const V::F vr = V::set1(yuv::vr), vg = V::set1(yuv::vg), vb = V::set1(yuv::vb), co = V::set1(yuv::cOffset);
+    const int half = n / 2;
+    int j = 0;
+    for (; j + V::width <= half; j += V::width)
+    {
+        V::I e0, o0, e1, o1;
+        V::loadEvenOdd(row0 + 2 * j, e0, o0);
+        V::loadEvenOdd(row1 + 2 * j, e1, o1);
+        const V::F r = V::cvtf(V::addi(V::addi(V::channel<16>(e0), V::channel<16>(o0)), V::addi(V::channel<16>(e1), V::channel<16>(o1))));
+        const V::F g = V::cvtf(V::addi(V::addi(V::channel<8>(e0), V::channel<8>(o0)), V::addi(V::channel<8>(e1), V::channel<8>(o1))));
+        const V::F b = V::cvtf(V::addi(V::addi(V::channel<0>(e0), V::channel<0>(o0)), V::addi(V::channel<0>(e1), V::channel<0>(o1))));
+        V::storeU8(u + j, V::cvtt(V::add(V::add(V::add(V::mul(r, ur), V::mul(g, ug)), V::mul(b, ub)), co)));
+        V::storeU8(v + j, V::cvtt(V::add(V::add(V::add(V::mul(r, vr), V::mul(g, vg)), V::mul(b, vb)), co)));
+    }
+    for (; j < half; ++j)
+    {
+        const uint32_t p[4] = { row0[2 * j], row0[2 * j + 1], row1[2 * j], row1[2 * j + 1] };
+        uint32_t sr = 0, sg = 0, sb = 0;
+        for (uint32_t q : p) { sr += (q >> 16) & 0xffu; sg += (q >> 8) & 0xffu; sb += q & 0xffu; }
+        const float r = (float)sr, g = (float)sg, b = (float)sb;
+        u[j] = (uint8_t)(int)(r * yuv::ur + g * yuv::ug + b * yuv::ub + yuv::cOffset);
+        v[j] = (uint8_t)(int)(r * yuv::vr + g * yuv::vg + b * yuv::vb + yuv::cOffset);
+    }
+}
+
+inline const Kernels& kernels() noexcept
+{
+    static const Kernels k { level, name, &downmixStereo, &windowedCopyEnergyPeak, &sumSquares, &floatToInt16, &scrubPcm, &fillGradientRow, &lerpRowsToArgb, &argbToI420Rows };
+    return k;
+}
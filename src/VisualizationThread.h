@@ -9,10 +9,16 @@
 #include <juce_graphics/juce_graphics.h>
 #include <vector>
 #include "AudioAnalysisQueue.h"
+#include "FrameCapture.h"
 #include "MessageThreadBridge.h"
 #include "Logging.h"
 #include "SharedAssetCache.h"
 #include "AdaptiveQuality.h"
+#include "QualityBudgetCoordinator.h"
+#include "SimdDispatch.h"
+#include "AvSync.h"
+#include "RenderScale.h"
+#include "PcmRing.h"
 
 #if JUCE_WINDOWS
   #ifndef NOMINMAX
@@ -124,6 +130,10 @@ public:
         bool expected = false;
         if (!running.compare_exchange_strong(expected, true))
             return; // already running
+        // Only running instances compete for the process-wide render budget
+        auto& budget = QualityBudgetCoordinator::instance();
+        budgetId = budget.registerInstance();
+        budget.setPriority(budgetId, (QualityBudgetCoordinator::Priority)budgetPriority.load(std::memory_order_relaxed));
         worker = std::thread([this]{ this->run(); });
     }
 
@@ -134,6 +144,17 @@ public:
             return; // not running
         if (worker.joinable())
             worker.join();
+        cpuCapture.stop();
+        QualityBudgetCoordinator::instance().unregisterInstance(budgetId);
+        budgetId = 0;
+    }
+
+    // Share of the process-wide render budget (message thread: editor focus/fullscreen state)
+    void setBudgetPriority(QualityBudgetCoordinator::Priority p)
+    {
+        budgetPriority.store((int)p, std::memory_order_relaxed);
+        if (running.load(std::memory_order_acquire))
+            QualityBudgetCoordinator::instance().setPriority(budgetId, p);
     }
 
     // Queue consumption stats from tests (legacy)
@@ -152,6 +173,47 @@ public:
     }
 
     double getTargetFps() const { return targetFps.load(std::memory_order_relaxed); }
+
+    // Degradation order of the adaptive quality ladder (frame rate vs resolution first)
+    void setQualityPolicy(QualityPolicy p)
+    {
+#if defined(MDW_ENABLE_ADAPTIVE_QUALITY)
+        if (MDW_ENABLE_ADAPTIVE_QUALITY)
+            aqController.setPolicy(p);
+#else
+        juce::ignoreUnused(p);
+#endif
+    }
+
+    // Quality rung currently applied by the viz thread (frame rate, scale, effects, mesh).
+    // The GL path reads this to apply the same rung to projectM.
+    QualityProfile getQualityProfile() const
+    {
+        const juce::ScopedLock sl(qualityLock);
+        return appliedProfile;
+    }
+
+    // GL thread, once per projectM frame: time spent rendering it. While the GL path is
+    // active, adaptive quality is driven by these instead of the CPU renderer's frame times.
+    void reportGlFrame(double renderMs)
+    {
+        glFrameMs.store(renderMs, std::memory_order_relaxed);
+        lastGlFrameReportMs.store(juce::Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+    }
+
+    // GL thread: GPU time of a projectM frame from timer queries (see GpuFrameTimer.h), a few
+    // frames after it was rendered. The CPU time above only covers submitting the work, so while
+    // these arrive adaptive quality uses whichever of the two is larger.
+    void reportGpuFrame(double gpuMs)
+    {
+        gpuFrameMsInstant.store(gpuMs, std::memory_order_relaxed);
+        const double prev = gpuFrameMsAverage.load(std::memory_order_relaxed);
+        gpuFrameMsAverage.store(prev <= 0.0 ? gpuMs : 0.9 * prev + 0.1 * gpuMs, std::memory_order_relaxed);
+        lastGpuFrameReportMs.store(juce::Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+    }
+
+    // Frame rate actually paced: the user target, lowered by the AQ rung
+    double getPacedFps() const { return juce::jmin(targetFps.load(std::memory_order_relaxed), qualityFps.load(std::memory_order_relaxed)); }
     uint64_t getFramesRendered() const { return framesRendered.load(std::memory_order_acquire); }
     double getInstantFps() const { return fpsInstant.load(std::memory_order_relaxed); }
     double getAverageFps() const { return fpsAverage.load(std::memory_order_relaxed); }
@@ -163,9 +225,17 @@ public:
         return (double)hits / (double)total;
     }
     // CPU / frame-time metrics getters
+    // Name of the SIMD kernel variant selected for this CPU (e.g. "AVX2")
+    const char* getSimdVariantName() const { return simd::active().name; }
     double getVizThreadCpuPercent() const { return vizCpuPercent.load(std::memory_order_relaxed); }
     double getInstantFrameMs() const { return frameMsInstant.load(std::memory_order_relaxed); }
     double getAverageFrameMs() const { return frameMsAverage.load(std::memory_order_relaxed); }
+    // GPU time of the projectM GL frame; 0 until the GL path reports timer query results
+    double getInstantGpuFrameMs() const { return gpuFrameMsInstant.load(std::memory_order_relaxed); }
+    double getAverageGpuFrameMs() const { return gpuFrameMsAverage.load(std::memory_order_relaxed); }
+    // CPU renderer resolution scale in effect and pixels drawn in the last frame (before upscale)
+    double getRenderScale() const { return renderScale.load(std::memory_order_relaxed); }
+    uint64_t getLastRenderPixelCount() const { return lastRenderPixels.load(std::memory_order_relaxed); }
 
     // Surface/resize API (message thread calls via editor)
     void setSurfaceSize(int w, int h)
@@ -185,6 +255,24 @@ public:
         return true;
     }
 
+    // A/V sync: clock owned by the processor (outlives this thread), plus a user offset.
+    // Positive offsets delay the visuals further, negative ones pull them earlier.
+    void setAudioClock(const AudioClock* c) { audioClock.store(c, std::memory_order_release); }
+    void setAvOffsetMs(double ms) { avOffsetMs.store(ms, std::memory_order_relaxed); }
+    double getAvOffsetMs() const { return avOffsetMs.load(std::memory_order_relaxed); }
+
+    // Frame capture (recording, shared-memory output): the processor's bus, which outlives this
+    // thread. While the GL path isn't rendering, its sinks get the CPU renderer's frames.
+    void setFrameCaptureBus(FrameCaptureBus* b) { captureBus.store(b, std::memory_order_release); }
+
+    // Pixel size the GL readback captures at (the canvas's drawable). CPU frames are scaled to
+    // it off this thread, so captures keep one size on HiDPI displays; 0 x 0 keeps the surface size.
+    void setCaptureSize(int w, int h)
+    {
+        captureWidth.store(w, std::memory_order_relaxed);
+        captureHeight.store(h, std::memory_order_relaxed);
+    }
+
     // Snapshot API for GL thread to fetch latest analysis (non-blocking)
     bool getLatestAnalysisSnapshot(AudioAnalysisSnapshot& out)
     {
@@ -205,6 +293,18 @@ public:
         return true;
     }
 
+    // Planar variant for the audio thread: interleaves straight into the ring, no scratch buffer.
+    // right == nullptr duplicates left; both null post silence.
+    bool postAudioBlock(const float* left, const float* right, int numFrames, double sampleRate)
+    {
+        if (numFrames <= 0)
+            return false;
+        pcmSampleRate.store(sampleRate, std::memory_order_relaxed);
+        pcmRing.pushPlanar(left, right, numFrames);
+        lastPcmWriteMs.store(juce::Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+        return true;
+    }
+
     // Fetch latest PCM window for GL thread consumption (interleaved stereo float)
     bool getLatestPcmWindow(std::vector<float>& outInterleaved, int desiredFrames, double& outSampleRate) const
     {
@@ -214,6 +314,17 @@ public:
         return !outInterleaved.empty();
     }
 
+    // PCM posted since the consumer's last call (interleaved stereo float, at most maxFrames).
+    // Unlike getLatestPcmWindow no frame is returned twice, so feeding the result to projectM
+    // every GL frame passes each sample exactly once.
+    int readNewPcm(PcmRing::ReadCursor& cursor, float* outInterleaved, int maxFrames, double& outSampleRate) const
+    {
+        outSampleRate = pcmSampleRate.load(std::memory_order_relaxed);
+        return pcmRing.readNew(cursor, outInterleaved, maxFrames);
+    }
+
+    int getPcmCapacityFrames() const { return (int)pcmRing.getCapacityFrames(); }
+
     // Whether PCM was posted recently within the provided age threshold (ms)
     bool hasRecentPcm(double maxAgeMs) const
     {
@@ -361,19 +472,13 @@ private:
         
         while (running.load(std::memory_order_relaxed))
         {
-            // Drain queue quickly; keep the most recent snapshot
+            // Drain queue quickly into the history; what is shown is resolved at render time below
             AudioAnalysisSnapshot s;
             bool any = false;
             while (queue.tryPop(s))
             {
                 any = true;
-                latest = s;
-                haveLatest = true;
-                {
-                    juce::ScopedLock sl(latestLock);
-                    latestSnapshot = latest;
-                    latestHave = true;
-                }
+                history.push(s);
                 framesConsumed.fetch_add(1, std::memory_order_relaxed);
             }
 
@@ -382,75 +487,68 @@ private:
             // Apply any pending preset loads
             applyPendingPresetLoads();
 
-            const double fps = targetFps.load(std::memory_order_relaxed);
+            const double fps = getPacedFps();
             const double frameDurMs = 1000.0 / fps;
             const double nowMs = juce::Time::getMillisecondCounterHiRes();
+
+            if (history.size() > 0)
+            {
+                latest = snapshotAt(nowMs * 0.001);
+                haveLatest = true;
+                juce::ScopedLock sl(latestLock);
+                latestSnapshot = latest;
+                latestHave = true;
+            }
             
             if (nowMs >= nextFrameTimeMs)
             {
                 // Render a frame independent of producer cadence
                 if (pm.initialised)
                 {
+                    const double renderStartMs = juce::Time::getMillisecondCounterHiRes();
                     pm.renderFrame(latest);
-                    // CPU render into backBuffer for embedded canvas
+                    // CPU render at surface x resolution scale. At scale 1 it draws straight into
+                    // backBuffer; otherwise into a smaller renderTarget that is upscaled once on blit.
+                    int surfW, surfH;
+                    {
+                        juce::ScopedLock sl(backBufferLock);
+                        surfW = surface.width;
+                        surfH = surface.height;
+                    }
+                    const double scale = getRenderScale();
+                    const RenderSize rs = scaledRenderSize(surfW, surfH, scale);
+                    if (rs.width == surfW && rs.height == surfH)
                     {
                         juce::ScopedLock sl(backBufferLock);
                         if (! backBuffer.isValid() || backBuffer.getWidth() != surface.width || backBuffer.getHeight() != surface.height)
                             backBuffer = juce::Image(juce::Image::ARGB, surface.width, surface.height, true);
-                        juce::Graphics g(backBuffer);
-                        // Background gradient animated by time and parameters
-                        const float bs = pm.beatSensitivity.load(std::memory_order_relaxed);
-                        const float t = (float)(0.001 * juce::Time::getMillisecondCounterHiRes());
-                        // Choose palette based on preset-derived paletteIndex
-                        juce::Colour c1, c2;
-                        const int pal = pm.paletteIndex;
-                        switch (pal) {
-                            case 1:
-                                c1 = juce::Colour::fromFloatRGBA(0.05f + 0.10f * std::sin(t*0.6f), 0.08f, 0.18f, 1.0f);
-                                c2 = juce::Colour::fromFloatRGBA(0.12f, 0.14f + 0.10f * std::sin(t*0.5f + 1.1f), 0.30f, 1.0f);
-                                break;
-                            case 2:
-                                c1 = juce::Colour::fromFloatRGBA(0.10f, 0.06f + 0.10f * std::sin(t*0.8f), 0.12f, 1.0f);
-                                c2 = juce::Colour::fromFloatRGBA(0.22f, 0.10f, 0.16f + 0.12f * std::sin(t*0.9f + 0.7f), 1.0f);
-                                break;
-                            case 3:
-                                c1 = juce::Colour::fromFloatRGBA(0.06f, 0.12f, 0.08f + 0.10f * std::sin(t*0.7f), 1.0f);
-                                c2 = juce::Colour::fromFloatRGBA(0.10f, 0.24f, 0.14f + 0.10f * std::sin(t*0.4f + 0.9f), 1.0f);
-                                break;
-                            case 4:
-                                c1 = juce::Colour::fromFloatRGBA(0.12f + 0.10f * std::sin(t*0.3f), 0.10f, 0.06f, 1.0f);
-                                c2 = juce::Colour::fromFloatRGBA(0.26f, 0.22f, 0.10f + 0.08f * std::sin(t*0.6f + 1.5f), 1.0f);
-                                break;
-                            default:
-                                c1 = juce::Colour::fromFloatRGBA(0.08f + 0.06f * std::sin(t*0.5f), 0.10f, 0.12f, 1.0f);
-                                c2 = juce::Colour::fromFloatRGBA(0.12f, 0.16f + 0.08f * std::sin(t*0.7f + 1.3f), 0.20f, 1.0f);
-                                break;
-                        }
-                        g.setGradientFill(juce::ColourGradient(c1, 0.0f, 0.0f, c2, (float)surface.width, (float)surface.height, false));
-                        g.fillAll();
-
-                        // Optional subtle vignette and preset name overlay (no bar-chart here)
-                        const float w = (float)surface.width;
-                        const float h = (float)surface.height;
-                        // Soft vignette based on energy to show audio reactivity without bars
-                        const float energy = latest.shortTimeEnergy;
-                        const float amp = juce::jlimit(0.0f, 1.0f, std::sqrt(energy) * (0.4f + 0.6f * bs));
-                        juce::Colour vignette = juce::Colours::black.withAlpha(0.15f + 0.25f * amp);
-                        g.setGradientFill(juce::ColourGradient(vignette, w*0.5f, h*0.5f, juce::Colours::transparentBlack, 0.0f, 0.0f, true));
-                        g.fillAll();
-
-                        // Draw current preset name for user confirmation
-                        if (pm.currentPresetName.isNotEmpty()) {
-                            auto textBounds = juce::Rectangle<int>(8, (int)h - 32, (int)w - 16, 24);
-                            // Backdrop for readability
-                            g.setColour(juce::Colours::black.withAlpha(0.35f));
-                            g.fillRoundedRectangle(textBounds.reduced(2).toFloat(), 4.0f);
-                            // Text
-                            g.setColour(juce::Colours::white.withAlpha(0.92f));
-                            g.setFont(juce::FontOptions(18.0f).withStyle("Bold"));
-                            g.drawFittedText(pm.currentPresetName, textBounds, juce::Justification::centredRight, 1);
-                        }
+                        drawCpuFrame(backBuffer, latest, 1.0f);
                     }
+                    else
+                    {
+                        if (! renderTarget.isValid() || renderTarget.getWidth() != rs.width || renderTarget.getHeight() != rs.height)
+                            renderTarget = juce::Image(juce::Image::ARGB, rs.width, rs.height, false);
+                        drawCpuFrame(renderTarget, latest, (float)rs.width / (float)surfW);
+
+                        juce::ScopedLock sl(backBufferLock);
+                        if (! backBuffer.isValid() || backBuffer.getWidth() != surface.width || backBuffer.getHeight() != surface.height)
+                            backBuffer = juce::Image(juce::Image::ARGB, surface.width, surface.height, true);
+                        upscaleInto(renderTarget, backBuffer);
+                    }
+                    lastRenderPixels.store(rs.pixels(), std::memory_order_relaxed);
+
+                #if defined(MDW_ENABLE_ADAPTIVE_QUALITY)
+                    // Adaptive quality reacts per frame to this frame's render cost
+                    if (MDW_ENABLE_ADAPTIVE_QUALITY)
+                        updateAdaptiveQuality(juce::Time::getMillisecondCounterHiRes() - renderStartMs);
+                #endif
+
+                    // The GL canvas captures its own frames while it renders projectM. After the
+                    // AQ measurement: capturing is not part of the render cost
+                    auto* bus = captureBus.load(std::memory_order_acquire);
+                    if (bus != nullptr && bus->hasSinks()
+                        && juce::Time::getMillisecondCounterHiRes() - lastGlFrameReportMs.load(std::memory_order_relaxed) >= glReportTimeoutMs)
+                        submitCpuFrame(*bus, renderStartMs);
                 }
                 framesRendered.fetch_add(1, std::memory_order_relaxed);
 
@@ -529,28 +627,13 @@ private:
                 juce::String aqSuffix;
             #if defined(MDW_ENABLE_ADAPTIVE_QUALITY)
                 if (MDW_ENABLE_ADAPTIVE_QUALITY) {
-                    auto decision = aqController.evaluate(avg, fMsAvg, cpuPct);
-                    // Apply the resolution scaling decision
-                    const double prevScale = currentResolutionScale;
-                    currentResolutionScale = decision.suggestedScale;
-                    // If scale changed significantly, resize backbuffer on next frame
-                    if (std::abs(currentResolutionScale - prevScale) > 0.01) {
-                        juce::ScopedLock sl(backBufferLock);
-                        const int targetW = juce::jmax(2, (int)(surface.width * currentResolutionScale));
-                        const int targetH = juce::jmax(2, (int)(surface.height * currentResolutionScale));
-                        if (backBuffer.getWidth() != targetW || backBuffer.getHeight() != targetH) {
-                            backBuffer = juce::Image(juce::Image::ARGB, targetW, targetH, true);
-                            MDW_LOG_INFO(juce::String("Adaptive Quality: resized backbuffer to ") +
-                                       juce::String(targetW) + "x" + juce::String(targetH) +
-                                       " (scale=" + juce::String(currentResolutionScale, 2) + ")");
-                        }
-                    }
+                    // Reporting only; decisions are made per frame in updateAdaptiveQuality
+                    aqSuffix = juce::String(", AQ scale=") + juce::String(lastAqDecision.suggestedScale, 2) +
+                               ", budgetCap=" + juce::String(budgetCap, 2) +
+                               ", p95=" + juce::String(lastAqDecision.p95Ms, 2) +
+                               ", p99=" + juce::String(lastAqDecision.p99Ms, 2);
                 #if MDW_VERBOSE_ADAPTIVE_QUALITY
-                    aqSuffix = juce::String(", AQ scale=") + juce::String(decision.suggestedScale, 2) +
-                               ", reason=" + decision.reason;
-                #else
-                    aqSuffix = juce::String(", AQ scale=") + juce::String(decision.suggestedScale, 2);
-                    juce::ignoreUnused(decision);
+                    aqSuffix += ", reason=" + lastAqDecision.reason;
                 #endif
                 }
             #endif
@@ -565,7 +648,11 @@ private:
                              ", misses=" + juce::String((double)cm, 0) + 
                              ", hitRate=" + juce::String(hitRate * 100.0, 1) + "%" +
                              ", avgHitMs=" + juce::String(avgCacheHitMs, 2) + 
-                             ", avgMissMs=" + juce::String(avgCacheMissMs, 2) + aqSuffix);
+                             ", avgMissMs=" + juce::String(avgCacheMissMs, 2) +
+                             ", renderPx=" + juce::String((double)lastRenderPixels.load(std::memory_order_relaxed), 0) +
+                             (isGpuFrameReportFresh() ? ", gpuMs inst=" + juce::String(getInstantGpuFrameMs(), 2)
+                                                        + ", avg=" + juce::String(getAverageGpuFrameMs(), 2) : juce::String()) +
+                             ", simd=" + juce::String(getSimdVariantName()) + aqSuffix);
                 nextMetricsLogMs = tnow + metricsLogIntervalMs;
             }
 
@@ -576,47 +663,192 @@ private:
         pm.shutdown();
     }
 
-    // Lock-free PCM ring buffer for stereo float (interleaved) samples
-    struct PcmRing {
-        std::vector<float> data; // length = capacityFrames * 2
-        size_t capacityFrames = 0;
-        std::atomic<size_t> writePosFrames{ 0 };
-        void init(size_t framesCapacity)
+#if defined(MDW_ENABLE_ADAPTIVE_QUALITY)
+    // Per-frame AQ step; the next frame's render target is sized from the new scale,
+    // capped by this instance's share of the process-wide budget
+    void updateAdaptiveQuality(double renderMs)
+    {
+        // The projectM GL frame is what the user sees; prefer its cost while it is being reported,
+        // and take the GPU's side of it when that is the slower one
+        if (juce::Time::getMillisecondCounterHiRes() - lastGlFrameReportMs.load(std::memory_order_relaxed) < glReportTimeoutMs)
         {
-            capacityFrames = framesCapacity > 0 ? framesCapacity : 1;
-            data.assign(capacityFrames * 2, 0.0f);
-            writePosFrames.store(0, std::memory_order_relaxed);
+            renderMs = glFrameMs.load(std::memory_order_relaxed);
+            if (isGpuFrameReportFresh())
+                renderMs = juce::jmax(renderMs, gpuFrameMsInstant.load(std::memory_order_relaxed));
         }
-        void pushInterleaved(const float* interleavedStereo, int frames)
+        const double cap = QualityBudgetCoordinator::instance().reportFrame(
+            budgetId, renderMs, currentResolutionScale, getPacedFps());
+        // The controller costs its rungs under the cap, so its suggestion is the applied scale
+        aqController.setScaleCap(cap);
+        lastAqDecision = aqController.evaluateFrame(renderMs, vizCpuPercent.load(std::memory_order_relaxed));
+        currentResolutionScale = lastAqDecision.suggestedScale;
+        budgetCap = cap;
+        renderScale.store(currentResolutionScale, std::memory_order_relaxed);
+        if (lastAqDecision.changed)
         {
-            if (!interleavedStereo || frames <= 0 || capacityFrames == 0) return;
-            size_t w = writePosFrames.load(std::memory_order_relaxed);
-            const size_t cap = capacityFrames;
-            for (int i = 0; i < frames; ++i)
-            {
-                const size_t pos = (w % cap) * 2;
-                data[pos + 0] = interleavedStereo[(size_t)i * 2 + 0];
-                data[pos + 1] = interleavedStereo[(size_t)i * 2 + 1];
-                w = (w + 1) % cap;
-            }
-            writePosFrames.store(w, std::memory_order_release);
+            qualityFps.store(lastAqDecision.profile.targetFps, std::memory_order_relaxed);
+            effectsTier = lastAqDecision.profile.effectsTier;
+            const juce::ScopedLock sl(qualityLock);
+            appliedProfile = lastAqDecision.profile;
         }
-        void copyLatest(int desiredFrames, std::vector<float>& out) const
+    #if MDW_VERBOSE_ADAPTIVE_QUALITY
+        if (lastAqDecision.changed)
+            MDW_LOG_INFO(juce::String("Adaptive Quality: rung=") + juce::String(lastAqDecision.rung) +
+                         " fps=" + juce::String(lastAqDecision.profile.targetFps, 0) +
+                         " effects=" + juce::String(lastAqDecision.profile.effectsTier) +
+                         " mesh=" + juce::String(lastAqDecision.profile.meshWidth) + "x" + juce::String(lastAqDecision.profile.meshHeight) +
+                         " scale=" + juce::String(currentResolutionScale, 2) +
+                         " (p95=" + juce::String(lastAqDecision.p95Ms, 2) + "ms, p99=" + juce::String(lastAqDecision.p99Ms, 2) +
+                         "ms, budget=" + juce::String(lastAqDecision.budgetMs, 2) + "ms, " + lastAqDecision.reason + ")");
+    #endif
+    }
+#endif
+
+    // One CPU-rendered frame into img (backBuffer or the scaled renderTarget). pxScale is the
+    // render-to-surface pixel ratio, so overlay sizes stay constant on screen after upscaling.
+    void drawCpuFrame(juce::Image& img, const AudioAnalysisSnapshot& snap, float pxScale)
+    {
+        // Background gradient animated by time and parameters
+        const float bs = pm.beatSensitivity.load(std::memory_order_relaxed);
+        const float t = (float)(0.001 * juce::Time::getMillisecondCounterHiRes());
+        // Choose palette based on preset-derived paletteIndex
+        juce::Colour c1, c2;
+        const int pal = pm.paletteIndex;
+        switch (pal) {
+            case 1:
+                c1 = juce::Colour::fromFloatRGBA(0.05f + 0.10f * std::sin(t*0.6f), 0.08f, 0.18f, 1.0f);
+                c2 = juce::Colour::fromFloatRGBA(0.12f, 0.14f + 0.10f * std::sin(t*0.5f + 1.1f), 0.30f, 1.0f);
+                break;
+            case 2:
+                c1 = juce::Colour::fromFloatRGBA(0.10f, 0.06f + 0.10f * std::sin(t*0.8f), 0.12f, 1.0f);
+                c2 = juce::Colour::fromFloatRGBA(0.22f, 0.10f, 0.16f + 0.12f * std::sin(t*0.9f + 0.7f), 1.0f);
+                break;
+            case 3:
+                c1 = juce::Colour::fromFloatRGBA(0.06f, 0.12f, 0.08f + 0.10f * std::sin(t*0.7f), 1.0f);
+                c2 = juce::Colour::fromFloatRGBA(0.10f, 0.24f, 0.14f + 0.10f * std::sin(t*0.4f + 0.9f), 1.0f);
+                break;
+            case 4:
+                c1 = juce::Colour::fromFloatRGBA(0.12f + 0.10f * std::sin(t*0.3f), 0.10f, 0.06f, 1.0f);
+                c2 = juce::Colour::fromFloatRGBA(0.26f, 0.22f, 0.10f + 0.08f * std::sin(t*0.6f + 1.5f), 1.0f);
+                break;
+            default:
+                c1 = juce::Colour::fromFloatRGBA(0.08f + 0.06f * std::sin(t*0.5f), 0.10f, 0.12f, 1.0f);
+                c2 = juce::Colour::fromFloatRGBA(0.12f, 0.16f + 0.08f * std::sin(t*0.7f + 1.3f), 0.20f, 1.0f);
+                break;
+        }
+        fillDiagonalGradient(img, c1, c2);
+        juce::Graphics g(img);
+
+        // Optional subtle vignette and preset name overlay (no bar-chart here)
+        const float w = (float)img.getWidth();
+        const float h = (float)img.getHeight();
+        // Soft vignette based on energy to show audio reactivity without bars.
+        // Skipped on the minimal effects tier: it is a full-frame radial gradient.
+        if (effectsTier >= 1) {
+            const float energy = snap.shortTimeEnergy;
+            const float amp = juce::jlimit(0.0f, 1.0f, std::sqrt(energy) * (0.4f + 0.6f * bs));
+            juce::Colour vignette = juce::Colours::black.withAlpha(0.15f + 0.25f * amp);
+            g.setGradientFill(juce::ColourGradient(vignette, w*0.5f, h*0.5f, juce::Colours::transparentBlack, 0.0f, 0.0f, true));
+            g.fillAll();
+        }
+
+        // Draw current preset name for user confirmation
+        if (pm.currentPresetName.isNotEmpty()) {
+            auto textBounds = juce::Rectangle<float>(8.0f * pxScale, h - 32.0f * pxScale,
+                                                     w - 16.0f * pxScale, 24.0f * pxScale).toNearestInt();
+            // Backdrop for readability
+            g.setColour(juce::Colours::black.withAlpha(0.35f));
+            if (effectsTier >= 2)
+                g.fillRoundedRectangle(textBounds.reduced(2).toFloat(), 4.0f * pxScale);
+            else
+                g.fillRect(textBounds.reduced(2));
+            // Text
+            g.setColour(juce::Colours::white.withAlpha(0.92f));
+            g.setFont(juce::FontOptions(18.0f * pxScale).withStyle("Bold"));
+            g.drawFittedText(pm.currentPresetName, textBounds, juce::Justification::centredRight, 1);
+        }
+    }
+
+    // Copies the finished back buffer for the capture worker, which runs the sinks on its own
+    // thread. Outside backBufferLock: the local Image shares the pixels, and only this thread
+    // draws into them (resizing swaps in a new image)
+    void submitCpuFrame(FrameCaptureBus& bus, double timestampMs)
+    {
+        juce::Image frame;
         {
-            out.resize((size_t)juce::jmax(0, desiredFrames) * 2);
-            if (capacityFrames == 0 || desiredFrames <= 0) { std::fill(out.begin(), out.end(), 0.0f); return; }
-            int framesToCopy = juce::jmin((int)capacityFrames, desiredFrames);
-            const size_t cap = capacityFrames;
-            const size_t w = writePosFrames.load(std::memory_order_acquire);
-            for (int i = 0; i < framesToCopy; ++i)
-            {
-                const size_t pos = (w + cap - (size_t)framesToCopy + (size_t)i) % cap;
-                const size_t idx = pos * 2;
-                out[(size_t)i * 2 + 0] = data[idx + 0];
-                out[(size_t)i * 2 + 1] = data[idx + 1];
-            }
+            juce::ScopedLock sl(backBufferLock);
+            frame = backBuffer;
         }
-    };
+        if (! frame.isValid()) return;
+        const juce::Image::BitmapData bd(frame, juce::Image::BitmapData::readOnly);
+        if (bd.pixelFormat != juce::Image::ARGB || bd.pixelStride != 4) return;
+        CapturedFrameView v;
+        v.pixels = bd.getLinePointer(0);
+        v.width = bd.width;
+        v.height = bd.height;
+        v.stride = bd.lineStride;
+        v.frameIndex = framesRendered.load(std::memory_order_relaxed) + 1;
+        v.timestampMs = timestampMs;
+        v.topDown = true;
+        cpuCapture.setOutputSize(captureWidth.load(std::memory_order_relaxed), captureHeight.load(std::memory_order_relaxed));
+        cpuCapture.submit(bus, v);
+    }
+
+    // Stretch the scaled render target over the full-size back buffer (caller holds backBufferLock)
+    void upscaleInto(const juce::Image& src, juce::Image& dst)
+    {
+        juce::Image::BitmapData sd(src, juce::Image::BitmapData::readOnly);
+        juce::Image::BitmapData dd(dst, juce::Image::BitmapData::writeOnly);
+        if (sd.pixelFormat != juce::Image::ARGB || sd.pixelStride != 4 || (sd.lineStride & 3) != 0
+            || dd.pixelFormat != juce::Image::ARGB || dd.pixelStride != 4 || (dd.lineStride & 3) != 0) {
+            juce::Graphics g(dst);
+            g.setImageResamplingQuality(juce::Graphics::mediumResamplingQuality);
+            g.drawImage(src, dst.getBounds().toFloat());
+            return;
+        }
+        upscaler.upscale(reinterpret_cast<const uint32_t*>(sd.getLinePointer(0)), sd.width, sd.height, sd.lineStride / 4,
+                         reinterpret_cast<uint32_t*>(dd.getLinePointer(0)), dd.width, dd.height, dd.lineStride / 4);
+    }
+
+    // Opaque diagonal gradient c1 (top-left) -> c2 (bottom-right), one dispatched row fill per scanline
+    static void fillDiagonalGradient(juce::Image& img, juce::Colour c1, juce::Colour c2)
+    {
+        const int w = img.getWidth();
+        const int h = img.getHeight();
+        if (w <= 0 || h <= 0) return;
+        juce::Image::BitmapData bd(img, juce::Image::BitmapData::writeOnly);
+        if (bd.pixelFormat != juce::Image::ARGB || bd.pixelStride != 4) {
+            juce::Graphics g(img);
+            g.setGradientFill(juce::ColourGradient(c1, 0.0f, 0.0f, c2, (float)w, (float)h, false));
+            g.fillAll();
+            return;
+        }
+        const float c0[3] = { c1.getFloatRed(), c1.getFloatGreen(), c1.getFloatBlue() };
+        const float dc[3] = { c2.getFloatRed() - c0[0], c2.getFloatGreen() - c0[1], c2.getFloatBlue() - c0[2] };
+        // Projection of (x, y) onto the (w, h) diagonal: t = (x*w + y*h) / (w^2 + h^2)
+        const float fw = (float)w, fh = (float)h;
+        const float inv = 1.0f / (fw * fw + fh * fh);
+        const auto& k = simd::active();
+        for (int y = 0; y < h; ++y)
+            k.fillGradientRow(reinterpret_cast<uint32_t*>(bd.getLinePointer(y)), w, c0, dc, (float)y * fh * inv, fw * inv);
+    }
+
+    // Features of the audio leaving the speakers at nowSec: the audio clock maps wall time back
+    // to the sample position being heard (SnapshotHistory::targetPosition), and the history
+    // interpolates between the snapshots either side of it so the renderer moves smoothly at
+    // any display rate and host buffer size. Without a clock yet, uses the newest snapshot.
+    AudioAnalysisSnapshot snapshotAt(double nowSec) const
+    {
+        const AudioClock* clock = audioClock.load(std::memory_order_acquire);
+        if (clock == nullptr) return history.newest();
+        const AudioClock::State cs = clock->read();
+        if (! cs.valid) return history.newest();
+
+        const double offsetSec = avOffsetMs.load(std::memory_order_relaxed) * 0.001;
+        AudioAnalysisSnapshot out;
+        history.interpolate(history.targetPosition(cs, nowSec, offsetSec), out);
+        return out;
+    }
 
     PcmRing pcmRing;
     std::atomic<double> pcmSampleRate{ 44100.0 };
@@ -633,12 +865,41 @@ private:
     RenderSurface surface;
     juce::Image backBuffer;
     juce::CriticalSection backBufferLock;
+    std::atomic<FrameCaptureBus*> captureBus{ nullptr }; // see setFrameCaptureBus
+    FrameCaptureWorker cpuCapture;   // runs the sinks for CPU frames (submitCpuFrame)
+    std::atomic<int> captureWidth{ 0 };
+    std::atomic<int> captureHeight{ 0 };
+    juce::Image renderTarget;        // viz thread only: surface x renderScale
+    BilinearUpscaler upscaler;       // viz thread only
+    std::atomic<double> renderScale{ 1.0 };
+    std::atomic<int> budgetId{ 0 }; // QualityBudgetCoordinator registration while running (0 = none)
+    std::atomic<int> budgetPriority{ (int)QualityBudgetCoordinator::Priority::Background };
+    std::atomic<uint64_t> lastRenderPixels{ 0 };
+    std::atomic<double> qualityFps{ 240.0 }; // AQ rung frame rate; paced at min(targetFps, this)
+    int effectsTier { 2 };                   // viz thread only, from the applied rung
+    juce::CriticalSection qualityLock;
+    QualityProfile appliedProfile;           // guarded by qualityLock
+    std::atomic<double> glFrameMs{ 0.0 };    // last projectM GL frame time, see reportGlFrame
+    std::atomic<double> lastGlFrameReportMs{ -1.0e9 };
+    static constexpr double glReportTimeoutMs = 250.0;
+    std::atomic<double> gpuFrameMsInstant{ 0.0 }; // see reportGpuFrame
+    std::atomic<double> gpuFrameMsAverage{ 0.0 }; // EMA
+    std::atomic<double> lastGpuFrameReportMs{ -1.0e9 };
+    bool isGpuFrameReportFresh() const
+    {
+        return juce::Time::getMillisecondCounterHiRes() - lastGpuFrameReportMs.load(std::memory_order_relaxed) < glReportTimeoutMs;
+    }
 
     // Latest analysis snapshot for GL thread consumption
     juce::CriticalSection latestLock;
     AudioAnalysisSnapshot latestSnapshot{};
     bool latestHave { false };
 
+    // A/V sync state
+    std::atomic<const AudioClock*> audioClock{ nullptr };
+    std::atomic<double> avOffsetMs{ 0.0 };
+    SnapshotHistory history; // viz thread only
+
     ThreadSafeSPSCQueue<ParameterChange, 64> paramChanges;
     ThreadSafeSPSCQueue<juce::String, 8> presetLoadRequests;
     juce::String lastAppliedPreset;
@@ -659,6 +920,8 @@ private:
 #if defined(MDW_ENABLE_ADAPTIVE_QUALITY)
     AdaptiveQualityController aqController;
     double currentResolutionScale { 1.0 }; // viz thread only, applied from aqController decision
+    AdaptiveQualityController::Decision lastAqDecision; // viz thread only
+    double budgetCap { 1.0 }; // viz thread only, last cap from QualityBudgetCoordinator
 #endif
 
     // CPU sampling state (viz thread only)
@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "FrameCapture.h"
+#include "Logging.h"
+#include "SimdDispatch.h"
+#include "ThreadSafeQueue.h"
+
+namespace milkdawp {
+
+// Live recording of the rendered frames to a YUV4MPEG2 (.y4m) file: uncompressed I420 that
+// ffmpeg, video editors and most players read directly.
+//
+// As a FrameCaptureSink, deliver() runs on the GL canvas's capture thread, or on the viz thread
+// for the CPU renderer. It converts straight from the delivered pixels into a free buffer of a
+// bounded pool (SIMD-dispatched, see argbToI420Rows); at 1.5 bytes per pixel instead of 4 that
+// costs about what copying the frame would. A writer thread appends the queued frames to the
+// file. When the disk stalls long enough for the pool to run full, frames are dropped and
+// counted; deliver() never waits for the writer.
+//
+// The file has a fixed frame rate. Each frame goes into the slot its render timestamp falls in,
+// and gaps (dropped or slow frames) are filled by repeating the previous frame, so the video
+// stays in time with the session. Pauses longer than maxGapSeconds (the editor was closed) are
+// cut. Y4M fixes the picture size in its header, so a size change starts a new file
+// ("name-2.y4m", "name-3.y4m", ...). Odd sizes lose their last column or row, since I420
+// chroma covers 2x2 blocks.
+class Y4mRecorder : public FrameCaptureSink {
+public:
+    static constexpr int queueDepth = 16;         // frames converted but not yet on disk: ~0.25 s at 60 fps
+    static constexpr double maxGapSeconds = 2.0;  // longest gap filled with repeated frames
+
+    struct Stats {
+        uint64_t framesWritten = 0;  // frames in the file(s), repeats included
+        uint64_t framesRepeated = 0; // written again to fill a gap in the timeline
+        uint64_t framesDropped = 0;  // arrived while the queue was full (disk stall) or after a write error
+        uint64_t bytesWritten = 0;
+        double writeMsAverage = 0.0; // EMA of the time to write one frame
+        int files = 0;
+    };
+
+    ~Y4mRecorder() override { stop(); }
+
+    // Message thread, before the recorder is added to the capture bus. Creates (or truncates)
+    // file and starts the writer thread; fps is the frame rate of the recording.
+    bool start(const juce::File& file, double fps)
+    {
+        if (worker.joinable()) return false;
+        baseFile = file;
+        frameRate = juce::jlimit(1.0, 240.0, fps);
+        auto out = std::make_unique<juce::FileOutputStream>(file, writeBufferBytes);
+        if (! out->openedOk() || ! out->setPosition(0) || ! out->truncate().wasOk())
+        {
+            MDW_LOG_ERROR("Recording: cannot write " + file.getFullPathName());
+            return false;
+        }
+        stream = std::move(out);
+        for (auto& s : state)
+            s.store(slotFree, std::memory_order_relaxed);
+        int slot = 0;
+        while (ready.tryPop(slot)) {}
+        written = repeated = dropped = bytes = 0;
+        writeMsAverage.store(0.0, std::memory_order_relaxed);
+        files.store(1, std::memory_order_relaxed);
+        writeFailed = false;
+        stopping.store(false, std::memory_order_relaxed);
+        recording.store(true, std::memory_order_release);
+        worker = std::thread([this] { run(); });
+        MDW_LOG_INFO("Recording: " + file.getFullPathName() + " at " + juce::String(frameRate, 2) + " fps");
+        return true;
+    }
+
+    // Message thread, after the recorder was removed from the capture bus: writes out the
+    // queued frames and closes the file
+    void stop()
+    {
+        if (! worker.joinable()) return;
+        recording.store(false, std::memory_order_release);
+        stopping.store(true, std::memory_order_release);
+        wake.signal();
+        worker.join();
+        const auto s = getStats();
+        MDW_LOG_INFO("Recording stopped: " + juce::String((juce::int64)s.framesWritten) + " frames ("
+                     + juce::String((juce::int64)s.framesRepeated) + " repeated, "
+                     + juce::String((juce::int64)s.framesDropped) + " dropped), "
+                     + juce::String((double)s.bytesWritten / (1024.0 * 1024.0), 1) + " MB in "
+                     + juce::String(s.files) + (s.files == 1 ? " file" : " files"));
+    }
+
+    bool isRecording() const noexcept { return recording.load(std::memory_order_acquire); }
+    juce::File getFile() const { return baseFile; }
+
+    Stats getStats() const noexcept
+    {
+        Stats s;
+        s.framesWritten = written.load(std::memory_order_relaxed);
+        s.framesRepeated = repeated.load(std::memory_order_relaxed);
+        s.framesDropped = dropped.load(std::memory_order_relaxed);
+        s.bytesWritten = bytes.load(std::memory_order_relaxed);
+        s.writeMsAverage = writeMsAverage.load(std::memory_order_relaxed);
+        s.files = files.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Capture thread (deliveries are serialised by the bus)
+    void deliver(const CapturedFrameView& v) override
+    {
+        if (! recording.load(std::memory_order_acquire)) return;
+        const int w = v.width & ~1, h = v.height & ~1;
+        if (w <= 0 || h <= 0) return;
+
+        int slot = -1;
+        for (int i = 0; i < queueDepth && slot < 0; ++i)
+            if (state[(size_t)i].load(std::memory_order_acquire) == slotFree)
+                slot = i;
+        if (slot < 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto& f = pool[(size_t)slot];
+        const size_t lumaBytes = (size_t)w * (size_t)h;
+        if (f.data.size() != lumaBytes * 3 / 2)
+            f.data.resize(lumaBytes * 3 / 2); // only when the frame size changes
+        uint8_t* y = f.data.data();
+        uint8_t* cb = y + lumaBytes;
+        uint8_t* cr = cb + lumaBytes / 4;
+        const auto& k = simd::active();
+        const size_t cw = (size_t)w / 2;
+        for (int row = 0; row < h; row += 2)
+            k.argbToI420Rows(reinterpret_cast<const uint32_t*>(v.row(row)), reinterpret_cast<const uint32_t*>(v.row(row + 1)),
+                             y + (size_t)row * (size_t)w, y + (size_t)(row + 1) * (size_t)w,
+                             cb + (size_t)(row / 2) * cw, cr + (size_t)(row / 2) * cw, w);
+        f.width = w;
+        f.height = h;
+        f.timestampMs = v.timestampMs;
+        state[(size_t)slot].store(slotQueued, std::memory_order_relaxed);
+        ready.tryPush(slot); // can't be full: it holds at most queueDepth entries
+        wake.signal();
+    }
+
+private:
+    static constexpr int slotFree = 0;
+    static constexpr int slotQueued = 1; // in ready, or held by the writer
+    static constexpr int writeBufferBytes = 1 << 20;
+    static constexpr double statsLogIntervalMs = 2000.0;
+
+    struct Frame {
+        std::vector<uint8_t> data; // Y, then Cb, then Cr planes
+        int width = 0;
+        int height = 0;
+        double timestampMs = 0.0;
+    };
+
+    // Writer thread
+    void run()
+    {
+        int held = -1;              // last frame written, kept to repeat into gaps
+        int fileW = 0, fileH = 0;   // picture size of the current file
+        double t0 = 0.0;            // timestamp of the current file's first frame
+        int64_t lastSlot = -1;      // timeline slot of the last frame written
+        double nextLogMs = juce::Time::getMillisecondCounterHiRes() + statsLogIntervalMs;
+
+        for (;;)
+        {
+            int slot = -1;
+            if (! ready.tryPop(slot))
+            {
+                if (stopping.load(std::memory_order_acquire))
+                    break;
+                wake.wait(50);
+                continue;
+            }
+
+            const Frame& f = pool[(size_t)slot];
+            bool keep = false;
+            if (writeFailed)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (f.width != fileW || f.height != fileH)
+            {
+                if (fileW != 0 && ! openNextFile())
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                else if (writeHeader(f.width, f.height) && writeFrame(f))
+                {
+                    fileW = f.width;
+                    fileH = f.height;
+                    t0 = f.timestampMs;
+                    lastSlot = 0;
+                    keep = true;
+                }
+            }
+            else
+            {
+                const int64_t target = (int64_t)std::llround((f.timestampMs - t0) * frameRate * 0.001);
+                if (target > lastSlot)
+                {
+                    // Repeat the previous frame into the slots nothing arrived for
+                    const int64_t gap = juce::jmin(target - lastSlot - 1, (int64_t)std::llround(maxGapSeconds * frameRate));
+                    for (int64_t i = 0; i < gap && held >= 0 && ! writeFailed; ++i)
+                        if (writeFrame(pool[(size_t)held]))
+                            repeated.fetch_add(1, std::memory_order_relaxed);
+                    keep = writeFrame(f);
+                    lastSlot = target;
+                }
+                // else: a second frame within one slot (rendering faster than the recording rate)
+            }
+
+            if (keep)
+            {
+                if (held >= 0) state[(size_t)held].store(slotFree, std::memory_order_release);
+                held = slot;
+            }
+            else
+            {
+                state[(size_t)slot].store(slotFree, std::memory_order_release);
+            }
+
+            const double now = juce::Time::getMillisecondCounterHiRes();
+            if (now >= nextLogMs)
+            {
+                const auto s = getStats();
+                MDW_LOG_INFO("Recording perf: written=" + juce::String((juce::int64)s.framesWritten)
+                             + ", repeated=" + juce::String((juce::int64)s.framesRepeated)
+                             + ", dropped=" + juce::String((juce::int64)s.framesDropped)
+                             + ", queued=" + juce::String(ready.getNumAvailable())
+                             + ", writeMs avg=" + juce::String(s.writeMsAverage, 2)
+                             + ", MB=" + juce::String((double)s.bytesWritten / (1024.0 * 1024.0), 0));
+                nextLogMs = now + statsLogIntervalMs;
+            }
+        }
+
+        if (held >= 0) state[(size_t)held].store(slotFree, std::memory_order_release);
+        if (stream != nullptr) stream->flush();
+        stream.reset();
+    }
+
+    bool openNextFile()
+    {
+        stream->flush();
+        const int n = files.load(std::memory_order_relaxed) + 1;
+        const auto next = baseFile.getSiblingFile(baseFile.getFileNameWithoutExtension() + "-" + juce::String(n) + baseFile.getFileExtension());
+        auto out = std::make_unique<juce::FileOutputStream>(next, writeBufferBytes);
+        if (! out->openedOk() || ! out->setPosition(0) || ! out->truncate().wasOk())
+        {
+            MDW_LOG_ERROR("Recording: cannot write " + next.getFullPathName());
+            writeFailed = true;
+            return false;
+        }
+        stream = std::move(out);
+        files.store(n, std::memory_order_relaxed);
+        MDW_LOG_INFO("Recording: frame size changed, continuing in " + next.getFullPathName());
+        return true;
+    }
+
+    bool writeHeader(int w, int h)
+    {
+        // Rate as a fraction, e.g. 60:1 or 60000:1001
+        const int64_t num = std::llround(frameRate * 1000.0);
+        const int64_t g = std::gcd(num, (int64_t)1000);
+        const juce::String header = "YUV4MPEG2 W" + juce::String(w) + " H" + juce::String(h)
+            + " F" + juce::String((juce::int64)(num / g)) + ":" + juce::String((juce::int64)(1000 / g))
+            + " Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+        return write(header.toRawUTF8(), header.getNumBytesAsUTF8());
+    }
+
+    bool writeFrame(const Frame& f)
+    {
+        const double t = juce::Time::getMillisecondCounterHiRes();
+        if (! write("FRAME\n", 6) || ! write(f.data.data(), f.data.size()))
+            return false;
+        const double ms = juce::Time::getMillisecondCounterHiRes() - t;
+        const double prev = writeMsAverage.load(std::memory_order_relaxed);
+        writeMsAverage.store(prev <= 0.0 ? ms : 0.9 * prev + 0.1 * ms, std::memory_order_relaxed);
+        written.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool write(const void* data, size_t n)
+    {
+        if (stream->write(data, n))
+        {
+            bytes.fetch_add(n, std::memory_order_relaxed);
+            return true;
+        }
+        if (! writeFailed)
+            MDW_LOG_ERROR("Recording: write failed (disk full?), further frames are dropped: " + baseFile.getFullPathName());
+        writeFailed = true;
+        return false;
+    }
+
+    juce::File baseFile;
+    double frameRate = 60.0;
+    std::unique_ptr<juce::FileOutputStream> stream; // writer thread while recording
+    bool writeFailed = false;                       // writer thread while recording
+    std::thread worker;
+    juce::WaitableEvent wake;
+    std::atomic<bool> recording{ false };
+    std::atomic<bool> stopping{ false };
+
+    std::array<Frame, queueDepth> pool{};
+    std::array<std::atomic<int>, queueDepth> state{};
+    ThreadSafeSPSCQueue<int, queueDepth * 2> ready;
+
+    std::atomic<uint64_t> written{ 0 };
+    std::atomic<uint64_t> repeated{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<double> writeMsAverage{ 0.0 };
+    std::atomic<int> files{ 0 };
+};
+
+} // namespace milkdawp
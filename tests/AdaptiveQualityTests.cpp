@@ -0,0 +1,220 @@
+#include <juce_core/juce_core.h>
+#include "../src/AdaptiveQuality.h"
+
+using namespace milkdawp;
+
+class AdaptiveQualityTests : public juce::UnitTest {
+public:
+    AdaptiveQualityTests() : juce::UnitTest("AdaptiveQualityTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Frame time window percentiles");
+        {
+            FrameTimeWindow w;
+            expectEquals(w.percentile(0.95), 0.0);
+            for (int i = 1; i <= 100; ++i) w.push((double)i);
+            expectEquals(w.percentile(0.95), 95.0);
+            expectEquals(w.percentile(0.99), 99.0);
+            // Oldest samples roll out once the window is full
+            for (int i = 0; i < FrameTimeWindow::capacity; ++i) w.push(1.0);
+            expectEquals(w.size(), FrameTimeWindow::capacity);
+            expectEquals(w.percentile(0.99), 1.0);
+        }
+
+        beginTest("A single stall drops the scale on the same frame");
+        {
+            AdaptiveQualityController aq;
+            aq.setTargetFps(60.0);
+            for (int i = 0; i < 30; ++i)
+                aq.evaluateFrame(8.0, 0.0);
+            expectEquals(aq.getCurrentScale(), 1.0);
+            const auto d = aq.evaluateFrame(500.0, 0.0);
+            expect(d.changed);
+            expectEquals(d.suggestedScale, AdaptiveQualityController::minScale);
+        }
+
+        beginTest("Recovery from minimum scale takes a fraction of a second");
+        {
+            AdaptiveQualityController aq;
+            aq.setTargetFps(60.0);
+            aq.setQualityMode(QualityMode::Low);
+            aq.evaluateFrame(1.0, 0.0);
+            expectEquals(aq.getCurrentScale(), 0.5);
+            aq.setQualityMode(QualityMode::Auto);
+            int frames = 0;
+            while (aq.getCurrentScale() < 1.0 && frames < 600)
+            {
+                // Cheap frames: render cost proportional to pixel count, 6 ms at full scale
+                const double s = aq.getCurrentScale();
+                aq.evaluateFrame(6.0 * s * s, 0.0);
+                ++frames;
+            }
+            expectEquals(aq.getCurrentScale(), 1.0);
+            expect(frames <= 30, "took " + juce::String(frames) + " frames");
+        }
+
+        beginTest("Ladder settles where p95 meets the target load");
+        {
+            // Full-resolution frame costs 25 ms against a 16.7 ms budget
+            AdaptiveQualityController aq;
+            aq.setTargetFps(60.0);
+            const double budget = 1000.0 / 60.0;
+            double minSeen = 1.0, maxSeen = 0.0;
+            for (int i = 0; i < 600; ++i)
+            {
+                const double s = aq.getCurrentScale();
+                aq.evaluateFrame(25.0 * s * s, 0.0);
+                if (i >= 300) { minSeen = juce::jmin(minSeen, aq.getCurrentScale()); maxSeen = juce::jmax(maxSeen, aq.getCurrentScale()); }
+            }
+            const double s = aq.getCurrentScale();
+            expect(25.0 * s * s <= budget, "settled cost " + juce::String(25.0 * s * s, 2) + " ms");
+            expect(25.0 * s * s >= AdaptiveQualityController::headroomLoad * budget);
+            // Stable once settled: no oscillation
+            expectEquals(minSeen, maxSeen);
+        }
+
+        beginTest("Manual override applies immediately and ignores frame times");
+        {
+            AdaptiveQualityController aq;
+            aq.setQualityMode(QualityMode::Medium);
+            auto d = aq.evaluateFrame(1000.0, 100.0);
+            expectEquals(d.suggestedScale, 0.75);
+            expect(d.changed);
+            d = aq.evaluateFrame(1000.0, 100.0);
+            expect(! d.changed);
+        }
+
+        beginTest("Policy decides which dimension gives way first");
+        {
+            // Full quality costs twice the 60 fps budget
+            for (auto policy : { QualityPolicy::PreferSmoothness, QualityPolicy::PreferSharpness })
+            {
+                AdaptiveQualityController aq;
+                aq.setTargetFps(60.0);
+                aq.setPolicy(policy);
+                for (int i = 0; i < 600; ++i)
+                    aq.evaluateFrame(33.0 * aq.getCurrentProfile().relativeFrameCost(), 0.0);
+                const auto& p = aq.getCurrentProfile();
+                expect(33.0 * p.relativeFrameCost() <= p.budgetMs());
+                if (policy == QualityPolicy::PreferSmoothness)
+                {
+                    expectEquals(p.targetFps, 60.0);
+                    expect(p.resolutionScale < 1.0);
+                }
+                else
+                {
+                    expect(p.targetFps < 60.0);
+                    expectEquals(p.resolutionScale, 1.0);
+                }
+            }
+        }
+
+        beginTest("Rungs never exceed the user frame rate");
+        {
+            for (auto policy : { QualityPolicy::PreferSmoothness, QualityPolicy::PreferSharpness })
+            {
+                const auto ladder = AdaptiveQualityController::buildLadder(policy, 40.0);
+                for (size_t i = 0; i < ladder.size(); ++i)
+                {
+                    expect(ladder[i].targetFps <= 40.0);
+                    if (i > 0) expect(ladder[i] != ladder[i - 1]);
+                }
+                // Top rung keeps projectM's default mesh; the cheapest one coarsens it
+                expectEquals(ladder.front().meshWidth * ladder.front().meshHeight, 32 * 24);
+                expect(ladder.back().meshWidth * ladder.back().meshHeight < 32 * 24);
+                // Each step down must actually be cheaper per second
+                for (size_t i = 1; i < ladder.size(); ++i)
+                    expect(ladder[i].relativeFrameCost() * ladder[i].targetFps
+                           < ladder[i - 1].relativeFrameCost() * ladder[i - 1].targetFps);
+            }
+        }
+
+        beginTest("Under a budget cap, rungs are costed at the scale they really render at");
+        {
+            // The coordinator caps the scale at 0.5, so every rung renders at 0.5 or below
+            const double cap = 0.5;
+            auto cappedCost = [cap](QualityProfile p) {
+                p.resolutionScale = juce::jmin(p.resolutionScale, cap);
+                return p.relativeFrameCost();
+            };
+            // Light load: full effects fit at the capped scale, so it climbs back to the top rung
+            {
+                AdaptiveQualityController aq;
+                aq.setTargetFps(60.0);
+                aq.setQualityMode(QualityMode::Low);
+                aq.evaluateFrame(1.0, 0.0);
+                aq.setQualityMode(QualityMode::Auto);
+                AdaptiveQualityController::Decision d;
+                for (int i = 0; i < 600; ++i)
+                {
+                    aq.setScaleCap(cap);
+                    d = aq.evaluateFrame(40.0 * cappedCost(aq.getCurrentProfile()), 0.0);
+                }
+                expectEquals(aq.getCurrentRung(), 0);
+                expectEquals(d.suggestedScale, cap, "The suggested scale is the one applied");
+            }
+            // Heavy load: settles on the best rung that fits and holds the frame rate
+            {
+                AdaptiveQualityController aq;
+                aq.setTargetFps(60.0);
+                int changes = 0;
+                for (int i = 0; i < 600; ++i)
+                {
+                    aq.setScaleCap(cap);
+                    const auto d = aq.evaluateFrame(80.0 * cappedCost(aq.getCurrentProfile()), 0.0);
+                    if (i >= 300 && d.changed) ++changes;
+                }
+                const auto& p = aq.getCurrentProfile();
+                expectEquals(changes, 0);
+                expectEquals(p.targetFps, 60.0);
+                expect(80.0 * cappedCost(p) <= p.budgetMs());
+                expect(80.0 * cappedCost(p) <= AdaptiveQualityController::targetLoad * p.budgetMs());
+                expectEquals(p.effectsTier, 0, "Only the cheapest 60 fps rung fits the target load");
+            }
+        }
+
+        beginTest("Swap interval pacing follows the display's refresh rate");
+        {
+            struct Case { double target, refresh; int interval; double fps; };
+            for (const Case c : { Case{ 60, 60, 1, 60 }, Case{ 45, 60, 1, 60 }, Case{ 30, 60, 2, 30 },
+                                  Case{ 60, 144, 2, 72 }, Case{ 45, 144, 3, 48 }, Case{ 30, 144, 4, 36 },
+                                  Case{ 30, 120, 4, 30 }, Case{ 60, 59.94, 1, 59.94 },
+                                  Case{ 30, 0, 2, 30 },     // refresh rate unknown: 60 Hz assumed
+                                  Case{ 15, 240, 8, 30 } }) // interval capped
+            {
+                const auto p = swapPacingFor(c.target, c.refresh);
+                expectEquals(p.interval, c.interval);
+                expectWithinAbsoluteError(p.fps, c.fps, 1.0e-9);
+                expect(p.fps >= juce::jmin(c.target, 30.0), "Never paced below the rung unless capped");
+            }
+        }
+
+        beginTest("Converges without oscillation under a noisy synthetic load");
+        {
+            juce::Random rng(1234);
+            for (auto policy : { QualityPolicy::PreferSmoothness, QualityPolicy::PreferSharpness })
+            {
+                for (double fullCostMs : { 12.0, 20.0, 30.0, 45.0 })
+                {
+                    AdaptiveQualityController aq;
+                    aq.setTargetFps(60.0);
+                    aq.setPolicy(policy);
+                    int changesLate = 0;
+                    for (int i = 0; i < 1200; ++i)
+                    {
+                        const double jitter = 0.9 + 0.2 * rng.nextDouble(); // +-10%
+                        const auto d = aq.evaluateFrame(fullCostMs * aq.getCurrentProfile().relativeFrameCost() * jitter, 0.0);
+                        if (i >= 600 && d.changed) ++changesLate;
+                    }
+                    expectEquals(changesLate, 0, "policy " + juce::String((int)policy) + ", cost " + juce::String(fullCostMs));
+                    const auto& p = aq.getCurrentProfile();
+                    const bool lastRung = aq.getCurrentRung() == (int)AdaptiveQualityController::buildLadder(policy, 60.0).size() - 1;
+                    expect(lastRung || fullCostMs * 1.1 * p.relativeFrameCost() <= p.budgetMs());
+                }
+            }
+        }
+    }
+};
+
+static AdaptiveQualityTests adaptiveQualityTests;
@@ -0,0 +1,162 @@
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include "../src/AudioAnalyzer.h"
+#include "../src/AnalysisKernels.h"
+#include "../src/SimdDispatch.h"
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+ #define MDW_BENCH_HAS_TSC 1
+#else
+ #define MDW_BENCH_HAS_TSC 0
+#endif
+
+using namespace milkdawp;
+
+namespace {
+// TSC cycles where available, otherwise nanoseconds from the high-resolution clock
+inline juce::int64 readCycleCounter() noexcept
+{
+   #if MDW_BENCH_HAS_TSC
+    return (juce::int64)__rdtsc();
+   #else
+    return (juce::int64)(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks()) * 1.0e9);
+   #endif
+}
+} // namespace
+
+// Benchmarks are registered under the "Benchmark" category and skipped by the default
+// test run; use `MilkDAWp_tests --benchmarks` to run them.
+class AnalysisBenchmarks : public juce::UnitTest {
+public:
+    AnalysisBenchmarks() : juce::UnitTest("AnalysisBenchmarks", "Benchmark") {}
+
+    void runTest() override
+    {
+        beginTest("Analysis cost per second of audio at 44.1/96/192 kHz");
+        for (double hostRate : { 44100.0, 96000.0, 192000.0 })
+        {
+            struct NullQueue {
+                int pushed = 0;
+                bool tryPush(const AudioAnalysisSnapshot&) { ++pushed; return true; }
+            } q;
+
+            AudioAnalyzer analyzer;
+            analyzer.prepare(hostRate);
+
+            constexpr int blockSize = 512;
+            std::vector<float> left(blockSize), right(blockSize);
+            juce::Random rng(1234);
+            for (int n = 0; n < blockSize; ++n) { left[(size_t)n] = rng.nextFloat() - 0.5f; right[(size_t)n] = rng.nextFloat() - 0.5f; }
+
+            const int seconds = 10;
+            const int blocks = (int)(hostRate * seconds / blockSize);
+            const auto t0 = juce::Time::getHighResolutionTicks();
+            for (int b = 0; b < blocks; ++b)
+                analyzer.process(left.data(), right.data(), blockSize, q);
+            const auto t1 = juce::Time::getHighResolutionTicks();
+
+            const double ms = juce::Time::highResolutionTicksToSeconds(t1 - t0) * 1000.0;
+            logMessage(juce::String(hostRate, 0) + " Hz: " + juce::String(ms / seconds, 3)
+                       + " ms per audio second, " + juce::String(q.pushed / seconds) + " snapshots/s"
+                       + " (decimation x" + juce::String(analyzer.getDecimationFactor()) + ")");
+            expectGreaterThan(q.pushed, 0);
+        }
+
+        beginTest("Cycles per hop: fused analysis kernel vs three-pass path");
+        {
+            constexpr int size = AudioAnalysisSnapshot::fftSize;
+            constexpr int hops = 2000;
+            juce::dsp::FFT fft(AudioAnalysisSnapshot::fftOrder);
+            juce::dsp::WindowingFunction<float> window(size, juce::dsp::WindowingFunction<float>::hann, true);
+            std::vector<float> mono((size_t)size), buf((size_t)size * 2);
+            juce::Random rng(42);
+            for (auto& x : mono) x = rng.nextFloat() * 2.0f - 1.0f;
+
+            // Previous path: copy, window, zero-fill, full FFT, separate energy loop
+            float sink = 0.0f;
+            auto t0 = readCycleCounter();
+            for (int h = 0; h < hops; ++h)
+            {
+                for (int n = 0; n < size; ++n) buf[(size_t)n] = mono[(size_t)n];
+                window.multiplyWithWindowingTable(buf.data(), (size_t)size);
+                std::fill(buf.begin() + size, buf.end(), 0.0f);
+                fft.performRealOnlyForwardTransform(buf.data());
+                float energy = 0.0f;
+                for (int n = 0; n < size; ++n) energy += mono[(size_t)n] * mono[(size_t)n];
+                sink += energy;
+            }
+            const double legacy = (double)(readCycleCounter() - t0) / hops;
+
+            // Fused path: windowed copy + energy + peak, half-spectrum FFT, band sweep
+            std::array<float, AudioAnalysisSnapshot::numBands> bands{};
+            t0 = readCycleCounter();
+            for (int h = 0; h < hops; ++h)
+            {
+                const auto ep = AnalysisKernels::windowedCopyEnergyPeak(mono.data(), AnalysisKernels::hannTable(), buf.data(), size);
+                fft.performRealOnlyForwardTransform(buf.data(), true);
+                AnalysisKernels::bandMagnitudes(buf.data(), bands.data());
+                sink += ep.energy + bands[0];
+            }
+            const double fused = (double)(readCycleCounter() - t0) / hops;
+
+            const juce::String unit = MDW_BENCH_HAS_TSC ? " cycles/hop" : " ns/hop";
+            logMessage("three-pass: " + juce::String(legacy, 0) + unit + ", fused: " + juce::String(fused, 0) + unit
+                       + " (sink " + juce::String(sink, 1) + ")");
+            expectGreaterThan(fused, 0.0);
+        }
+
+        beginTest("Cycles per GL frame: projectM int16 PCM conversion");
+        {
+            // One GL frame of new audio at 48 kHz / 60 fps, interleaved stereo
+            constexpr int samples = 800 * 2;
+            constexpr int frames = 20000;
+            std::vector<float> pcm((size_t)samples);
+            std::vector<int16_t> out((size_t)samples);
+            juce::Random rng(7);
+            for (auto& x : pcm) x = rng.nextFloat() * 2.4f - 1.2f;
+
+            // Previous path: per-sample clamp, libm round, clamp
+            juce::int64 sink = 0;
+            auto t0 = readCycleCounter();
+            for (int f = 0; f < frames; ++f)
+            {
+                for (int i = 0; i < samples; ++i)
+                {
+                    const float v = juce::jlimit(-1.0f, 1.0f, pcm[(size_t)i]);
+                    out[(size_t)i] = (int16_t)juce::jlimit(-32767L, 32767L, std::lround(v * 32767.0f));
+                }
+                sink += out[(size_t)(f % samples)];
+            }
+            const double legacy = (double)(readCycleCounter() - t0) / frames;
+
+            const auto& k = simd::active();
+            t0 = readCycleCounter();
+            for (int f = 0; f < frames; ++f)
+            {
+                k.floatToInt16(pcm.data(), out.data(), samples);
+                sink += out[(size_t)(f % samples)];
+            }
+            const double vec = (double)(readCycleCounter() - t0) / frames;
+
+            t0 = readCycleCounter();
+            for (int f = 0; f < frames; ++f)
+            {
+                k.scrubPcm(pcm.data(), samples);
+                sink += (juce::int64)pcm[(size_t)(f % samples)];
+            }
+            const double scrub = (double)(readCycleCounter() - t0) / frames;
+
+            const juce::String unit = MDW_BENCH_HAS_TSC ? " cycles/frame" : " ns/frame";
+            logMessage("scalar jlimit/lround: " + juce::String(legacy, 0) + unit + ", " + juce::String(k.name)
+                       + " floatToInt16: " + juce::String(vec, 0) + unit + ", scrubPcm: " + juce::String(scrub, 0) + unit
+                       + " (sink " + juce::String(sink) + ")");
+            expectGreaterThan(vec, 0.0);
+        }
+    }
+};
+
+static AnalysisBenchmarks analysisBenchmarks;
@@ -0,0 +1,60 @@
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include "../src/AnalysisKernels.h"
+
+using namespace milkdawp;
+
+class AnalysisKernelsTests : public juce::UnitTest {
+public:
+    AnalysisKernelsTests() : juce::UnitTest("AnalysisKernelsTests", "core") {}
+
+    void runTest() override
+    {
+        constexpr int size = AudioAnalysisSnapshot::fftSize;
+
+        beginTest("Fused windowed copy matches separate window/energy/peak passes");
+        {
+            std::vector<float> src((size_t)size), fused((size_t)size), ref((size_t)size);
+            juce::Random rng(7);
+            for (auto& x : src) x = rng.nextFloat() * 2.0f - 1.0f;
+            src[100] = -1.5f; // known peak
+
+            const auto ep = AnalysisKernels::windowedCopyEnergyPeak(src.data(), AnalysisKernels::hannTable(), fused.data(), size);
+
+            juce::dsp::WindowingFunction<float> window((size_t)size, juce::dsp::WindowingFunction<float>::hann, true);
+            ref = src;
+            window.multiplyWithWindowingTable(ref.data(), (size_t)size);
+            double energy = 0.0;
+            for (auto x : src) energy += (double)x * x;
+            energy /= size;
+
+            for (int n = 0; n < size; ++n)
+                expectWithinAbsoluteError(fused[(size_t)n], ref[(size_t)n], 1.0e-6f);
+            expectWithinAbsoluteError((double)ep.energy, energy, 1.0e-4);
+            expectEquals(ep.peak, 1.5f);
+        }
+
+        beginTest("Band magnitudes place a sine in the expected octave");
+        {
+            // Bin 48 falls in band 4 (bins 32..63)
+            std::vector<float> src((size_t)size), buf((size_t)size * 2);
+            for (int n = 0; n < size; ++n)
+                src[(size_t)n] = 0.5f * (float)std::sin(2.0 * juce::MathConstants<double>::pi * 48.0 * n / size);
+
+            juce::dsp::FFT fft(AudioAnalysisSnapshot::fftOrder);
+            AnalysisKernels::windowedCopyEnergyPeak(src.data(), AnalysisKernels::hannTable(), buf.data(), size);
+            fft.performRealOnlyForwardTransform(buf.data(), true);
+
+            std::array<float, AudioAnalysisSnapshot::numBands> bands{};
+            AnalysisKernels::bandMagnitudes(buf.data(), bands.data());
+
+            for (int b = 0; b < AudioAnalysisSnapshot::numBands; ++b)
+            {
+                if (b == 4) expectGreaterThan(bands[(size_t)b], 0.4f);
+                else        expectLessThan(bands[(size_t)b], 0.01f);
+            }
+        }
+    }
+};
+
+static AnalysisKernelsTests analysisKernelsTests;
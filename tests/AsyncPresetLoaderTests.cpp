@@ -0,0 +1,129 @@
+#include <juce_core/juce_core.h>
+#include "../src/AsyncPresetLoader.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace milkdawp;
+
+namespace {
+juce::File writeTempPreset(const juce::String& name, size_t bytes)
+{
+    auto f = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile(name);
+    std::string text = "[preset00]\nfRating=3.0\n";
+    for (size_t i = 0; text.size() < bytes; ++i)
+        text += "per_frame_" + std::to_string(i) + "=wave_r = 0.5 + 0.5*sin(time*1.13);\n";
+    f.replaceWithText(juce::String(text));
+    return f;
+}
+
+bool waitReady(AsyncPresetLoader& loader, AsyncPresetLoader::Loaded& out)
+{
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (loader.takeReady(out)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+} // namespace
+
+class AsyncPresetLoaderTests : public juce::UnitTest {
+public:
+    AsyncPresetLoaderTests() : juce::UnitTest("AsyncPresetLoaderTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Loads file contents off-thread and hands them over once");
+        {
+            const auto f = writeTempPreset("mdw_loader_a.milk", 4096);
+            AsyncPresetLoader loader;
+            const auto gen = loader.request(f.getFullPathName());
+            expect(loader.isPending());
+            AsyncPresetLoader::Loaded got;
+            expect(waitReady(loader, got));
+            expect(got.ok);
+            expectEquals(got.generation, gen);
+            expect(got.path == f.getFullPathName());
+            expect(got.data == f.loadFileAsString().toStdString());
+            expect(! loader.isPending());
+            expect(! loader.takeReady(got)); // nothing new
+            f.deleteFile();
+        }
+
+        beginTest("Latest request wins");
+        {
+            std::vector<juce::File> files;
+            for (int i = 0; i < 6; ++i)
+                files.push_back(writeTempPreset("mdw_loader_" + juce::String(i) + ".milk", 64 * 1024));
+            AsyncPresetLoader loader;
+            for (auto& f : files) loader.request(f.getFullPathName());
+            AsyncPresetLoader::Loaded got;
+            expect(waitReady(loader, got));
+            expect(got.path == files.back().getFullPathName());
+            expect(! loader.takeReady(got));
+            for (auto& f : files) f.deleteFile();
+        }
+
+        beginTest("Missing file is reported, not hung on");
+        {
+            AsyncPresetLoader loader;
+            loader.request("/nonexistent/dir/preset.milk");
+            AsyncPresetLoader::Loaded got;
+            expect(waitReady(loader, got));
+            expect(! got.ok);
+            expect(got.data.empty());
+        }
+    }
+};
+
+static AsyncPresetLoaderTests asyncPresetLoaderTests;
+
+// Benchmark category (run with --benchmarks): worst frame time of a 60 fps consumer loop while
+// switching presets, reading the file on the render thread vs taking it from the loader.
+class AsyncPresetLoaderBenchmarks : public juce::UnitTest {
+public:
+    AsyncPresetLoaderBenchmarks() : juce::UnitTest("AsyncPresetLoaderBenchmarks", "Benchmark") {}
+
+    void runTest() override
+    {
+        beginTest("Worst-case frame time during preset switches");
+        std::vector<juce::File> files;
+        for (int i = 0; i < 8; ++i)
+            files.push_back(writeTempPreset("mdw_loader_bench_" + juce::String(i) + ".milk", 2 * 1024 * 1024));
+
+        constexpr int frames = 240, switchEvery = 15;
+        auto frameLoop = [&](bool async) {
+            AsyncPresetLoader loader;
+            AsyncPresetLoader::Loaded slot;
+            double worst = 0.0;
+            size_t sink = 0;
+            for (int f = 0; f < frames; ++f)
+            {
+                const double t0 = juce::Time::getMillisecondCounterHiRes();
+                if (f % switchEvery == 0)
+                {
+                    const auto& file = files[(size_t)(f / switchEvery) % files.size()];
+                    if (async) loader.request(file.getFullPathName());
+                    else sink += file.loadFileAsString().toStdString().size();
+                }
+                if (async && loader.takeReady(slot))
+                    sink += slot.data.size();
+                const double dt = juce::Time::getMillisecondCounterHiRes() - t0;
+                worst = juce::jmax(worst, dt);
+                std::this_thread::sleep_for(std::chrono::microseconds(16667));
+            }
+            return std::make_pair(worst, sink);
+        };
+
+        const auto sync = frameLoop(false);
+        const auto async = frameLoop(true);
+        logMessage("worst frame during switches: render-thread read " + juce::String(sync.first, 3)
+                   + " ms, async loader " + juce::String(async.first, 3) + " ms (2 MB presets, sink "
+                   + juce::String((juce::int64)(sync.second + async.second)) + ")");
+        expectGreaterThan(sync.second, (size_t)0);
+        for (auto& f : files) f.deleteFile();
+    }
+};
+
+static AsyncPresetLoaderBenchmarks asyncPresetLoaderBenchmarks;
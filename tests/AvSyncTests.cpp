@@ -0,0 +1,220 @@
+#include <juce_core/juce_core.h>
+#include "../src/AvSync.h"
+#include "../src/AudioAnalyzer.h"
+#include <cmath>
+#include <vector>
+
+using namespace milkdawp;
+
+namespace {
+struct CollectingQueue {
+    std::vector<AudioAnalysisSnapshot> items;
+    bool tryPush(const AudioAnalysisSnapshot& s) { items.push_back(s); return true; }
+};
+} // namespace
+
+class AvSyncTests : public juce::UnitTest {
+public:
+    AvSyncTests() : juce::UnitTest("AvSyncTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Audio clock filters jittery block timestamps");
+        {
+            // 512-sample blocks at 48 kHz; the audio device actually runs 0.05% fast and the
+            // host wakes the callback up to +/-2 ms late or early
+            const double sr = 48000.0, actualRate = sr * 1.0005;
+            const int block = 512;
+            juce::Random rng(1234);
+            AudioClock clock;
+            uint64_t pos = 0;
+            double maxErr = 0.0;
+            for (int b = 0; b < 4000; ++b)
+            {
+                const double trueTime = 10.0 + (double)pos / actualRate;
+                const double jitter = (rng.nextDouble() * 2.0 - 1.0) * 0.002;
+                clock.update(pos, trueTime + jitter, block, sr);
+                pos += (uint64_t)block;
+                if (b > 2000)
+                {
+                    const auto st = clock.read();
+                    const double probe = (double)pos + 256.0;
+                    const double err = std::abs(AudioClock::sampleToTime(st, probe) - (10.0 + probe / actualRate));
+                    maxErr = juce::jmax(maxErr, err);
+                }
+            }
+            const auto st = clock.read();
+            expect(st.valid);
+            // Filtered error well below the raw jitter; the rate estimate stays near the device rate
+            expect(maxErr < 0.001, "max error " + juce::String(maxErr * 1000.0, 3) + " ms");
+            expectWithinAbsoluteError(1.0 / st.secondsPerSample, actualRate, actualRate * 1.0e-3);
+            expectWithinAbsoluteError(st.blockSeconds, (double)block / sr, 1.0e-9);
+            // Round trip
+            expectWithinAbsoluteError(AudioClock::timeToSample(st, AudioClock::sampleToTime(st, 123456.0)), 123456.0, 1.0e-3);
+        }
+
+        beginTest("Audio clock restarts on a position discontinuity");
+        {
+            AudioClock clock;
+            expect(! clock.read().valid);
+            clock.update(0, 1.0, 256, 48000.0);
+            clock.update(256, 1.0 + 256.0 / 48000.0, 256, 48000.0);
+            // Transport jump: the new block is anchored at its own timestamp
+            clock.update(1000000, 5.0, 256, 48000.0);
+            const auto st = clock.read();
+            expectEquals(st.n0, 1000000.0);
+            expectEquals(st.t0, 5.0);
+            clock.reset();
+            expect(! clock.read().valid);
+        }
+
+        beginTest("Snapshot history picks the snapshot being heard");
+        {
+            SnapshotHistory h;
+            AudioAnalysisSnapshot out;
+            expect(! h.pick(0.0, out));
+            for (int i = 0; i < 40; ++i)
+            {
+                AudioAnalysisSnapshot s;
+                s.samplePosition = (uint64_t)i * 1024;
+                s.windowLength = 1024;
+                s.shortTimeEnergy = (float)i;
+                h.push(s);
+            }
+            expectEquals(h.size(), SnapshotHistory::capacity);
+            // Window centre of snapshot i is i * 1024 + 512
+            expect(h.pick(30 * 1024 + 512, out));
+            expectEquals(out.shortTimeEnergy, 30.0f);
+            expect(h.pick(30 * 1024 + 511, out));
+            expectEquals(out.shortTimeEnergy, 29.0f);
+            // Target past the newest: newest; before the oldest retained: oldest
+            h.pick(1.0e9, out);
+            expectEquals(out.shortTimeEnergy, 39.0f);
+            h.pick(0.0, out);
+            expectEquals(out.shortTimeEnergy, 8.0f);
+
+            // Position going backwards (analyzer re-prepared) drops the stale entries
+            AudioAnalysisSnapshot s;
+            s.samplePosition = 0;
+            s.windowLength = 1024;
+            s.shortTimeEnergy = 100.0f;
+            h.push(s);
+            expectEquals(h.size(), 1);
+        }
+
+        beginTest("Interpolation blends features between bracketing snapshots");
+        {
+            SnapshotHistory h;
+            for (int i = 0; i < 4; ++i)
+            {
+                AudioAnalysisSnapshot s;
+                s.samplePosition = (uint64_t)i * 1024;
+                s.windowLength = 1024;
+                s.shortTimeEnergy = (float)i;
+                s.peak = 2.0f * (float)i;
+                s.beatEnvelope = i == 2 ? 1.0f : 0.0f;
+                s.bands.fill(10.0f * (float)i);
+                h.push(s);
+            }
+            AudioAnalysisSnapshot out;
+            // A quarter of the way from the centre of snapshot 1 (1536) to snapshot 2 (2560)
+            expect(h.interpolate(1536.0 + 256.0, out));
+            expectWithinAbsoluteError(out.shortTimeEnergy, 1.25f, 1.0e-6f);
+            expectWithinAbsoluteError(out.peak, 2.5f, 1.0e-6f);
+            expectWithinAbsoluteError(out.beatEnvelope, 0.25f, 1.0e-6f);
+            expectWithinAbsoluteError(out.bands[3], 12.5f, 1.0e-5f);
+            expectEquals((int)out.samplePosition, 1024 + 256);
+            // Exactly on a centre returns that snapshot's values
+            h.interpolate(2560.0, out);
+            expectEquals(out.shortTimeEnergy, 2.0f);
+            // Outside the retained range clamps to the ends
+            h.interpolate(0.0, out);
+            expectEquals(out.shortTimeEnergy, 0.0f);
+            h.interpolate(1.0e9, out);
+            expectEquals(out.shortTimeEnergy, 3.0f);
+
+            // Frames rendered at 144 Hz between 46.9 Hz snapshots see a monotonic ramp, not a step
+            float prev = -1.0f;
+            bool monotonic = true;
+            for (double pos = 512.0; pos <= 3584.0; pos += 48000.0 / 144.0)
+            {
+                h.interpolate(pos, out);
+                monotonic = monotonic && out.shortTimeEnergy > prev;
+                prev = out.shortTimeEnergy;
+            }
+            expect(monotonic);
+        }
+
+        beginTest("Small host buffers still interpolate between snapshots");
+        {
+            // 64-sample host blocks at 48 kHz with 1024-sample analysis windows; the energy of
+            // snapshot g is g, so smooth motion is a strictly rising value on every 144 Hz frame
+            const double sr = 48000.0, frameSec = 1.0 / 144.0;
+            const int block = 64;
+            const uint32_t span = 1024;
+            AudioClock clock;
+            SnapshotHistory h;
+            juce::Random rng(99);
+            uint64_t nextSnapshot = 0;
+            double nextFrame = 0.0, prev = -1.0;
+            int frames = 0, rising = 0, pastNewest = 0;
+            for (uint64_t pos = 0; pos < (uint64_t)sr * 3; pos += (uint64_t)block)
+            {
+                const double blockTime = (double)pos / sr;
+                clock.update(pos, blockTime + (rng.nextDouble() - 0.5) * 0.0005, block, sr);
+                for (; (nextSnapshot + 1) * span <= pos + (uint64_t)block; ++nextSnapshot)
+                {
+                    AudioAnalysisSnapshot s;
+                    s.samplePosition = nextSnapshot * span;
+                    s.windowLength = span;
+                    s.shortTimeEnergy = (float)nextSnapshot;
+                    h.push(s);
+                }
+                for (; nextFrame < blockTime + (double)block / sr; nextFrame += frameSec)
+                {
+                    if (nextFrame < 1.0) continue; // clock settling
+                    const auto cs = clock.read();
+                    AudioAnalysisSnapshot out;
+                    expect(h.interpolate(h.targetPosition(cs, nextFrame, 0.0), out));
+                    // Where the heard position alone would land
+                    if (AudioClock::timeToSample(cs, nextFrame - cs.blockSeconds) > SnapshotHistory::centreOf(h.newest()))
+                        ++pastNewest;
+                    ++frames;
+                    if (out.shortTimeEnergy > prev) ++rising;
+                    prev = out.shortTimeEnergy;
+                }
+            }
+            expect(pastNewest > frames / 2, "Without the hold-back most frames would repeat the newest snapshot");
+            expectEquals(rising, frames);
+
+            // Buffers of 1.5 windows or more need no hold-back
+            AudioClock big;
+            big.update(0, 1.0, 2048, sr);
+            const auto cs = big.read();
+            expectWithinAbsoluteError(h.targetPosition(cs, 1.1, 0.0), AudioClock::timeToSample(cs, 1.1 - cs.blockSeconds), 1.0e-6);
+        }
+
+        beginTest("Analyzer beat envelope fires on an energy onset and decays");
+        {
+            AudioAnalyzer analyzer;
+            analyzer.prepare(48000.0);
+            CollectingQueue q;
+            std::vector<float> quiet(1024, 0.05f), loud(1024, 0.5f);
+            for (int b = 0; b < 60; ++b)
+                analyzer.process(quiet.data(), quiet.data(), 1024, q);
+            // Any start-up onset (energy rising from silence) has decayed by now
+            expect(q.items.back().beatEnvelope < 0.01f);
+
+            const size_t onset = q.items.size();
+            analyzer.process(loud.data(), loud.data(), 1024, q);
+            for (int b = 0; b < 4; ++b)
+                analyzer.process(quiet.data(), quiet.data(), 1024, q);
+            expect(q.items.size() == onset + 5);
+            expectEquals(q.items[onset].beatEnvelope, 1.0f);
+            for (size_t i = onset + 1; i < q.items.size(); ++i)
+                expect(q.items[i].beatEnvelope < q.items[i - 1].beatEnvelope && q.items[i].beatEnvelope > 0.0f);
+        }
+    }
+};
+
+static AvSyncTests avSyncTests;
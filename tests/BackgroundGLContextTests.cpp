@@ -0,0 +1,36 @@
+#include <juce_core/juce_core.h>
+#include "../src/BackgroundGLContext.h"
+
+using namespace milkdawp;
+
+// The shared contexts themselves need a window system and a driver (WGL, GLX); what runs
+// anywhere is the path every caller must survive: no canvas context current on this thread.
+class BackgroundGLContextTests : public juce::UnitTest {
+public:
+    BackgroundGLContextTests() : juce::UnitTest("BackgroundGLContextTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Without a current GL context, creation fails and leaves nothing behind");
+        {
+            BackgroundGLContext ctx;
+            expect(! ctx.create());
+            expect(ctx.nativeHandle() == nullptr);
+            expect(! ctx.makeCurrentOnCurrentDrawable());
+            ctx.destroy();
+            ctx.destroy();
+            expect(ctx.nativeHandle() == nullptr);
+        }
+
+        beginTest("Only platforms whose canvas contexts can join the share group offer a render host");
+        {
+           #if defined(_WIN32) || defined(__linux__)
+            expect(BackgroundGLContext::sharesWithCanvas);
+           #else
+            expect(! BackgroundGLContext::sharesWithCanvas);
+           #endif
+        }
+    }
+};
+
+static BackgroundGLContextTests backgroundGLContextTests;
@@ -0,0 +1,235 @@
+#include <juce_core/juce_core.h>
+#include "../src/FrameCapture.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace milkdawp;
+
+namespace {
+// A w x h frame whose every byte encodes its index, so torn or mixed-up copies show
+std::vector<uint8_t> patternFrame(int w, int h, uint64_t index)
+{
+    std::vector<uint8_t> px((size_t)w * 4 * (size_t)h);
+    for (size_t i = 0; i < px.size(); ++i)
+        px[i] = (uint8_t)((index * 31u + i) & 0xff);
+    return px;
+}
+
+CapturedFrameView viewOf(const std::vector<uint8_t>& px, int w, int h, uint64_t index)
+{
+    CapturedFrameView v;
+    v.pixels = px.data();
+    v.width = w;
+    v.height = h;
+    v.stride = w * 4;
+    v.frameIndex = index;
+    v.timestampMs = 1000.0 + (double)index * 16.0;
+    return v;
+}
+
+bool matchesPattern(const CaptureFrameQueue::Frame& f)
+{
+    const auto expected = patternFrame(f.width, f.height, f.frameIndex);
+    return f.pixels == expected;
+}
+
+struct CountingSink : FrameCaptureSink {
+    void deliver(const CapturedFrameView& v) override { ++frames; lastIndex = v.frameIndex; }
+    int frames = 0;
+    uint64_t lastIndex = 0;
+};
+
+// Records what the worker delivers, and on which thread; blocks while `gate` is closed
+struct WorkerSink : FrameCaptureSink {
+    void deliver(const CapturedFrameView& v) override
+    {
+        while (! gate.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        std::lock_guard<std::mutex> lock(mutex);
+        thread = std::this_thread::get_id();
+        width = v.width;
+        height = v.height;
+        firstPixel = *reinterpret_cast<const uint32_t*>(v.row(0));
+        frames.fetch_add(1, std::memory_order_release);
+    }
+    std::atomic<bool> gate{ true };
+    std::atomic<int> frames{ 0 };
+    std::mutex mutex;
+    std::thread::id thread;
+    int width = 0, height = 0;
+    uint32_t firstPixel = 0;
+};
+
+bool waitFor(const std::atomic<int>& n, int count)
+{
+    for (int i = 0; i < 2000 && n.load(std::memory_order_acquire) < count; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return n.load(std::memory_order_acquire) >= count;
+}
+} // namespace
+
+class FrameCaptureTests : public juce::UnitTest {
+public:
+    FrameCaptureTests() : juce::UnitTest("FrameCaptureTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Bus delivers to every registered sink and reports when it has none");
+        {
+            FrameCaptureBus bus;
+            CountingSink a, b;
+            expect(! bus.hasSinks());
+            bus.addSink(&a);
+            bus.addSink(&b);
+            bus.addSink(&a);
+            expect(bus.hasSinks());
+            const auto px = patternFrame(4, 2, 7);
+            bus.deliver(viewOf(px, 4, 2, 7));
+            expectEquals(a.frames, 1);
+            expectEquals(b.frames, 1);
+            bus.removeSink(&a);
+            bus.deliver(viewOf(px, 4, 2, 8));
+            expectEquals(a.frames, 1);
+            expectEquals((int)b.lastIndex, 8);
+            bus.removeSink(&b);
+            expect(! bus.hasSinks());
+        }
+
+        beginTest("Queue hands frames over in order with their timestamps");
+        {
+            CaptureFrameQueue q;
+            for (uint64_t i = 1; i <= 3; ++i)
+            {
+                const auto px = patternFrame(16, 9, i);
+                q.deliver(viewOf(px, 16, 9, i));
+            }
+            for (uint64_t i = 1; i <= 3; ++i)
+            {
+                const auto* f = q.tryAcquire();
+                expect(f != nullptr);
+                if (f == nullptr) break;
+                expectEquals((int)f->frameIndex, (int)i);
+                expectEquals(f->width, 16);
+                expectEquals(f->stride, 64);
+                expectWithinAbsoluteError(f->timestampMs, 1000.0 + (double)i * 16.0, 1.0e-9);
+                expect(matchesPattern(*f));
+                q.release(f);
+            }
+            expect(q.tryAcquire() == nullptr);
+        }
+
+        beginTest("A consumer that falls behind costs dropped frames, not a blocked producer");
+        {
+            CaptureFrameQueue q;
+            const auto px = patternFrame(8, 8, 0);
+            for (uint64_t i = 1; i <= 10; ++i)
+                q.deliver(viewOf(px, 8, 8, i));
+            expectEquals((int)q.getDeliveredFrames(), CaptureFrameQueue::poolSize);
+            expectEquals((int)q.getDroppedFrames(), 10 - CaptureFrameQueue::poolSize);
+
+            const auto* held = q.tryAcquire();
+            expect(held != nullptr);
+            q.release(held);
+            q.deliver(viewOf(px, 8, 8, 11));
+            expectEquals((int)q.getDroppedFrames(), 10 - CaptureFrameQueue::poolSize);
+        }
+
+        beginTest("Frames cross threads intact");
+        {
+            CaptureFrameQueue q;
+            constexpr int w = 64, h = 36, total = 2000;
+            std::atomic<bool> done{ false };
+            int received = 0, intact = 0;
+            uint64_t lastIndex = 0;
+            bool ordered = true;
+            std::thread consumer([&] {
+                for (;;)
+                {
+                    const bool finished = done.load(std::memory_order_acquire);
+                    if (const auto* f = q.tryAcquire())
+                    {
+                        ++received;
+                        if (matchesPattern(*f)) ++intact;
+                        if (f->frameIndex <= lastIndex) ordered = false;
+                        lastIndex = f->frameIndex;
+                        q.release(f);
+                    }
+                    else if (finished)
+                        break;
+                    else
+                        std::this_thread::yield();
+                }
+            });
+            for (uint64_t i = 1; i <= (uint64_t)total; ++i)
+            {
+                const auto px = patternFrame(w, h, i);
+                q.deliver(viewOf(px, w, h, i));
+            }
+            done.store(true, std::memory_order_release);
+            consumer.join();
+            expectEquals(received, (int)q.getDeliveredFrames());
+            expectEquals(intact, received);
+            expectEquals((int)(q.getDeliveredFrames() + q.getDroppedFrames()), total);
+            expect(ordered);
+        }
+
+        beginTest("Worker runs the sinks off the producer thread and scales to the output size");
+        {
+            FrameCaptureBus bus;
+            WorkerSink sink;
+            bus.addSink(&sink);
+            FrameCaptureWorker worker;
+            std::vector<uint8_t> px(8 * 4 * 4);
+            for (size_t i = 0; i < px.size(); i += 4)
+                px[i] = px[i + 1] = px[i + 2] = px[i + 3] = 0x80; // flat grey survives any filter
+
+            worker.submit(bus, viewOf(px, 8, 4, 1));
+            expect(waitFor(sink.frames, 1));
+            {
+                std::lock_guard<std::mutex> lock(sink.mutex);
+                expect(sink.thread != std::this_thread::get_id());
+                expectEquals(sink.width, 8);
+                expectEquals(sink.height, 4);
+            }
+
+            // A HiDPI drawable is twice the logical size: CPU frames come out at the drawable's
+            worker.setOutputSize(16, 8);
+            worker.submit(bus, viewOf(px, 8, 4, 2));
+            expect(waitFor(sink.frames, 2));
+            {
+                std::lock_guard<std::mutex> lock(sink.mutex);
+                expectEquals(sink.width, 16);
+                expectEquals(sink.height, 8);
+                expectEquals((int64_t)(sink.firstPixel & 0xffffffu), (int64_t)0x808080); // scaled frames come out opaque
+            }
+            worker.stop();
+            bus.removeSink(&sink);
+        }
+
+        beginTest("A stalled sink costs the worker's frames, never the producer's time");
+        {
+            FrameCaptureBus bus;
+            WorkerSink sink;
+            sink.gate.store(false);
+            bus.addSink(&sink);
+            FrameCaptureWorker worker;
+            const auto px = patternFrame(64, 36, 0);
+            const int total = 50;
+            const double start = juce::Time::getMillisecondCounterHiRes();
+            for (uint64_t i = 1; i <= (uint64_t)total; ++i)
+                worker.submit(bus, viewOf(px, 64, 36, i));
+            const double elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+            expect(elapsed < 250.0, "submit waited on the sink: " + juce::String(elapsed, 1) + " ms");
+            expect(worker.getDroppedFrames() > 0);
+            expectEquals((int)(worker.getSubmittedFrames() + worker.getDroppedFrames()), total);
+
+            sink.gate.store(true, std::memory_order_release);
+            expect(waitFor(sink.frames, 1));
+            worker.stop();
+            bus.removeSink(&sink);
+        }
+    }
+};
+
+static FrameCaptureTests frameCaptureTests;
@@ -0,0 +1,137 @@
+#include <juce_core/juce_core.h>
+#include "../src/GpuFrameTimer.h"
+#include <map>
+
+using namespace milkdawp;
+
+namespace {
+// Stand-in for a driver: a query's result becomes available gpuLatency ticks after it ended,
+// and measures 1 ms per tick it was open
+struct FakeTimerGl {
+    struct Query { int begunAt = -1, endedAt = -1; };
+    static inline std::map<unsigned int, Query> queries;
+    static inline unsigned int nextId = 1;
+    static inline unsigned int activeId = 0;
+    static inline int now = 0;
+    static inline int gpuLatency = 2;
+    static inline int resultReadsWhileBusy = 0; // GL_QUERY_RESULT read before available (a stall)
+
+    static void reset() { queries.clear(); nextId = 1; activeId = 0; now = 0; gpuLatency = 2; resultReadsWhileBusy = 0; }
+
+    static void genQueries(int n, unsigned int* ids) { for (int i = 0; i < n; ++i) { ids[i] = nextId++; queries[ids[i]] = {}; } }
+    static void deleteQueries(int n, const unsigned int* ids) { for (int i = 0; i < n; ++i) queries.erase(ids[i]); }
+    static void beginQuery(unsigned int, unsigned int id) { activeId = id; queries[id] = { now, -1 }; }
+    static void endQuery(unsigned int) { queries[activeId].endedAt = now; activeId = 0; }
+    static bool available(unsigned int id) { const auto& q = queries[id]; return q.endedAt >= 0 && now >= q.endedAt + gpuLatency; }
+    static void getQueryObjectuiv(unsigned int id, unsigned int, unsigned int* out) { *out = available(id) ? 1u : 0u; }
+    static void getQueryObjectui64v(unsigned int id, unsigned int, uint64_t* out)
+    {
+        if (! available(id)) ++resultReadsWhileBusy;
+        const auto& q = queries[id];
+        *out = (uint64_t)(q.endedAt - q.begunAt) * 1000000ull;
+    }
+
+    static GpuTimerApi api()
+    {
+        return GpuTimerApi::resolve([](const char* name) -> void* {
+            const juce::String n(name);
+            if (n == "glGenQueries") return (void*)&genQueries;
+            if (n == "glDeleteQueries") return (void*)&deleteQueries;
+            if (n == "glBeginQuery") return (void*)&beginQuery;
+            if (n == "glEndQuery") return (void*)&endQuery;
+            if (n == "glGetQueryObjectuiv") return (void*)&getQueryObjectuiv;
+            if (n == "glGetQueryObjectui64v") return (void*)&getQueryObjectui64v;
+            return nullptr;
+        });
+    }
+};
+} // namespace
+
+class GpuFrameTimerTests : public juce::UnitTest {
+public:
+    GpuFrameTimerTests() : juce::UnitTest("GpuFrameTimerTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Results arrive a few frames late, in order, without waiting on the GPU");
+        {
+            FakeTimerGl::reset();
+            GpuTimerRing ring;
+            expect(ring.create(FakeTimerGl::api()));
+            std::vector<std::pair<uint64_t, double>> got;
+            for (uint64_t frame = 1; frame <= 10; ++frame)
+            {
+                ring.collect([&](uint64_t id, double ms) { got.emplace_back(id, ms); });
+                expect(ring.begin(frame));
+                FakeTimerGl::now += (int)(frame % 3) + 1; // frame cost 1..3 ms
+                ring.end();
+            }
+            expectEquals(FakeTimerGl::resultReadsWhileBusy, 0);
+            expect(got.size() >= 7, "Results keep flowing with a short GPU latency");
+            for (size_t i = 0; i < got.size(); ++i)
+            {
+                expectEquals((int)got[i].first, (int)i + 1);
+                expectWithinAbsoluteError(got[i].second, (double)(got[i].first % 3) + 1.0, 1.0e-9);
+            }
+            ring.destroy();
+            expect(FakeTimerGl::queries.empty(), "Queries are deleted with the ring");
+        }
+
+        beginTest("A GPU that falls behind drops timed frames instead of stalling");
+        {
+            FakeTimerGl::reset();
+            FakeTimerGl::gpuLatency = 100;
+            GpuTimerRing ring;
+            expect(ring.create(FakeTimerGl::api()));
+            int timed = 0, delivered = 0;
+            for (uint64_t frame = 1; frame <= 12; ++frame)
+            {
+                delivered += ring.collect([](uint64_t, double) {});
+                if (ring.begin(frame)) { ++timed; FakeTimerGl::now += 1; ring.end(); }
+                else FakeTimerGl::now += 1;
+            }
+            expectEquals(timed, GpuTimerRing::depth);
+            expectEquals(delivered, 0);
+            expectEquals((int)ring.getSkippedFrames(), 12 - GpuTimerRing::depth);
+            expectEquals(FakeTimerGl::resultReadsWhileBusy, 0);
+
+            FakeTimerGl::now += 100;
+            expectEquals(ring.collect([](uint64_t, double) {}), GpuTimerRing::depth);
+            expect(ring.begin(13), "Timing resumes once results were read");
+            ring.end();
+        }
+
+        beginTest("Missing entry points leave the ring unusable");
+        {
+            auto api = FakeTimerGl::api();
+            api.getQueryObjectui64v = nullptr;
+            GpuTimerRing ring;
+            expect(! ring.create(api));
+            expect(! ring.begin(1));
+            expectEquals(ring.collect([](uint64_t, double) {}), 0);
+        }
+
+        beginTest("Parts timed in two contexts add up per frame");
+        {
+            GpuFrameTimeAccumulator acc;
+            double total = 0.0;
+            acc.close(1, 2);
+            acc.close(2, 1);
+            expect(! acc.add(1, 3.0, total));
+            expect(acc.add(2, 0.5, total));
+            expectWithinAbsoluteError(total, 0.5, 1.0e-12);
+            expect(acc.add(1, 1.25, total));
+            expectWithinAbsoluteError(total, 4.25, 1.0e-12);
+
+            // Frame 3 loses a part; it is pushed out by frame 3 + capacity and its late part ignored
+            acc.close(3, 2);
+            expect(! acc.add(3, 2.0, total));
+            acc.close(3 + GpuFrameTimeAccumulator::capacity, 1);
+            expect(! acc.add(3, 2.0, total));
+            expect(acc.add(3 + GpuFrameTimeAccumulator::capacity, 1.0, total));
+            expectWithinAbsoluteError(total, 1.0, 1.0e-12);
+        }
+    }
+};
+
+static GpuFrameTimerTests gpuFrameTimerTests;
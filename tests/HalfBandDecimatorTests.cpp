@@ -0,0 +1,97 @@
+#include <juce_core/juce_core.h>
+#include "../src/HalfBandDecimator.h"
+#include "../src/AudioAnalyzer.h"
+#include <cmath>
+
+using namespace milkdawp;
+
+namespace {
+// RMS gain in dB of a sine pushed through a decimator prepared for hostRate
+double measureGainDb(double hostRate, double freq)
+{
+    AnalysisDecimator d;
+    d.prepare(hostRate);
+    const int total = (int)hostRate; // 1 s of input
+    const int settle = 256;          // skip filter warm-up
+    double acc = 0.0;
+    int produced = 0, counted = 0;
+    for (int i = 0; i < total; ++i)
+    {
+        const float x = (float)std::sin(2.0 * juce::MathConstants<double>::pi * freq * i / hostRate);
+        float y;
+        if (d.push(x, y) && ++produced > settle) { acc += (double)y * y; ++counted; }
+    }
+    return 10.0 * std::log10(juce::jmax(1.0e-30, acc / juce::jmax(1, counted) / 0.5));
+}
+
+struct CountingQueue {
+    int pushed = 0;
+    AudioAnalysisSnapshot last{};
+    bool tryPush(const AudioAnalysisSnapshot& s) { ++pushed; last = s; return true; }
+};
+} // namespace
+
+class HalfBandDecimatorTests : public juce::UnitTest {
+public:
+    HalfBandDecimatorTests() : juce::UnitTest("HalfBandDecimatorTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Stage count brings host rate into the fixed analysis range");
+        {
+            const double rates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0, 384000.0 };
+            const int stages[]   = { 0,       0,       1,       1,       2,        2,        3 };
+            for (int i = 0; i < 7; ++i)
+            {
+                AnalysisDecimator d;
+                d.prepare(rates[i]);
+                expectEquals(d.getNumStages(), stages[i]);
+                expect(d.getOutputRate() >= 44100.0 && d.getOutputRate() <= 48000.0, "Output rate out of range");
+            }
+        }
+
+        beginTest("Unity DC gain and flat passband up to 16 kHz");
+        {
+            AnalysisDecimator d;
+            d.prepare(96000.0);
+            float y = 0.0f;
+            for (int i = 0; i < 512; ++i) d.push(1.0f, y);
+            expectWithinAbsoluteError(y, 1.0f, 1.0e-4f);
+
+            for (double f : { 100.0, 1000.0, 10000.0, 16000.0 })
+            {
+                expectWithinAbsoluteError(measureGainDb(96000.0, f), 0.0, 0.05);
+                expectWithinAbsoluteError(measureGainDb(192000.0, f), 0.0, 0.05);
+            }
+        }
+
+        beginTest("Content above the analysis Nyquist is rejected");
+        {
+            expectLessThan(measureGainDb(96000.0, 30000.0), -60.0);
+            expectLessThan(measureGainDb(96000.0, 40000.0), -60.0);
+            expectLessThan(measureGainDb(192000.0, 60000.0), -60.0);
+            expectLessThan(measureGainDb(192000.0, 80000.0), -60.0);
+        }
+
+        beginTest("Snapshot rate is constant across host sample rates");
+        {
+            for (double hostRate : { 48000.0, 96000.0, 192000.0 })
+            {
+                AudioAnalyzer analyzer;
+                analyzer.prepare(hostRate);
+                CountingQueue q;
+                std::vector<float> block(512, 0.25f);
+                const int blocks = (int)(hostRate / 512.0); // ~1 s
+                for (int b = 0; b < blocks; ++b)
+                    analyzer.process(block.data(), block.data(), (int)block.size(), q);
+
+                // 48000 / 1024 = 46.875 snapshots per second regardless of host rate
+                expectWithinAbsoluteError(q.pushed, 46, 1);
+                expectEquals(q.last.analysisRate, 48000.0);
+                expectWithinAbsoluteError(q.last.shortTimeEnergy, 0.0625f, 1.0e-3f);
+            }
+        }
+    }
+};
+
+static HalfBandDecimatorTests halfBandDecimatorTests;
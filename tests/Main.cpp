@@ -1,10 +1,25 @@
 #include <juce_core/juce_core.h>
 
-int main (int, char**)
+int main (int argc, char** argv)
 {
     juce::UnitTestRunner runner;
-    // Run all registered tests; report to stdout
-    runner.runAllTests();
+
+    // Benchmarks are opt-in: `--benchmarks` runs only the "Benchmark" category,
+    // the default run covers every other category.
+    bool benchmarks = false;
+    for (int i = 1; i < argc; ++i)
+        if (juce::String(argv[i]) == "--benchmarks")
+            benchmarks = true;
+
+    if (benchmarks) {
+        runner.runTestsInCategory("Benchmark");
+    } else {
+        juce::Array<juce::UnitTest*> tests;
+        for (auto* t : juce::UnitTest::getAllTests())
+            if (t->getCategory() != "Benchmark")
+                tests.add(t);
+        runner.runTests(tests);
+    }
 
     int totalFailures = 0;
     for (int i = 0; i < runner.getNumResults(); ++i) {
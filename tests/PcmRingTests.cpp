@@ -0,0 +1,165 @@
+#include <juce_core/juce_core.h>
+#include "../src/PcmRing.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace milkdawp;
+
+class PcmRingTests : public juce::UnitTest {
+public:
+    PcmRingTests() : juce::UnitTest("PcmRingTests", "core") {}
+
+    // Frame i carries (i, -i); exact in float up to 2^24
+    static void pushRamp(PcmRing& ring, uint64_t& next, int frames, std::vector<float>& scratch)
+    {
+        scratch.resize((size_t)frames * 2);
+        for (int i = 0; i < frames; ++i)
+        {
+            scratch[(size_t)i * 2 + 0] = (float)(next + (uint64_t)i);
+            scratch[(size_t)i * 2 + 1] = -(float)(next + (uint64_t)i);
+        }
+        ring.pushInterleaved(scratch.data(), frames);
+        next += (uint64_t)frames;
+    }
+
+    // Checks that out continues the ramp at expected; returns false on the first gap or repeat
+    static bool continuesRamp(const float* out, int frames, uint64_t& expected)
+    {
+        for (int i = 0; i < frames; ++i, ++expected)
+            if (out[(size_t)i * 2] != (float)expected || out[(size_t)i * 2 + 1] != -(float)expected)
+                return false;
+        return true;
+    }
+
+    void runTest() override
+    {
+        beginTest("readNew hands out every frame exactly once");
+        {
+            PcmRing ring;
+            ring.init(16384);
+            PcmRing::ReadCursor cursor;
+            std::vector<float> scratch, out(4096 * 2);
+            uint64_t next = 0, expected = 0;
+            pushRamp(ring, next, 100, scratch);
+            // Attaching skips what was written before the reader existed
+            expectEquals(ring.readNew(cursor, out.data(), 4096), 0);
+            expected = next;
+
+            juce::Random rng(42);
+            bool ok = true;
+            for (int iter = 0; iter < 2000 && ok; ++iter)
+            {
+                // Blocks straddle the ring end; reads sometimes take less than is available
+                pushRamp(ring, next, 1 + rng.nextInt(700), scratch);
+                const int got = ring.readNew(cursor, out.data(), 1 + rng.nextInt(1200));
+                ok = continuesRamp(out.data(), got, expected);
+            }
+            while (ok)
+            {
+                const int got = ring.readNew(cursor, out.data(), 512);
+                if (got == 0) break;
+                ok = continuesRamp(out.data(), got, expected);
+            }
+            expect(ok, "gap or duplicate before frame " + juce::String((juce::int64)expected));
+            expectEquals((juce::int64)expected, (juce::int64)next);
+            expectEquals((juce::int64)cursor.droppedFrames, (juce::int64)0);
+        }
+
+        beginTest("A reader that falls behind skips ahead and counts the drop");
+        {
+            PcmRing ring;
+            ring.init(1000);
+            PcmRing::ReadCursor cursor;
+            std::vector<float> scratch, out(1000 * 2);
+            uint64_t next = 0;
+            ring.readNew(cursor, out.data(), 1000);
+            pushRamp(ring, next, 1700, scratch);
+            const int got = ring.readNew(cursor, out.data(), 1000);
+            expectEquals(got, 500);
+            expectEquals((juce::int64)cursor.droppedFrames, (juce::int64)1200);
+            uint64_t expected = 1200;
+            expect(continuesRamp(out.data(), got, expected));
+        }
+
+        beginTest("copyLatest returns the newest window, zero-padded at start-up");
+        {
+            PcmRing ring;
+            ring.init(256);
+            std::vector<float> scratch, win;
+            uint64_t next = 0;
+            pushRamp(ring, next, 10, scratch);
+            ring.copyLatest(16, win);
+            expectEquals((int)win.size(), 32);
+            expectEquals(win[0], 0.0f);
+            uint64_t expected = 0;
+            expect(continuesRamp(win.data() + 12, 10, expected));
+            pushRamp(ring, next, 600, scratch);
+            ring.copyLatest(300, win);
+            expected = next - 256; // clamped to the ring capacity
+            expect(continuesRamp(win.data(), 256, expected));
+        }
+
+        beginTest("Planar push interleaves and duplicates mono");
+        {
+            PcmRing ring;
+            ring.init(64);
+            PcmRing::ReadCursor cursor;
+            float out[8 * 2];
+            ring.readNew(cursor, out, 8);
+            const float l[4] = { 1, 2, 3, 4 }, r[4] = { -1, -2, -3, -4 };
+            ring.pushPlanar(l, r, 4);
+            ring.pushPlanar(l, nullptr, 2);
+            ring.pushPlanar(nullptr, nullptr, 2);
+            expectEquals(ring.readNew(cursor, out, 8), 8);
+            expectEquals(out[2], 2.0f);
+            expectEquals(out[3], -2.0f);
+            expectEquals(out[10], 2.0f);
+            expectEquals(out[11], 2.0f);
+            expectEquals(out[14], 0.0f);
+        }
+
+        beginTest("Concurrent writer and reader: no frame fed twice or skipped");
+        {
+            PcmRing ring;
+            ring.init(8192);
+            constexpr uint64_t total = 400000;
+            std::atomic<uint64_t> readerPos{ 0 };
+            std::atomic<bool> attached{ false }, failed{ false };
+
+            std::thread writer([&]
+            {
+                while (! attached.load()) std::this_thread::yield();
+                std::vector<float> scratch;
+                uint64_t next = 0;
+                juce::Random rng(7);
+                while (next < total && ! failed.load())
+                {
+                    // Stay within a quarter ring of the reader so no drop is legitimate
+                    if (next - readerPos.load(std::memory_order_acquire) > 2048) { std::this_thread::yield(); continue; }
+                    pushRamp(ring, next, (int)juce::jmin<uint64_t>(total - next, (uint64_t)(1 + rng.nextInt(480))), scratch);
+                }
+            });
+
+            PcmRing::ReadCursor cursor;
+            std::vector<float> out(1024 * 2);
+            ring.readNew(cursor, out.data(), 1024);
+            attached.store(true);
+            uint64_t expected = 0;
+            bool ok = true;
+            while (ok && expected < total)
+            {
+                const int got = ring.readNew(cursor, out.data(), 1024);
+                ok = continuesRamp(out.data(), got, expected);
+                readerPos.store(expected, std::memory_order_release);
+            }
+            failed.store(! ok);
+            writer.join();
+            expect(ok, "gap or duplicate before frame " + juce::String((juce::int64)expected));
+            expectEquals((juce::int64)expected, (juce::int64)total);
+            expectEquals((juce::int64)cursor.droppedFrames, (juce::int64)0);
+        }
+    }
+};
+
+static PcmRingTests pcmRingTests;
@@ -0,0 +1,71 @@
+#include <juce_core/juce_core.h>
+#include "../src/PresetBenchReport.h"
+
+using namespace milkdawp;
+
+class PresetBenchReportTests : public juce::UnitTest {
+public:
+    PresetBenchReportTests() : juce::UnitTest("PresetBenchReportTests", "core") {}
+
+    static PresetBenchResult make(const juce::String& path, double loadMs, double firstMs, std::vector<double> frames)
+    {
+        PresetBenchResult r;
+        r.path = path;
+        r.loaded = true;
+        r.loadMs = loadMs;
+        r.firstFrameMs = firstMs;
+        PresetBenchReport::setSteadyFrames(r, frames);
+        return r;
+    }
+
+    void runTest() override
+    {
+        beginTest("Nearest-rank percentiles");
+        {
+            std::vector<double> v;
+            for (int i = 100; i >= 1; --i) v.push_back((double)i);
+            expectEquals(PresetBenchReport::percentile(v, 50.0), 50.0);
+            expectEquals(PresetBenchReport::percentile(v, 99.0), 99.0);
+            expectEquals(PresetBenchReport::percentile(v, 100.0), 100.0);
+            expectEquals(PresetBenchReport::percentile({ 7.0 }, 99.0), 7.0);
+            expectEquals(PresetBenchReport::percentile({}, 50.0), 0.0);
+        }
+
+        beginTest("Worst offenders first, failed loads at the top");
+        {
+            std::vector<PresetBenchResult> results;
+            results.push_back(make("calm.milk", 2.0, 3.0, { 4.0, 4.0, 5.0 }));
+            results.push_back(make("hitchy.milk", 40.0, 90.0, { 4.0, 4.0, 5.0 }));     // switch hitch 130
+            results.push_back(make("heavy.milk", 2.0, 3.0, { 30.0, 35.0, 200.0 }));   // p99 200
+            PresetBenchResult broken;
+            broken.path = "broken.milk";
+            broken.error = "parse error";
+            results.push_back(broken);
+            PresetBenchReport::sortWorstFirst(results);
+            expect(results[0].path == "broken.milk");
+            expect(results[1].path == "heavy.milk");
+            expect(results[2].path == "hitchy.milk");
+            expect(results[3].path == "calm.milk");
+            expectEquals(results[1].maxMs, 200.0);
+            expectEquals(results[2].switchHitchMs(), 130.0);
+        }
+
+        beginTest("CSV and JSON escape paths and errors");
+        {
+            std::vector<PresetBenchResult> results;
+            results.push_back(make("a, \"quoted\".milk", 1.5, 2.25, { 3.0 }));
+            results.back().error = "line\nbreak";
+            results.back().warmUpMs = 12.5;
+            const auto csv = PresetBenchReport::toCsv(results);
+            expect(csv.startsWith("path,loaded,load_ms,first_frame_ms,switch_hitch_ms,warm_up_ms,p50_ms,p99_ms,max_ms,frames,error\n"));
+            expect(csv.contains("\"a, \"\"quoted\"\".milk\",1,1.500,2.250,3.750,12.500,3.000,3.000,3.000,1,\"line\nbreak\"\n"));
+            const auto json = PresetBenchReport::toJson(results);
+            expect(json.contains("\"path\": \"a, \\\"quoted\\\".milk\""));
+            expect(json.contains("\"error\": \"line\\nbreak\""));
+            expect(json.contains("\"switch_hitch_ms\": 3.750"));
+            expect(json.contains("\"warm_up_ms\": 12.500"));
+        }
+    }
+};
+
+static PresetBenchReportTests presetBenchReportTests;
@@ -0,0 +1,97 @@
+#include <juce_core/juce_core.h>
+#include "../src/PresetCostProfile.h"
+
+using namespace milkdawp;
+
+class PresetCostProfileTests : public juce::UnitTest {
+public:
+    PresetCostProfileTests() : juce::UnitTest("PresetCostProfileTests", "core") {}
+
+    void runTest() override
+    {
+        auto& profile = PresetCostProfile::instance();
+        const juce::String heavy = "/tmp/cost_profile_unit_test_heavy.milk";
+        const juce::String light = "/tmp/cost_profile_unit_test_light.milk";
+        const juce::Time stamp(1700000000000LL);
+        const QualityProfile top;
+
+        beginTest("Records normalise to the top rung and are keyed by file version");
+        {
+            profile.clear();
+            PresetCostProfile::Entry e;
+            expect(! profile.lookup(heavy, stamp, e), "Nothing recorded yet");
+
+            // 10 ms measured at half resolution is ~40 ms at full resolution
+            QualityProfile half;
+            half.resolutionScale = 0.5;
+            profile.record(heavy, stamp, 10.0, half);
+            expect(profile.lookup(heavy, stamp, e));
+            expectWithinAbsoluteError(e.frameMs, 40.0, 1.0e-9);
+            expectEquals(e.samples, 1);
+            expectWithinAbsoluteError(profile.projectedMs(heavy, stamp, half), 10.0, 1.0e-9);
+
+            expect(! profile.lookup(heavy, juce::Time(stamp.toMilliseconds() + 1000), e),
+                   "A different modification time must not match");
+        }
+
+        beginTest("Repeated windows are smoothed; a new file version restarts the entry");
+        {
+            profile.clear();
+            profile.record(light, stamp, 4.0, top);
+            profile.record(light, stamp, 8.0, top);
+            PresetCostProfile::Entry e;
+            expect(profile.lookup(light, stamp, e));
+            expectEquals(e.samples, 2);
+            expect(e.frameMs > 4.0 && e.frameMs < 8.0, "EMA lies between the samples");
+
+            const juce::Time edited(stamp.toMilliseconds() + 5000);
+            profile.record(light, edited, 2.0, top);
+            expect(profile.lookup(light, edited, e));
+            expectEquals(e.samples, 1);
+            expectWithinAbsoluteError(e.frameMs, 2.0, 1.0e-9);
+            expect(! profile.lookup(light, stamp, e));
+        }
+
+        beginTest("Budget check projects onto the current rung; unknown presets pass");
+        {
+            profile.clear();
+            profile.record(heavy, stamp, 24.0, top);  // over a 60 fps budget at full scale
+            profile.record(light, stamp, 6.0, top);
+            expect(profile.exceedsBudget(heavy, stamp, top));
+            expect(! profile.exceedsBudget(light, stamp, top));
+            expect(! profile.exceedsBudget("/tmp/never_measured.milk", stamp, top));
+
+            QualityProfile low; // half scale at 30 fps: 24 * 0.25 = 6 ms against 33 ms
+            low.resolutionScale = 0.5;
+            low.targetFps = 30.0;
+            expect(! profile.exceedsBudget(heavy, stamp, low));
+            expect(profile.exceedsBudget(heavy, juce::Time(), top) == false, "Stale entries never exclude");
+        }
+
+        beginTest("Table round-trips through disk");
+        {
+            const auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                  .getChildFile("milkdawp_preset_cost_unit_test.tsv");
+            profile.clear();
+            profile.record(heavy, stamp, 24.0, top);
+            profile.record(light, stamp, 6.0, top);
+            expect(profile.save(file));
+
+            profile.clear();
+            expectEquals(profile.size(), 0);
+            expect(profile.load(file));
+            expectEquals(profile.size(), 2);
+            PresetCostProfile::Entry e;
+            expect(profile.lookup(heavy, stamp, e));
+            expectWithinAbsoluteError(e.frameMs, 24.0, 1.0e-3);
+
+            file.replaceWithText("not a cost table\n");
+            expect(! profile.load(file), "Foreign files are rejected");
+            expectEquals(profile.size(), 2);
+            file.deleteFile();
+            profile.clear();
+        }
+    }
+};
+
+static PresetCostProfileTests presetCostProfileTests;
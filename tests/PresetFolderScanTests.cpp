@@ -0,0 +1,53 @@
+#include <juce_core/juce_core.h>
+#include "../src/PresetFolderScan.h"
+
+using namespace milkdawp;
+
+class PresetFolderScanTests : public juce::UnitTest {
+public:
+    PresetFolderScanTests() : juce::UnitTest("PresetFolderScanTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Ignore entries: comments and blanks dropped, lower-cased");
+        {
+            juce::StringArray entries;
+            PresetFolderScan::addIgnoreEntries("# heavy presets\n\n  Flexi - Crash.milk  \n*martin*\nflexi - crash.milk\n", entries);
+            expectEquals(entries.size(), 2);
+            expect(entries.contains("flexi - crash.milk"));
+            expect(entries.contains("*martin*"));
+        }
+
+        beginTest("Wildcards match the whole name, plain entries match substrings");
+        {
+            juce::StringArray entries;
+            PresetFolderScan::addIgnoreEntries("*martin*\ngeiss\nexact.milk\n", entries);
+            expect(PresetFolderScan::isIgnored("Martin - Blue Haze.milk", entries));
+            expect(PresetFolderScan::isIgnored("Geiss - Cosmic Dust.milk", entries));
+            expect(PresetFolderScan::isIgnored("EXACT.milk", entries));
+            expect(! PresetFolderScan::isIgnored("Flexi - Mindblob.milk", entries));
+            expect(! PresetFolderScan::isIgnored("anything.milk", {}));
+        }
+
+        beginTest("Folder scan filters and sorts like the playlist");
+        {
+            auto dir = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("mdw_scan_test");
+            dir.deleteRecursively();
+            dir.createDirectory();
+            for (auto* name : { "b.milk", "A.milk", "skip me.milk", "c.txt" })
+                dir.getChildFile(name).replaceWithText("[preset00]\n");
+            dir.getChildFile(".milkignore").replaceWithText("# blacklist\nskip\n");
+            const auto files = PresetFolderScan::scan(dir);
+            expectEquals(files.size(), 2);
+            if (files.size() == 2)
+            {
+                expect(files[0].getFileName() == "A.milk");
+                expect(files[1].getFileName() == "b.milk");
+            }
+            expectEquals(PresetFolderScan::scan(dir.getChildFile("missing")).size(), 0);
+            dir.deleteRecursively();
+        }
+    }
+};
+
+static PresetFolderScanTests presetFolderScanTests;
@@ -0,0 +1,143 @@
+#include <juce_core/juce_core.h>
+#include "../src/PresetPrefetcher.h"
+#include "../src/AsyncPresetLoader.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace milkdawp;
+
+namespace {
+juce::File writePrefetchPreset(const juce::String& name)
+{
+    auto f = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile(name);
+    f.replaceWithText("[preset00]\nfRating=3.0\nper_frame_1=wave_r = 0.5 + 0.5*sin(time*1.13);\n// " + name + "\n");
+    return f;
+}
+
+bool waitCached(const PresetPrefetcher& pf, const juce::String& path)
+{
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (pf.isCached(path)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+} // namespace
+
+class PresetPrefetcherTests : public juce::UnitTest {
+public:
+    PresetPrefetcherTests() : juce::UnitTest("PresetPrefetcherTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Upcoming presets are read ahead and their metadata published");
+        {
+            const auto a = writePrefetchPreset("mdw_prefetch_a.milk");
+            const auto b = writePrefetchPreset("mdw_prefetch_b.milk");
+            PresetPrefetcher pf;
+            pf.prefetch({ a.getFullPathName(), b.getFullPathName() });
+            expect(waitCached(pf, a.getFullPathName()));
+            expect(waitCached(pf, b.getFullPathName()));
+
+            SharedAssetCache::PresetMeta meta;
+            expect(SharedAssetCache::instance().getPresetMeta(a.getFullPathName(), meta));
+            expectEquals(meta.paletteIndex, SharedAssetCache::derivePaletteIndex(meta.name));
+
+            std::string data;
+            expect(pf.take(a.getFullPathName(), data));
+            expect(data == a.loadFileAsString().toStdString());
+            expect(! pf.isCached(a.getFullPathName()));     // consumed
+            expect(! pf.take(a.getFullPathName(), data));
+            a.deleteFile();
+            b.deleteFile();
+        }
+
+        beginTest("The preset being switched to survives the next prefetch");
+        {
+            std::vector<juce::File> files;
+            for (int i = 0; i < 5; ++i)
+                files.push_back(writePrefetchPreset("mdw_prefetch_" + juce::String(i) + ".milk"));
+            PresetPrefetcher pf(3);
+            pf.prefetch({ files[0].getFullPathName(), files[1].getFullPathName() });
+            expect(waitCached(pf, files[1].getFullPathName()));
+            // Switch to files[0] is under way; the playlist already schedules the ones after it
+            pf.prefetch({ files[1].getFullPathName(), files[2].getFullPathName() });
+            expect(waitCached(pf, files[2].getFullPathName()));
+            expect(pf.isCached(files[0].getFullPathName()));
+            // Over capacity, entries that are no longer upcoming go first
+            pf.prefetch({ files[3].getFullPathName(), files[4].getFullPathName() });
+            expect(waitCached(pf, files[4].getFullPathName()));
+            expect(! pf.isCached(files[0].getFullPathName()));
+            expect(pf.isCached(files[3].getFullPathName()));
+            for (auto& f : files) f.deleteFile();
+        }
+
+        beginTest("More upcoming presets than fit: the nearest are read and stay");
+        {
+            std::vector<juce::File> files;
+            juce::StringArray paths;
+            for (int i = 0; i < 4; ++i)
+            {
+                files.push_back(writePrefetchPreset("mdw_prefetch_over_" + juce::String(i) + ".milk"));
+                paths.add(files.back().getFullPathName());
+            }
+            PresetPrefetcher pf(2);
+            pf.prefetch(paths);
+            expect(waitCached(pf, paths[0]));
+            expect(waitCached(pf, paths[1]));
+            // Evicting a still-upcoming entry would have the worker read it again, over and over
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            expect(pf.isCached(paths[0]) && pf.isCached(paths[1]));
+            expect(! pf.isCached(paths[2]) && ! pf.isCached(paths[3]));
+            for (auto& f : files) f.deleteFile();
+        }
+
+        beginTest("Loader serves prefetched presets without touching the disk");
+        {
+            const auto a = writePrefetchPreset("mdw_prefetch_hit.milk");
+            const auto b = writePrefetchPreset("mdw_prefetch_miss.milk");
+            PresetPrefetcher pf;
+            AsyncPresetLoader loader;
+            loader.setPrefetcher(&pf);
+            pf.prefetch({ a.getFullPathName() });
+            expect(waitCached(pf, a.getFullPathName()));
+
+            auto load = [&](const juce::File& f, AsyncPresetLoader::Loaded& out)
+            {
+                loader.request(f.getFullPathName());
+                for (int i = 0; i < 2000; ++i)
+                {
+                    if (loader.takeReady(out)) return true;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                return false;
+            };
+            AsyncPresetLoader::Loaded got;
+            expect(load(a, got));
+            expect(got.ok && got.prefetched);
+            expect(got.data == a.loadFileAsString().toStdString());
+            expect(load(b, got));
+            expect(got.ok && ! got.prefetched);
+            loader.stop();
+            a.deleteFile();
+            b.deleteFile();
+        }
+
+        beginTest("Switch latency is tracked separately for hits and misses");
+        {
+            PresetPrefetcher pf;
+            pf.recordSwitch(true, 2.0);
+            pf.recordSwitch(true, 4.0);
+            pf.recordSwitch(false, 30.0);
+            const auto s = pf.getStats();
+            expectEquals((int)s.hits, 2);
+            expectEquals((int)s.misses, 1);
+            expectWithinAbsoluteError(s.avgHitMs, 2.4, 1.0e-9);
+            expectWithinAbsoluteError(s.avgMissMs, 30.0, 1.0e-9);
+        }
+    }
+};
+
+static PresetPrefetcherTests presetPrefetcherTests;
@@ -0,0 +1,70 @@
+#include <juce_core/juce_core.h>
+#include "../src/QualityBudgetCoordinator.h"
+
+using namespace milkdawp;
+
+class QualityBudgetCoordinatorTests : public juce::UnitTest {
+public:
+    QualityBudgetCoordinatorTests() : juce::UnitTest("QualityBudgetCoordinatorTests", "core") {}
+
+    void runTest() override
+    {
+        using Priority = QualityBudgetCoordinator::Priority;
+
+        beginTest("Everyone renders at full scale while the total fits the budget");
+        {
+            QualityBudgetCoordinator qb;
+            qb.setGlobalBudgetMsPerSecond(1000.0);
+            const int a = qb.registerInstance();
+            const int b = qb.registerInstance();
+            expectEquals(qb.getNumInstances(), 2);
+            // 5 ms per frame at 60 fps = 300 ms/s each
+            qb.reportFrame(a, 5.0, 1.0, 60.0);
+            qb.reportFrame(b, 5.0, 1.0, 60.0);
+            expectEquals(qb.getScaleCap(a), 1.0);
+            expectEquals(qb.getScaleCap(b), 1.0);
+        }
+
+        beginTest("Background instances are reduced first; the focused one keeps full scale");
+        {
+            QualityBudgetCoordinator qb;
+            qb.setGlobalBudgetMsPerSecond(1000.0);
+            const int focused = qb.registerInstance();
+            qb.setPriority(focused, Priority::Focused);
+            int bg[5];
+            for (auto& id : bg) id = qb.registerInstance();
+
+            // Six instances at 300 ms/s each: 1800 ms/s demand against 1000
+            qb.reportFrame(focused, 5.0, 1.0, 60.0);
+            for (auto id : bg) qb.reportFrame(id, 5.0, 1.0, 60.0);
+
+            expectEquals(qb.getScaleCap(focused), 1.0);
+            // 700 ms/s left for 1500 ms/s of background demand: s = sqrt(700 / 1500)
+            for (auto id : bg)
+                expectWithinAbsoluteError(qb.getScaleCap(id), std::sqrt(700.0 / 1500.0), 1.0e-9);
+
+            // Costs reported at a reduced scale are normalised back to full resolution
+            const double s = qb.getScaleCap(bg[0]);
+            qb.reportFrame(bg[0], 5.0 * s * s, s, 60.0);
+            expectWithinAbsoluteError(qb.getScaleCap(bg[0]), std::sqrt(700.0 / 1500.0), 1.0e-9);
+
+            // Visible instances sit between focused and background
+            qb.setPriority(bg[0], Priority::Visible);
+            expectEquals(qb.getScaleCap(bg[0]), 1.0);
+            expect(qb.getScaleCap(bg[1]) < std::sqrt(700.0 / 1500.0));
+
+            // Budgets never push anyone below the floor
+            qb.setGlobalBudgetMsPerSecond(1.0);
+            expectEquals(qb.getScaleCap(bg[1]), QualityBudgetCoordinator::minCap);
+
+            // Closing the other instances returns the budget
+            qb.setGlobalBudgetMsPerSecond(1000.0);
+            for (auto id : bg) qb.unregisterInstance(id);
+            expectEquals(qb.getNumInstances(), 1);
+            expectEquals(qb.getScaleCap(focused), 1.0);
+            expectEquals(qb.getScaleCap(12345), 1.0); // unknown ids are uncapped
+        }
+    }
+};
+
+static QualityBudgetCoordinatorTests qualityBudgetCoordinatorTests;
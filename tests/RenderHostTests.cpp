@@ -0,0 +1,351 @@
+#include <juce_core/juce_core.h>
+#include "../src/RenderHost.h"
+#include <functional>
+#include <map>
+#include <set>
+
+using namespace milkdawp;
+
+namespace {
+// Stand-in for the driver: hands out the lowest free object names (as drivers tend to, so a
+// released texture's name comes back), and remembers which blit each fence followed and
+// whether the GPU was made to wait on it
+struct FakeHostGl {
+    struct Fence { bool alive = true; bool waited = false; unsigned int readTex = 0; };
+    static inline std::set<unsigned int> names;
+    static inline std::map<unsigned int, unsigned int> texOfFbo;
+    static inline std::map<uintptr_t, Fence> fences;
+    static inline uintptr_t nextFence = 1;
+    static inline unsigned int lastBlitTex = 0;
+    static inline int allocations = 0;
+    static inline int levelsBuilt = 0;
+    static inline int waitsOnDeletedFences = 0;
+    struct Blit { unsigned int tex; int level; bool attach; int srcW, srcH; };
+    static inline std::vector<Blit> blits;
+    static inline std::function<void(unsigned int)> duringBlit; // runs while a blit holds its slot
+
+    static void reset()
+    {
+        names.clear(); texOfFbo.clear(); fences.clear(); nextFence = 1; lastBlitTex = 0;
+        allocations = levelsBuilt = waitsOnDeletedFences = 0; blits.clear(); duringBlit = nullptr;
+    }
+    static unsigned int gen() { unsigned int n = 1; while (names.count(n) != 0) ++n; names.insert(n); return n; }
+    static int liveFences() { int n = 0; for (auto& f : fences) n += f.second.alive ? 1 : 0; return n; }
+    static Fence& fence(void* s) { return fences[(uintptr_t) s]; }
+
+    static void* fenceSync()
+    {
+        const uintptr_t id = nextFence++;
+        fences[id].readTex = lastBlitTex;
+        lastBlitTex = 0;
+        return (void*) id;
+    }
+    static void waitSync(void* s) { if (! fence(s).alive) ++waitsOnDeletedFences; fence(s).waited = true; }
+    static void deleteSync(void* s) { fence(s).alive = false; }
+    static void flush() {}
+    static void allocateTarget(unsigned int& fbo, unsigned int& tex, int, int)
+    {
+        if (fbo == 0) { tex = gen(); fbo = gen(); texOfFbo[fbo] = tex; }
+        ++allocations;
+    }
+    static void deleteTarget(unsigned int fbo, unsigned int tex) { names.erase(fbo); names.erase(tex); texOfFbo.erase(fbo); }
+    static void buildLevels(unsigned int, int levels) { levelsBuilt = levels; }
+    static void blitToDrawable(unsigned int& readFbo, unsigned int tex, int level, bool attach, int srcW, int srcH, int, int)
+    {
+        if (readFbo == 0) readFbo = gen();
+        blits.push_back({ tex, level, attach, srcW, srcH });
+        if (duringBlit) duringBlit(tex);
+        lastBlitTex = tex;
+    }
+    static void deleteFramebuffer(unsigned int fbo) { names.erase(fbo); }
+
+    static RenderHostGl api()
+    {
+        RenderHostGl a;
+        a.fenceSync = &fenceSync;
+        a.waitSync = &waitSync;
+        a.deleteSync = &deleteSync;
+        a.flush = &flush;
+        a.allocateTarget = &allocateTarget;
+        a.deleteTarget = &deleteTarget;
+        a.buildLevels = &buildLevels;
+        a.blitToDrawable = &blitToDrawable;
+        a.deleteFramebuffer = &deleteFramebuffer;
+        return a;
+    }
+};
+
+// Stand-in for BackgroundGLContext. sharable = false is a driver that creates the context but
+// hands out no handle a canvas context could share with.
+struct FakeContext {
+    static constexpr bool sharesWithCanvas = true;
+    static inline bool creatable = true, sharable = true;
+    static inline int destroyed = 0;
+    void* handle = nullptr;
+    bool create() { if (! creatable) return false; handle = sharable ? (void*) this : nullptr; return true; }
+    void destroy() { handle = nullptr; ++destroyed; }
+    void* nativeHandle() const { return handle; }
+    bool makeCurrentOnCurrentDrawable() { return handle != nullptr; }
+    void restorePrevious() {}
+};
+
+// A platform whose canvas contexts can't join the host's share group (macOS)
+struct FakeUnsharedPlatformContext : FakeContext {
+    static constexpr bool sharesWithCanvas = false;
+};
+
+using Host = BasicRenderHost<FakeContext>;
+
+unsigned int renderFrame(Host& host, int w, int h)
+{
+    const unsigned int fbo = host.prepareTarget(w, h);
+    host.markFrameRendered();
+    return FakeHostGl::texOfFbo[fbo];
+}
+} // namespace
+
+class RenderHostTests : public juce::UnitTest {
+public:
+    RenderHostTests() : juce::UnitTest("RenderHostTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("The host is only used where a later canvas context can join its share group");
+        {
+            using F = RenderHostFallback;
+            FakeHostGl::reset();
+            FakeContext::creatable = true;
+            FakeContext::sharable = true;
+            FakeContext::destroyed = 0;
+            {
+                BasicRenderHost<FakeUnsharedPlatformContext> mac(FakeHostGl::api());
+                expect(mac.create(false, true) == F::unsupportedPlatform);
+                expect(! mac.isCreated());
+            }
+            Host host(FakeHostGl::api());
+            expect(host.create(true, true) == F::disabled);
+            expect(host.create(false, false) == F::noFboEntryPoint);
+            expect(! host.isCreated(), "No context is created for a host that can't be used");
+
+            FakeContext::sharable = false;
+            expect(host.create(false, true) == F::noSharedContext, "A context nothing can share with is dropped");
+            expect(! host.isCreated());
+            expectEquals(FakeContext::destroyed, 1);
+            expect(! host.enter());
+
+            FakeContext::creatable = false;
+            FakeContext::sharable = true;
+            expect(host.create(false, true) == F::noSharedContext);
+
+            FakeContext::creatable = true;
+            expect(host.create(false, true) == F::none);
+            expect(host.isCreated() && host.nativeHandle() != nullptr);
+            expect(host.enter());
+            host.destroy();
+            expect(! host.isCreated());
+
+            for (auto f : { F::none, F::unsupportedPlatform, F::disabled, F::noFboEntryPoint, F::noSharedContext })
+                expect(juce::String(describeRenderHostFallback(f)) != "unknown");
+        }
+
+        beginTest("Frames rotate through the slots; projectM never draws into the presented frame");
+        {
+            FakeHostGl::reset();
+            Host host(FakeHostGl::api());
+            expect(! host.present(640, 360), "Nothing to present before the first frame");
+            unsigned int presented = 0;
+            for (int frame = 0; frame < 12; ++frame)
+            {
+                const unsigned int target = renderFrame(host, 640, 360);
+                expect(target != 0 && target != presented);
+                expect(host.present(640, 360));
+                presented = FakeHostGl::blits.back().tex;
+                expectEquals((int) presented, (int) target);
+            }
+            expectEquals(FakeHostGl::allocations, Host::frameSlots);
+            expectEquals(FakeHostGl::waitsOnDeletedFences, 0);
+
+            renderFrame(host, 320, 180);
+            expectEquals(FakeHostGl::allocations, Host::frameSlots + 1);
+            host.releasePresenter();
+            host.releaseTarget();
+        }
+
+        beginTest("A slot is drawn into again only after the GPU waited on the blits that read it");
+        {
+            FakeHostGl::reset();
+            Host host(FakeHostGl::api());
+            Host::Output mirror;
+            host.addOutput(mirror);
+            bool ordered = true;
+            for (int frame = 0; frame < 20; ++frame)
+            {
+                const unsigned int fbo = host.prepareTarget(256, 144);
+                const unsigned int target = FakeHostGl::texOfFbo[fbo];
+                for (auto& f : FakeHostGl::fences)
+                    if (f.second.readTex == target && ! f.second.waited)
+                        ordered = false;
+                host.markFrameRendered();
+                host.present(256, 144);
+                if (frame % 3 != 0)
+                    host.present(mirror, 128, 72);
+            }
+            expect(ordered);
+            expectEquals(FakeHostGl::waitsOnDeletedFences, 0);
+
+            host.releaseOutput(mirror);
+            host.removeOutput(mirror);
+            host.releasePresenter();
+            host.releaseTarget();
+            expectEquals(FakeHostGl::liveFences(), 0);
+            expect(FakeHostGl::names.empty(), "Textures and framebuffers are deleted with the targets");
+        }
+
+        beginTest("An output blitting from a slot keeps projectM out of it");
+        {
+            FakeHostGl::reset();
+            Host host(FakeHostGl::api());
+            Host::Output mirror;
+            host.addOutput(mirror);
+            renderFrame(host, 256, 144);
+            bool clashed = false;
+            int nested = 0;
+            // The mirror's GL thread is still issuing its blit while the canvas renders three
+            // frames; by the third, the held slot is the oldest
+            FakeHostGl::duringBlit = [&](unsigned int held) {
+                if (nested++ > 0) return;
+                for (int i = 0; i < 3; ++i)
+                    if (renderFrame(host, 256, 144) == held)
+                        clashed = true;
+            };
+            host.present(mirror, 256, 144);
+            FakeHostGl::duringBlit = nullptr;
+            expect(! clashed);
+            expectEquals(nested, 1);
+            host.releaseOutput(mirror);
+            host.removeOutput(mirror);
+            host.releaseTarget();
+        }
+
+        beginTest("Outputs holding both spare slots cost a skipped frame, not a stalled render thread");
+        {
+            FakeHostGl::reset();
+            Host host(FakeHostGl::api());
+            Host::Output a, b;
+            host.addOutput(a);
+            host.addOutput(b);
+            renderFrame(host, 64, 36);
+            unsigned int target = 1;
+            double waitedMs = 0.0;
+            int depth = 0;
+            // a holds the first frame while one more renders, b holds that one while the third
+            // renders: the published slot and both spares are taken when the fourth is due
+            FakeHostGl::duringBlit = [&](unsigned int) {
+                if (++depth == 1) {
+                    renderFrame(host, 64, 36);
+                    host.present(b, 64, 36);
+                } else if (depth == 2) {
+                    renderFrame(host, 64, 36);
+                    const double t0 = juce::Time::getMillisecondCounterHiRes();
+                    target = host.prepareTarget(64, 36);
+                    waitedMs = juce::Time::getMillisecondCounterHiRes() - t0;
+                }
+            };
+            host.present(a, 64, 36);
+            FakeHostGl::duringBlit = nullptr;
+            expectEquals((int) target, 0);
+            expect(waitedMs < 50.0, "prepareTarget waited " + juce::String(waitedMs, 1) + " ms");
+            expectEquals((int) host.getSkippedFrames(), 1);
+            host.markFrameRendered(); // as the canvas would not: must not publish anything
+            expect(host.present(64, 36));
+            expect(renderFrame(host, 64, 36) != 0, "Rendering resumes once the holds end");
+            host.releaseOutput(a);
+            host.releaseOutput(b);
+            host.removeOutput(a);
+            host.removeOutput(b);
+            host.releasePresenter();
+            host.releaseTarget();
+            expectEquals(FakeHostGl::liveFences(), 0);
+        }
+
+        beginTest("Small outputs blit from mip levels; the largest output sets the render size");
+        {
+            expectEquals(Host::levelFor(1920, 1080, 1920, 1080), 0);
+            expectEquals(Host::levelFor(1920, 1080, 960, 540), 1);
+            expectEquals(Host::levelFor(1920, 1080, 961, 540), 0);
+            expectEquals(Host::levelFor(1920, 1080, 480, 270), 2);
+            expectEquals(Host::levelFor(1920, 1080, 8, 8), Host::maxPreviewLevel);
+            expectEquals(Host::maxLevelFor(12, 3), 1);
+
+            FakeHostGl::reset();
+            Host host(FakeHostGl::api());
+            Host::Output preview;
+            host.addOutput(preview);
+            renderFrame(host, 1920, 1080);
+            host.present(1920, 1080);
+            host.present(preview, 480, 270);
+            expectEquals(FakeHostGl::blits.back().level, 0, "Levels are built from the next frame on");
+            const auto largest = host.largestOutputSize();
+            expectEquals(largest.x, 1920);
+            expectEquals(largest.y, 1080);
+
+            renderFrame(host, 1920, 1080);
+            expectEquals(FakeHostGl::levelsBuilt, 2);
+            host.present(preview, 480, 270);
+            expectEquals(FakeHostGl::blits.back().level, 2);
+            expectEquals(FakeHostGl::blits.back().srcW, 480);
+            expectEquals(FakeHostGl::blits.back().srcH, 270);
+
+            host.releaseOutput(preview);
+            host.removeOutput(preview);
+            FakeHostGl::levelsBuilt = 0;
+            renderFrame(host, 1920, 1080);
+            expectEquals(FakeHostGl::levelsBuilt, 0, "No levels once no output needs them");
+            host.releasePresenter();
+            host.releaseTarget();
+        }
+
+        beginTest("Released targets are reattached even when the driver reuses their names");
+        {
+            FakeHostGl::reset();
+            Host host(FakeHostGl::api());
+            renderFrame(host, 64, 36);
+            host.present(64, 36);
+            const auto first = FakeHostGl::blits.back();
+            expect(first.attach);
+            renderFrame(host, 64, 36);
+            renderFrame(host, 64, 36);
+            renderFrame(host, 64, 36); // back in the first slot
+            host.present(64, 36);
+            expectEquals((int) FakeHostGl::blits.back().tex, (int) first.tex);
+            expect(! FakeHostGl::blits.back().attach, "Same texture and level: no reattach");
+
+            host.releaseTarget();
+            renderFrame(host, 64, 36);
+            host.present(64, 36);
+            expectEquals((int) FakeHostGl::blits.back().tex, (int) first.tex);
+            expect(FakeHostGl::blits.back().attach, "A new texture under an old name is attached again");
+            host.releasePresenter();
+            host.releaseTarget();
+            expectEquals(FakeHostGl::liveFences(), 0);
+        }
+
+        beginTest("Destroying the host forgets the old share group's fences");
+        {
+            FakeHostGl::reset();
+            FakeContext::creatable = FakeContext::sharable = true;
+            Host host(FakeHostGl::api());
+            expect(host.create(false, true) == RenderHostFallback::none);
+            renderFrame(host, 64, 36);
+            host.present(64, 36);
+            host.destroy();
+            expect(! host.present(64, 36), "No frame until the new host renders one");
+            expect(host.create(false, true) == RenderHostFallback::none);
+            renderFrame(host, 64, 36);
+            expectEquals(FakeHostGl::waitsOnDeletedFences, 0);
+            expect(host.present(64, 36));
+        }
+    }
+};
+
+static RenderHostTests renderHostTests;
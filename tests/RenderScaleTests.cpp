@@ -0,0 +1,92 @@
+#include <juce_core/juce_core.h>
+#include "../src/RenderScale.h"
+#include <vector>
+
+using namespace milkdawp;
+
+class RenderScaleTests : public juce::UnitTest {
+public:
+    RenderScaleTests() : juce::UnitTest("RenderScaleTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Render pixel work drops with the square of the scale");
+        {
+            const RenderSize full = scaledRenderSize(1280, 720, 1.0);
+            expectEquals(full.width, 1280);
+            expectEquals(full.height, 720);
+            for (double scale : { 0.9, 0.75, 0.5 })
+            {
+                const RenderSize rs = scaledRenderSize(1280, 720, scale);
+                const double ratio = (double)rs.pixels() / (double)full.pixels();
+                expectWithinAbsoluteError(ratio, scale * scale, 0.005);
+            }
+            // Out-of-range scales clamp; tiny surfaces never collapse below 2x2
+            expectEquals(scaledRenderSize(1280, 720, 2.0).width, 1280);
+            expectEquals(scaledRenderSize(1280, 720, 0.0).width, 320);
+            expectEquals(scaledRenderSize(3, 3, 0.5).height, 2);
+        }
+
+        beginTest("Upscaler copies equal sizes and preserves flat colour");
+        {
+            BilinearUpscaler up;
+            std::vector<uint32_t> src(16 * 9), dst(16 * 9, 0u);
+            for (size_t i = 0; i < src.size(); ++i) src[i] = 0xFF000000u | (uint32_t)(i * 2654435761u & 0xFFFFFFu);
+            up.upscale(src.data(), 16, 9, 16, dst.data(), 16, 9, 16);
+            expect(src == dst);
+
+            std::vector<uint32_t> flat(7 * 5, 0xFF336699u), big(29 * 17, 0u);
+            up.upscale(flat.data(), 7, 5, 7, big.data(), 29, 17, 29);
+            bool allSame = true;
+            for (auto p : big) allSame = allSame && p == 0xFF336699u;
+            expect(allSame);
+        }
+
+        beginTest("Upscaler interpolates between pixel centres");
+        {
+            // 2x1 black/white stretched to 8x2: edges clamp, centre ramps monotonically
+            BilinearUpscaler up;
+            const uint32_t src[2] = { 0xFF000000u, 0xFFFFFFFFu };
+            std::vector<uint32_t> dst(8 * 2, 0u);
+            up.upscale(src, 2, 1, 2, dst.data(), 8, 2, 8);
+            expectEquals((int)dst[0], (int)0xFF000000u);
+            expectEquals((int)dst[7], (int)0xFFFFFFFFu);
+            bool monotonic = true;
+            for (int x = 1; x < 8; ++x)
+                monotonic = monotonic && (dst[(size_t)x] & 0xFF) >= (dst[(size_t)x - 1] & 0xFF);
+            expect(monotonic);
+            // Destination x = 3 maps to source x = 0.375: 0.375 * 255 rounds to 96
+            expectEquals((int)(dst[3] & 0xFF), 96);
+            // Both rows come from the single source row
+            for (int x = 0; x < 8; ++x)
+                expectEquals((int)dst[(size_t)x + 8], (int)dst[(size_t)x]);
+
+            // Stride-padded source and destination
+            const uint32_t padded[2 * 4] = { 0xFF000000u, 0xFF0000FFu, 0xDEADBEEFu, 0xDEADBEEFu,
+                                             0xFF0000FFu, 0xFF000000u, 0xDEADBEEFu, 0xDEADBEEFu };
+            std::vector<uint32_t> out(4 * 6, 0x12345678u);
+            up.upscale(padded, 2, 2, 4, out.data(), 4, 4, 6);
+            expectEquals((int)out[0], (int)0xFF000000u);
+            expectEquals((int)out[3 * 6 + 0], (int)0xFF0000FFu);
+            expectEquals((int)out[4], 0x12345678); // padding untouched
+        }
+
+        beginTest("GPU render target scale only moves in whole steps");
+        {
+            // First request snaps; small drifts of the budget cap do not reallocate
+            double s = steppedRenderScale(0.0, 0.83);
+            expectWithinAbsoluteError(s, 0.85, 1e-9);
+            for (double r : { 0.84, 0.86, 0.81, 0.88 })
+            {
+                s = steppedRenderScale(s, r);
+                expectWithinAbsoluteError(s, 0.85, 1e-9);
+            }
+            s = steppedRenderScale(s, 0.62);
+            expectWithinAbsoluteError(s, 0.6, 1e-9);
+            expectWithinAbsoluteError(steppedRenderScale(s, 2.0), 1.0, 1e-9);
+            expectWithinAbsoluteError(steppedRenderScale(s, 0.0), 0.25, 1e-9);
+        }
+    }
+};
+
+static RenderScaleTests renderScaleTests;
@@ -0,0 +1,250 @@
+#include <juce_core/juce_core.h>
+#include "../src/SharedFrameOutput.h"
+#include <thread>
+
+using namespace milkdawp;
+
+#if MDW_HAS_SHARED_FRAME_OUTPUT
+namespace {
+juce::String testSegmentName(const char* tag)
+{
+    return "/mdw-test-" + juce::String(tag) + "-" + juce::String((int)getpid());
+}
+
+// Row y (top-down) of frame index is filled with this byte, so flipped, torn or stale rows show.
+// It repeats every patternPeriod frames, so a few source frames can be published in turn.
+constexpr uint64_t patternPeriod = 4;
+uint8_t rowByte(uint64_t index, uint64_t y) { return (uint8_t)(((index % patternPeriod) * 61u + y) & 0xff); }
+
+// Bottom-up BGRA frame as the readback delivers it
+std::vector<uint8_t> bottomUpFrame(int w, int h, uint64_t index)
+{
+    std::vector<uint8_t> px((size_t)w * 4 * (size_t)h);
+    for (int y = 0; y < h; ++y)
+        std::memset(px.data() + (size_t)(h - 1 - y) * (size_t)w * 4, rowByte(index, (uint64_t)y), (size_t)w * 4);
+    return px;
+}
+
+CapturedFrameView viewOf(const std::vector<uint8_t>& px, int w, int h, uint64_t index)
+{
+    CapturedFrameView v;
+    v.pixels = px.data();
+    v.width = w;
+    v.height = h;
+    v.stride = w * 4;
+    v.frameIndex = index;
+    v.timestampMs = juce::Time::getMillisecondCounterHiRes();
+    return v;
+}
+
+// Samples a few rows of a top-down frame in place
+bool rowsMatch(const SharedFrameReader::FrameRef& f)
+{
+    for (uint32_t y : { 0u, f.height / 2, f.height - 1 })
+    {
+        const uint8_t expected = rowByte(f.frameIndex, y);
+        const uint8_t* row = f.pixels + (size_t)y * f.stride;
+        if (row[0] != expected || row[f.stride - 1] != expected) return false;
+    }
+    return true;
+}
+} // namespace
+
+class SharedFrameOutputTests : public juce::UnitTest {
+public:
+    SharedFrameOutputTests() : juce::UnitTest("SharedFrameOutputTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("A reader maps the segment and sees published frames top-down, in place");
+        {
+            SharedFrameWriter writer;
+            expect(writer.open(testSegmentName("basic")));
+            SharedFrameReader reader;
+            expect(reader.open(writer.getName()));
+            SharedFrameReader::FrameRef f;
+            expect(! reader.latest(f), "Nothing published yet");
+
+            const auto px = bottomUpFrame(64, 36, 5);
+            const uint32_t before = reader.getFrameCounter();
+            writer.deliver(viewOf(px, 64, 36, 5));
+            expect(reader.waitForFrame(before, 100));
+            expect(reader.latest(f));
+            expectEquals((int)f.width, 64);
+            expectEquals((int)f.height, 36);
+            expectEquals((int)f.stride, 256);
+            expectEquals((int)f.format, (int)SharedFrameLayout::formatBgra8);
+            expectEquals((int)f.frameIndex, 5);
+            expect(std::abs(SharedFrameClock::nowNs() - f.timestampNs) < 1000000000ll, "Timestamp is on CLOCK_MONOTONIC");
+            expect(rowsMatch(f));
+            expect(reader.stillValid(f));
+        }
+
+        beginTest("A slot overwritten while the reader holds it is detected");
+        {
+            SharedFrameWriter writer;
+            expect(writer.open(testSegmentName("overwrite")));
+            SharedFrameReader reader;
+            expect(reader.open(writer.getName()));
+            const auto px = bottomUpFrame(16, 16, 1);
+            writer.deliver(viewOf(px, 16, 16, 1));
+            SharedFrameReader::FrameRef f;
+            expect(reader.latest(f));
+            for (uint64_t i = 2; i <= (uint64_t)SharedFrameLayout::slotCount; ++i)
+                writer.deliver(viewOf(px, 16, 16, i));
+            expect(reader.stillValid(f), "Slot reuse comes around only after slotCount frames");
+            writer.deliver(viewOf(px, 16, 16, 99));
+            expect(! reader.stillValid(f));
+        }
+
+        beginTest("Larger frames move the output to a new segment under the same name");
+        {
+            SharedFrameWriter writer;
+            expect(writer.open(testSegmentName("grow")));
+            SharedFrameReader reader;
+            expect(reader.open(writer.getName()));
+            const int w = 2560, h = 1440; // over the initial 1080p slots
+            const auto px = bottomUpFrame(w, h, 3);
+            writer.deliver(viewOf(px, w, h, 3));
+            expect(reader.isClosed());
+            expect(reader.open(writer.getName()));
+            SharedFrameReader::FrameRef f;
+            expect(reader.latest(f));
+            expectEquals((int)f.width, w);
+            expect(rowsMatch(f));
+        }
+
+        beginTest("A second writer takes the next name; a closed writer's name is free again");
+        {
+            const auto base = testSegmentName("names");
+            SharedFrameWriter a, b;
+            expect(a.open(base));
+            expect(b.open(base));
+            expect(a.getName() == base);
+            expect(b.getName() == base + "-2");
+            a.close();
+            SharedFrameReader reader;
+            expect(! reader.open(base), "Closed segments are unlinked");
+            SharedFrameWriter c;
+            expect(c.open(base));
+            expect(c.getName() == base);
+        }
+
+        beginTest("A segment shorter than its header is taken over, not read");
+        {
+            const auto base = testSegmentName("short");
+            const int fd = shm_open(base.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644); // never truncated
+            expect(fd >= 0);
+            ::close(fd);
+            SharedFrameWriter writer;
+            expect(writer.open(base));
+            expect(writer.getName() == base);
+        }
+
+        beginTest("A frame the segment can't grow for stops the output and says so");
+        {
+            SharedFrameWriter writer;
+            expect(writer.open(testSegmentName("nogrow")));
+            const auto name = writer.getName();
+            // Slots this size can't be mapped three times over in any address space
+            std::vector<uint8_t> row(16);
+            CapturedFrameView huge = viewOf(row, 1 << 24, 1 << 22, 1);
+            huge.stride = 0;
+            writer.deliver(huge);
+            expect(writer.hasFailed());
+            expect(! writer.isOpen());
+            writer.deliver(huge); // no segment, nothing more to log
+            SharedFrameReader reader;
+            expect(! reader.open(name));
+            expect(writer.open(name));
+            expect(! writer.hasFailed());
+        }
+    }
+};
+
+static SharedFrameOutputTests sharedFrameOutputTests;
+
+// Registered under "Benchmark" (see AnalysisBenchmarks.cpp); run with `MilkDAWp_tests --benchmarks`
+class SharedFrameOutputBenchmarks : public juce::UnitTest {
+public:
+    SharedFrameOutputBenchmarks() : juce::UnitTest("SharedFrameOutputBenchmarks", "Benchmark") {}
+
+    void runTest() override
+    {
+        beginTest("Publishing at 1080p60 and 4K30 with a reader consuming every frame");
+        struct Mode { int w, h, fps; const char* tag; };
+        for (const Mode m : { Mode{ 1920, 1080, 60, "1080p60" }, Mode{ 3840, 2160, 30, "4k30" } })
+        {
+            SharedFrameWriter writer;
+            expect(writer.open(testSegmentName(m.tag)));
+            const auto segment = writer.getName();
+            SharedFrameReader reader;
+            expect(reader.open(segment));
+
+            const int frames = m.fps * 2;
+            std::vector<std::vector<uint8_t>> source;
+            for (uint64_t i = 0; i < patternPeriod; ++i)
+                source.push_back(bottomUpFrame(m.w, m.h, i));
+
+            std::atomic<bool> done{ false };
+            int seen = 0, intact = 0;
+            double latencySumMs = 0.0;
+            std::thread consumer([&] {
+                uint64_t lastIndex = 0;
+                while (! done.load(std::memory_order_acquire))
+                {
+                    // The first 4K frame moves the writer to a larger segment
+                    if (reader.isClosed() && ! reader.open(segment))
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        continue;
+                    }
+                    const uint32_t counter = reader.getFrameCounter();
+                    SharedFrameReader::FrameRef f;
+                    if (! reader.latest(f) || f.frameIndex == lastIndex)
+                    {
+                        reader.waitForFrame(counter, 50);
+                        continue;
+                    }
+                    lastIndex = f.frameIndex;
+                    const bool ok = rowsMatch(f);
+                    if (! reader.stillValid(f)) continue;
+                    ++seen;
+                    if (ok) ++intact;
+                    latencySumMs += (double)(SharedFrameClock::nowNs() - f.timestampNs) * 1.0e-6;
+                }
+            });
+
+            const double periodMs = 1000.0 / m.fps;
+            double writeMs = 0.0, worstMs = 0.0;
+            const double start = juce::Time::getMillisecondCounterHiRes();
+            for (int i = 1; i <= frames; ++i)
+            {
+                const auto v = viewOf(source[(size_t)((uint64_t)i % patternPeriod)], m.w, m.h, (uint64_t)i);
+                const double t0 = juce::Time::getMillisecondCounterHiRes();
+                writer.deliver(v);
+                const double dt = juce::Time::getMillisecondCounterHiRes() - t0;
+                writeMs += dt;
+                worstMs = juce::jmax(worstMs, dt);
+                const double next = start + periodMs * i;
+                while (juce::Time::getMillisecondCounterHiRes() < next)
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            done.store(true, std::memory_order_release);
+            consumer.join();
+
+            const double mbPerFrame = (double)m.w * m.h * 4.0 / (1024.0 * 1024.0);
+            logMessage(juce::String(m.tag) + ": write " + juce::String(writeMs / frames, 3) + " ms/frame (worst "
+                       + juce::String(worstMs, 3) + ", " + juce::String(mbPerFrame * frames / (writeMs / 1000.0), 0)
+                       + " MB/s), reader saw " + juce::String(seen) + "/" + juce::String(frames) + " intact "
+                       + juce::String(intact) + ", latency " + juce::String(seen > 0 ? latencySumMs / seen : 0.0, 2) + " ms");
+            expectLessThan(writeMs / frames, periodMs * 0.5, "Publishing takes well under the frame period");
+            expectEquals(intact, seen);
+            expectGreaterThan(seen, frames * 9 / 10);
+        }
+    }
+};
+
+static SharedFrameOutputBenchmarks sharedFrameOutputBenchmarks;
+#endif
@@ -0,0 +1,199 @@
+#include <juce_core/juce_core.h>
+#include "../src/SimdDispatch.h"
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace milkdawp;
+
+class SimdDispatchTests : public juce::UnitTest {
+public:
+    SimdDispatchTests() : juce::UnitTest("SimdDispatchTests", "core") {}
+
+    void runTest() override
+    {
+        beginTest("Active variant is supported on this machine");
+        {
+            const auto& k = simd::active();
+            expect(simd::isSupported(k.level));
+            expect(simd::getKernels(simd::Level::Scalar) != nullptr);
+            logMessage(juce::String("Active SIMD variant: ") + k.name);
+        }
+
+        // Odd sizes exercise vector bodies and scalar tails
+        const int n = 1024 + 13;
+        juce::Random rng(99);
+        std::vector<float> a((size_t)n), b((size_t)n), win((size_t)n);
+        for (int i = 0; i < n; ++i)
+        {
+            a[(size_t)i] = rng.nextFloat() * 4.0f - 2.0f; // exceeds full scale on purpose
+            b[(size_t)i] = rng.nextFloat() * 2.0f - 1.0f;
+            win[(size_t)i] = rng.nextFloat();
+        }
+        a[5] = std::numeric_limits<float>::quiet_NaN();
+        a[6] = std::numeric_limits<float>::infinity();
+        a[7] = -std::numeric_limits<float>::infinity();
+        a[8] = 0.5f / 32767.0f; // exact rounding tie
+        a[9] = std::numeric_limits<float>::denorm_min();
+        a[10] = -std::numeric_limits<float>::min() * 0.5f; // negative denormal
+
+        const auto& ref = *simd::getKernels(simd::Level::Scalar);
+        const simd::Level levels[] = { simd::Level::SSE2, simd::Level::AVX2, simd::Level::AVX512, simd::Level::NEON };
+
+        for (auto level : levels)
+        {
+            const auto* k = simd::getKernels(level);
+            if (k == nullptr)
+                continue;
+
+            beginTest(juce::String("Bit-equivalence with scalar: ") + k->name);
+
+            std::vector<float> outRef((size_t)n), outK((size_t)n);
+            ref.downmixStereo(a.data() + 9, b.data() + 9, outRef.data(), n - 9);
+            k->downmixStereo(a.data() + 9, b.data() + 9, outK.data(), n - 9);
+            expect(std::memcmp(outRef.data(), outK.data(), sizeof(float) * (size_t)(n - 9)) == 0, "downmixStereo differs");
+
+            std::fill(outRef.begin(), outRef.end(), 0.0f);
+            std::fill(outK.begin(), outK.end(), 0.0f);
+            const auto epRef = ref.windowedCopyEnergyPeak(b.data(), win.data(), outRef.data(), n);
+            const auto epK = k->windowedCopyEnergyPeak(b.data(), win.data(), outK.data(), n);
+            expect(std::memcmp(outRef.data(), outK.data(), sizeof(float) * (size_t)n) == 0, "windowed copy differs");
+            expect(std::memcmp(&epRef.energy, &epK.energy, sizeof(float)) == 0, "energy differs");
+            expect(std::memcmp(&epRef.peak, &epK.peak, sizeof(float)) == 0, "peak differs");
+
+            const float ssRef = ref.sumSquares(b.data(), n);
+            const float ssK = k->sumSquares(b.data(), n);
+            expect(std::memcmp(&ssRef, &ssK, sizeof(float)) == 0, "sumSquares differs");
+
+            std::vector<int16_t> i16Ref((size_t)n), i16K((size_t)n);
+            ref.floatToInt16(a.data(), i16Ref.data(), n);
+            k->floatToInt16(a.data(), i16K.data(), n);
+            expect(i16Ref == i16K, "floatToInt16 differs");
+
+            std::vector<float> scrubRef(a), scrubK(a);
+            ref.scrubPcm(scrubRef.data(), n);
+            k->scrubPcm(scrubK.data(), n);
+            expect(std::memcmp(scrubRef.data(), scrubK.data(), sizeof(float) * (size_t)n) == 0, "scrubPcm differs");
+
+            const int w = 333;
+            std::vector<uint32_t> pxRef((size_t)w), pxK((size_t)w);
+            const float c0[3] = { 0.08f, 0.10f, 0.12f };
+            const float dc[3] = { 0.04f, 0.06f, 0.08f };
+            for (int y = 0; y < 4; ++y)
+            {
+                const float t0 = -0.1f + 0.3f * (float)y, dt = 1.0f / (float)w;
+                ref.fillGradientRow(pxRef.data(), w, c0, dc, t0, dt);
+                k->fillGradientRow(pxK.data(), w, c0, dc, t0, dt);
+                expect(pxRef == pxK, "fillGradientRow differs");
+            }
+
+            // Planar RGB rows in [0, 255]
+            std::vector<float> rowA((size_t)w * 3), rowB((size_t)w * 3);
+            for (size_t i = 0; i < rowA.size(); ++i)
+            {
+                rowA[i] = std::isfinite(a[i]) ? std::abs(a[i]) * 127.5f : 0.0f; // non-finite is not a valid pixel
+                rowB[i] = std::abs(b[i]) * 255.0f;
+            }
+            for (float fy : { 0.0f, 0.3f, 0.5f, 1.0f })
+            {
+                ref.lerpRowsToArgb(rowA.data(), rowB.data(), fy, pxRef.data(), w);
+                k->lerpRowsToArgb(rowA.data(), rowB.data(), fy, pxK.data(), w);
+                expect(pxRef == pxK, "lerpRowsToArgb differs");
+            }
+
+            // Two rows of random opaque pixels; the odd half-width leaves chroma tails
+            const int n2 = w * 2;
+            std::vector<uint32_t> rows((size_t)n2 * 2);
+            for (auto& q : rows) q = 0xFF000000u | ((uint32_t)rng.nextInt() & 0xFFFFFFu);
+            rows[0] = 0xFFFFFFFFu;
+            rows[1] = 0xFF000000u;
+            std::vector<uint8_t> yuvRef((size_t)n2 * 3), yuvK((size_t)n2 * 3);
+            for (auto* out : { &yuvRef, &yuvK })
+            {
+                const auto& kk = out == &yuvRef ? ref : *k;
+                uint8_t* o = out->data();
+                kk.argbToI420Rows(rows.data(), rows.data() + n2, o, o + n2, o + 2 * n2, o + 2 * n2 + w, n2);
+            }
+            expect(yuvRef == yuvK, "argbToI420Rows differs");
+        }
+
+        beginTest("floatToInt16 matches the per-sample clamp/round reference exactly");
+        {
+            // Every half step of the int16 grid (all rounding ties) across and beyond full scale
+            std::vector<float> in;
+            for (int i = -2 * 34000; i <= 2 * 34000; ++i)
+                in.push_back((float)i * 0.5f / 32767.0f);
+            for (int i = 0; i < 4096; ++i)
+                in.push_back(rng.nextFloat() * 3.0f - 1.5f);
+            std::vector<int16_t> expected(in.size()), out(in.size());
+            for (size_t i = 0; i < in.size(); ++i)
+                expected[i] = (int16_t)std::lrint(juce::jlimit(-32767.0f, 32767.0f, in[i] * 32767.0f));
+
+            for (auto level : { simd::Level::Scalar, simd::Level::SSE2, simd::Level::AVX2, simd::Level::AVX512, simd::Level::NEON })
+                if (const auto* k = simd::getKernels(level))
+                {
+                    k->floatToInt16(in.data(), out.data(), (int)in.size());
+                    expect(out == expected, juce::String("floatToInt16 inexact: ") + k->name);
+                }
+        }
+
+        beginTest("Scrub zeroes NaN, infinities and denormals only");
+        {
+            float x[8] = { std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::denorm_min(),
+                           std::numeric_limits<float>::min(), -0.25f, 3.0f, 0.0f };
+            simd::active().scrubPcm(x, 8);
+            for (int i = 0; i < 4; ++i) expectEquals(x[i], 0.0f);
+            expectEquals(x[4], std::numeric_limits<float>::min());
+            expectEquals(x[5], -0.25f);
+            expectEquals(x[6], 3.0f);
+            int16_t o[4] = { 1, 1, 1, 1 };
+            const float bad[4] = { std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+                                   -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::denorm_min() };
+            simd::active().floatToInt16(bad, o, 4);
+            for (int i = 0; i < 4; ++i) expectEquals((int)o[i], 0);
+        }
+
+        beginTest("Scalar reference values");
+        {
+            const float in[5] = { 1.0f, -1.0f, 2.0f, -2.0f, 0.0f };
+            int16_t out[5] = {};
+            ref.floatToInt16(in, out, 5);
+            expectEquals((int)out[0], 32767);
+            expectEquals((int)out[1], -32767);
+            expectEquals((int)out[2], 32767);
+            expectEquals((int)out[3], -32767);
+            expectEquals((int)out[4], 0);
+
+            const float c0[3] = { 0.0f, 0.0f, 0.0f };
+            const float dc[3] = { 1.0f, 0.5f, 0.0f };
+            uint32_t px[2] = {};
+            ref.fillGradientRow(px, 2, c0, dc, 0.0f, 1.0f);
+            expectEquals((int)px[0], (int)0xFF000000u);
+            expectEquals((int)px[1], (int)0xFFFF8000u);
+
+            // R plane {0, 255}, G plane {100, 100}, B plane {0, 0} blended halfway with all-255
+            const float ra[6] = { 0.0f, 255.0f, 100.0f, 100.0f, 0.0f, 0.0f };
+            const float rb[6] = { 255.0f, 255.0f, 255.0f, 255.0f, 255.0f, 255.0f };
+            ref.lerpRowsToArgb(ra, rb, 0.5f, px, 2);
+            expectEquals((int)px[0], (int)0xFF80B280u);
+            expectEquals((int)px[1], (int)0xFFFFB280u);
+
+            // BT.709 limited range: white, black, and a 2x2 block of pure red
+            const uint32_t bw[4] = { 0xFFFFFFFFu, 0xFF000000u, 0xFFFFFFFFu, 0xFF000000u };
+            uint8_t ys[4] = {}, cb = 0, cr = 0;
+            ref.argbToI420Rows(bw, bw + 2, ys, ys + 2, &cb, &cr, 2);
+            expectEquals((int)ys[0], 235);
+            expectEquals((int)ys[1], 16);
+            expectEquals((int)cb, 128);
+            expectEquals((int)cr, 128);
+            const uint32_t red[4] = { 0xFFFF0000u, 0xFFFF0000u, 0xFFFF0000u, 0xFFFF0000u };
+            ref.argbToI420Rows(red, red + 2, ys, ys + 2, &cb, &cr, 2);
+            expectEquals((int)ys[3], 63);
+            expectEquals((int)cb, 102);
+            expectEquals((int)cr, 240);
+        }
+    }
+};
+
+static SimdDispatchTests simdDispatchTests;
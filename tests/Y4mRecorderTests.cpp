@@ -0,0 +1,288 @@
+#include <juce_core/juce_core.h>
+#include "../src/Y4mRecorder.h"
+#include <cstring>
+#include <thread>
+
+using namespace milkdawp;
+
+namespace {
+juce::File tempY4m(const juce::String& name)
+{
+    auto f = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile(name);
+    f.deleteFile();
+    return f;
+}
+
+// Opaque BGRA frame; the top `split` rows of the picture are `top`, the rest `bottom`.
+// Stored bottom-up as the GL readback delivers it, or top-down as the CPU renderer does.
+std::vector<uint8_t> splitFrame(int w, int h, int split, uint8_t top, uint8_t bottom, bool topDown)
+{
+    std::vector<uint8_t> px((size_t)w * 4 * (size_t)h);
+    for (int y = 0; y < h; ++y)
+    {
+        const uint8_t grey = y < split ? top : bottom;
+        uint8_t* row = px.data() + (size_t)(topDown ? y : h - 1 - y) * (size_t)w * 4;
+        for (int x = 0; x < w; ++x)
+        {
+            row[x * 4 + 0] = row[x * 4 + 1] = row[x * 4 + 2] = grey;
+            row[x * 4 + 3] = 0xff;
+        }
+    }
+    return px;
+}
+
+CapturedFrameView viewOf(const std::vector<uint8_t>& px, int w, int h, double timestampMs, bool topDown)
+{
+    CapturedFrameView v;
+    v.pixels = px.data();
+    v.width = w;
+    v.height = h;
+    v.stride = w * 4;
+    v.timestampMs = timestampMs;
+    v.topDown = topDown;
+    return v;
+}
+
+// Limited-range luma of an 8-bit grey level
+int lumaOf(uint8_t grey) { return (int)((float)grey * 0.858824f + 16.5f); }
+
+struct Y4mFile {
+    juce::MemoryBlock data;
+    juce::String header;
+    int width = 0, height = 0;
+    std::vector<const uint8_t*> frames; // Y, Cb, Cr planes
+
+    bool load(const juce::File& f)
+    {
+        if (! f.loadFileAsData(data)) return false;
+        const auto* p = static_cast<const uint8_t*>(data.getData());
+        const size_t size = data.getSize();
+        const auto* nl = static_cast<const uint8_t*>(std::memchr(p, '\n', size));
+        if (nl == nullptr) return false;
+        header = juce::String(std::string((const char*)p, (size_t)(nl - p)));
+        for (const auto& tok : juce::StringArray::fromTokens(header, " ", {}))
+        {
+            if (tok.startsWithChar('W')) width = tok.substring(1).getIntValue();
+            if (tok.startsWithChar('H')) height = tok.substring(1).getIntValue();
+        }
+        const size_t frameBytes = (size_t)width * (size_t)height * 3 / 2;
+        size_t pos = (size_t)(nl - p) + 1;
+        while (pos + 6 + frameBytes <= size)
+        {
+            if (std::memcmp(p + pos, "FRAME\n", 6) != 0) return false;
+            frames.push_back(p + pos + 6);
+            pos += 6 + frameBytes;
+        }
+        return pos == size && width > 0 && height > 0;
+    }
+
+    int luma(size_t frame, int x, int y) const { return frames[frame][(size_t)y * (size_t)width + (size_t)x]; }
+    int cb(size_t frame) const { return frames[frame][(size_t)width * (size_t)height]; }
+    int cr(size_t frame) const { return frames[frame][(size_t)width * (size_t)height * 5 / 4]; }
+};
+} // namespace
+
+class Y4mRecorderTests : public juce::UnitTest {
+public:
+    Y4mRecorderTests() : juce::UnitTest("Y4mRecorderTests", "core") {}
+
+    void runTest() override
+    {
+        constexpr double period = 1000.0 / 60.0;
+
+        beginTest("Frames from either capture path are written upright as I420");
+        {
+            const auto file = tempY4m("mdw_rec_upright.y4m");
+            Y4mRecorder rec;
+            expect(rec.start(file, 60.0));
+            expect(rec.isRecording());
+            const int w = 64, h = 36;
+            const auto gl = splitFrame(w, h, 10, 255, 0, false);
+            const auto cpu = splitFrame(w, h, 10, 255, 0, true);
+            rec.deliver(viewOf(gl, w, h, 1000.0, false));
+            rec.deliver(viewOf(cpu, w, h, 1000.0 + period, true));
+            rec.stop();
+            expect(! rec.isRecording());
+
+            Y4mFile y4m;
+            expect(y4m.load(file));
+            expect(y4m.header.startsWith("YUV4MPEG2 W64 H36 F60:1 "), y4m.header);
+            expect(y4m.header.contains("C420jpeg"));
+            expectEquals((int)y4m.frames.size(), 2);
+            for (size_t i = 0; i < y4m.frames.size(); ++i)
+            {
+                expectEquals(y4m.luma(i, 0, 0), 235);
+                expectEquals(y4m.luma(i, w - 1, 9), 235);
+                expectEquals(y4m.luma(i, 0, 10), 16);
+                expectEquals(y4m.luma(i, w - 1, h - 1), 16);
+                expectEquals(y4m.cb(i), 128);
+                expectEquals(y4m.cr(i), 128);
+            }
+            const auto s = rec.getStats();
+            expectEquals((int)s.framesWritten, 2);
+            expectEquals((int)s.framesDropped, 0);
+            expectEquals((int)s.bytesWritten, (int)file.getSize());
+            file.deleteFile();
+        }
+
+        beginTest("Frames land in the slot of their timestamp; gaps repeat the previous frame");
+        {
+            const auto file = tempY4m("mdw_rec_timeline.y4m");
+            Y4mRecorder rec;
+            expect(rec.start(file, 60.0));
+            const int w = 16, h = 8;
+            const uint8_t greys[] = { 20, 60, 100, 140 };
+            const double slots[] = { 0.0, 1.1, 4.0, 4.3 }; // 4.3 shares slot 4: rendering above the recording rate
+            std::vector<std::vector<uint8_t>> frames;
+            for (int i = 0; i < 4; ++i)
+                frames.push_back(splitFrame(w, h, h, greys[i], greys[i], true));
+            for (int i = 0; i < 4; ++i)
+                rec.deliver(viewOf(frames[(size_t)i], w, h, 500.0 + slots[i] * period, true));
+            rec.stop();
+
+            Y4mFile y4m;
+            expect(y4m.load(file));
+            expectEquals((int)y4m.frames.size(), 5);
+            const int expected[] = { lumaOf(20), lumaOf(60), lumaOf(60), lumaOf(60), lumaOf(100) };
+            for (size_t i = 0; i < y4m.frames.size() && i < 5; ++i)
+                expectEquals(y4m.luma(i, 3, 3), expected[i]);
+            const auto s = rec.getStats();
+            expectEquals((int)s.framesWritten, 5);
+            expectEquals((int)s.framesRepeated, 2);
+            expectEquals((int)s.framesDropped, 0);
+            file.deleteFile();
+        }
+
+        beginTest("A size change continues in a numbered file; odd sizes are cropped");
+        {
+            const auto file = tempY4m("mdw_rec_resize.y4m");
+            const auto second = file.getSiblingFile("mdw_rec_resize-2.y4m");
+            second.deleteFile();
+            Y4mRecorder rec;
+            expect(rec.start(file, 30.0));
+            const auto a = splitFrame(64, 36, 0, 0, 128, true);
+            const auto b = splitFrame(33, 19, 19, 255, 255, false);
+            rec.deliver(viewOf(a, 64, 36, 0.0, true));
+            rec.deliver(viewOf(b, 33, 19, 40.0, false));
+            rec.stop();
+
+            Y4mFile first, next;
+            expect(first.load(file));
+            expect(next.load(second));
+            expectEquals(first.width, 64);
+            expectEquals((int)first.frames.size(), 1);
+            expect(next.header.startsWith("YUV4MPEG2 W32 H18 F30:1 "), next.header);
+            expectEquals((int)next.frames.size(), 1);
+            expectEquals(next.luma(0, 31, 17), 235);
+            expectEquals(rec.getStats().files, 2);
+            file.deleteFile();
+            second.deleteFile();
+        }
+
+        beginTest("A writer that falls behind costs dropped frames, never a blocked producer");
+        {
+            const auto file = tempY4m("mdw_rec_burst.y4m");
+            Y4mRecorder rec;
+            expect(rec.start(file, 60.0));
+            const int w = 1280, h = 720, total = 120;
+            const auto px = splitFrame(w, h, h / 2, 200, 40, false);
+            double worstMs = 0.0;
+            for (int i = 0; i < total; ++i)
+            {
+                const double t0 = juce::Time::getMillisecondCounterHiRes();
+                rec.deliver(viewOf(px, w, h, (double)i * period, false));
+                worstMs = juce::jmax(worstMs, juce::Time::getMillisecondCounterHiRes() - t0);
+            }
+            rec.stop();
+            const auto s = rec.getStats();
+            logMessage("Burst of " + juce::String(total) + " 720p frames: " + juce::String((juce::int64)s.framesDropped)
+                       + " dropped, worst deliver " + juce::String(worstMs, 2) + " ms");
+            // Every frame either reached the file or was counted as dropped; the gaps drops leave are repeats
+            expectEquals((int)(s.framesWritten - s.framesRepeated + s.framesDropped), total);
+            file.deleteFile();
+        }
+    }
+};
+
+static Y4mRecorderTests y4mRecorderTests;
+
+// Registered under "Benchmark" (see AnalysisBenchmarks.cpp); run with `MilkDAWp_tests --benchmarks`
+class Y4mRecorderBenchmarks : public juce::UnitTest {
+public:
+    Y4mRecorderBenchmarks() : juce::UnitTest("Y4mRecorderBenchmarks", "Benchmark") {}
+
+    void runTest() override
+    {
+        beginTest("BGRA -> I420 conversion per kernel variant");
+        {
+            struct Size { int w, h; const char* tag; };
+            for (const Size sz : { Size{ 1920, 1080, "1080p" }, Size{ 3840, 2160, "4K" } })
+            {
+                std::vector<uint32_t> px((size_t)sz.w * (size_t)sz.h);
+                juce::Random rng(7);
+                for (auto& p : px) p = 0xFF000000u | ((uint32_t)rng.nextInt() & 0xFFFFFFu);
+                std::vector<uint8_t> out((size_t)sz.w * (size_t)sz.h * 3 / 2);
+                for (auto level : { simd::Level::Scalar, simd::Level::SSE2, simd::Level::AVX2, simd::Level::AVX512, simd::Level::NEON })
+                {
+                    const auto* k = simd::getKernels(level);
+                    if (k == nullptr) continue;
+                    const int reps = 20;
+                    const double t0 = juce::Time::getMillisecondCounterHiRes();
+                    for (int r = 0; r < reps; ++r)
+                    {
+                        uint8_t* y = out.data();
+                        uint8_t* cb = y + px.size();
+                        uint8_t* cr = cb + px.size() / 4;
+                        for (int row = 0; row < sz.h; row += 2)
+                            k->argbToI420Rows(px.data() + (size_t)row * (size_t)sz.w, px.data() + (size_t)(row + 1) * (size_t)sz.w,
+                                              y + (size_t)row * (size_t)sz.w, y + (size_t)(row + 1) * (size_t)sz.w,
+                                              cb + (size_t)(row / 2) * (size_t)(sz.w / 2), cr + (size_t)(row / 2) * (size_t)(sz.w / 2), sz.w);
+                    }
+                    const double ms = (juce::Time::getMillisecondCounterHiRes() - t0) / reps;
+                    logMessage(juce::String(sz.tag) + " " + k->name + ": " + juce::String(ms, 3) + " ms/frame");
+                }
+            }
+        }
+
+        beginTest("Recording 1080p60 in real time");
+        {
+            const auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("mdw_rec_bench.y4m");
+            Y4mRecorder rec;
+            expect(rec.start(file, 60.0));
+            const int w = 1920, h = 1080, frames = 120;
+            std::vector<uint8_t> px((size_t)w * 4 * (size_t)h);
+            juce::Random rng(3);
+            for (auto& b : px) b = (uint8_t)rng.nextInt(256);
+            const double periodMs = 1000.0 / 60.0;
+            double deliverMs = 0.0, worstMs = 0.0;
+            const double start = juce::Time::getMillisecondCounterHiRes();
+            for (int i = 0; i < frames; ++i)
+            {
+                const double next = start + periodMs * i;
+                while (juce::Time::getMillisecondCounterHiRes() < next)
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                CapturedFrameView v;
+                v.pixels = px.data();
+                v.width = w;
+                v.height = h;
+                v.stride = w * 4;
+                v.timestampMs = juce::Time::getMillisecondCounterHiRes();
+                const double t0 = v.timestampMs;
+                rec.deliver(v);
+                const double dt = juce::Time::getMillisecondCounterHiRes() - t0;
+                deliverMs += dt;
+                worstMs = juce::jmax(worstMs, dt);
+            }
+            rec.stop();
+            const auto s = rec.getStats();
+            logMessage("1080p60: deliver " + juce::String(deliverMs / frames, 3) + " ms/frame (worst " + juce::String(worstMs, 3)
+                       + "), write " + juce::String(s.writeMsAverage, 3) + " ms/frame, " + juce::String((juce::int64)s.framesWritten)
+                       + " written, " + juce::String((juce::int64)s.framesRepeated) + " repeated, "
+                       + juce::String((juce::int64)s.framesDropped) + " dropped");
+            expectLessThan(deliverMs / frames, periodMs * 0.5, "Converting takes well under the frame period");
+            file.deleteFile();
+        }
+    }
+};
+
+static Y4mRecorderBenchmarks y4mRecorderBenchmarks;
@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+//
+// Headless preset benchmark: walks a preset folder (same discovery and .milkignore filtering as
+// the playlist), loads every preset into projectM on an offscreen EGL pbuffer and reports, per
+// preset, the load time, first-frame time and steady-state p50/p99 frame times, worst first.
+//
+//   MilkDAWp_preset_bench --folder <dir> [--frames 120] [--size 1280x720] [--warm]
+//                         [--csv report.csv] [--json report.json]
+//
+// --warm builds each preset once on a separate small instance before its load, the way a
+// background shader warm-up would, so comparing a run with and one without it shows what such a
+// warm-up would save per switch (load_ms, first_frame_ms) and what it would cost (warm_up_ms,
+// time projectM spends parsing and compiling off the switch). Drivers keep compiled shaders on disk,
+// so give each run an empty cache or the plain run is warm too, e.g.
+// MESA_SHADER_CACHE_DIR=$(mktemp -d) on Mesa, __GL_SHADER_DISK_CACHE_PATH=$(mktemp -d) on NVIDIA.
+//
+// Runs on any EGL implementation that offers pbuffers; for CPU-only machines and CI use Mesa's
+// software rasteriser:  EGL_PLATFORM=surfaceless LIBGL_ALWAYS_SOFTWARE=1 MilkDAWp_preset_bench ...
+// Every frame is followed by glFinish so the timings include the GPU (or llvmpipe) work. The
+// progress lines also show the steady-state GPU time from the plugin's timer query ring.
+
+#include <juce_core/juce_core.h>
+#include <EGL/egl.h>
+#include <projectM-4/projectM.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "../src/PresetFolderScan.h"
+#include "../src/PresetBenchReport.h"
+#include "../src/GpuFrameTimer.h"
+
+using namespace milkdawp;
+
+namespace {
+
+struct Options {
+    juce::File folder;
+    int frames = 120;
+    int width = 1280, height = 720;
+    bool warm = false;
+    juce::File csv, json;
+};
+
+bool parseArgs(int argc, char** argv, Options& o)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--folder" && hasValue)      o.folder = juce::File(juce::String(argv[++i]));
+        else if (arg == "--frames" && hasValue) o.frames = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--size" && hasValue)
+        {
+            const juce::String s(argv[++i]);
+            o.width = juce::jmax(16, s.upToFirstOccurrenceOf("x", false, true).getIntValue());
+            o.height = juce::jmax(16, s.fromFirstOccurrenceOf("x", false, true).getIntValue());
+        }
+        else if (arg == "--warm")               o.warm = true;
+        else if (arg == "--csv" && hasValue)    o.csv = juce::File(juce::String(argv[++i]));
+        else if (arg == "--json" && hasValue)   o.json = juce::File(juce::String(argv[++i]));
+        else return false;
+    }
+    return o.folder.isDirectory();
+}
+
+// Offscreen GL context: a pbuffer surface gives projectM a default framebuffer to draw into
+struct HeadlessGL {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLSurface surface = EGL_NO_SURFACE;
+    EGLContext context = EGL_NO_CONTEXT;
+    void (*finish)() = nullptr;
+
+    bool create(int w, int h)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || ! eglInitialize(display, nullptr, nullptr)) return false;
+        const EGLint cfgAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                      EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_NONE };
+        EGLConfig config = nullptr;
+        EGLint n = 0;
+        if (! eglChooseConfig(display, cfgAttribs, &config, 1, &n) || n < 1) return false;
+        const EGLint pbAttribs[] = { EGL_WIDTH, w, EGL_HEIGHT, h, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbAttribs);
+        if (surface == EGL_NO_SURFACE || ! eglBindAPI(EGL_OPENGL_API)) return false;
+        // projectM 4 needs GL 3.3 core
+        const EGLint ctxAttribs[] = { EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, ctxAttribs);
+        if (context == EGL_NO_CONTEXT || ! eglMakeCurrent(display, surface, surface, context)) return false;
+        finish = reinterpret_cast<void (*)()>(eglGetProcAddress("glFinish"));
+        return finish != nullptr;
+    }
+
+    ~HeadlessGL()
+    {
+        if (display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+};
+
+// Deterministic stereo test signal for one 60 fps frame: bass pulse on the beat plus a sweep,
+// so beat- and spectrum-driven preset code takes its busy paths
+void fillAudio(std::vector<float>& pcm, int frameIndex)
+{
+    constexpr int sampleRate = 48000, samplesPerFrame = sampleRate / 60;
+    pcm.resize((size_t)samplesPerFrame * 2);
+    for (int i = 0; i < samplesPerFrame; ++i)
+    {
+        const double t = (double)(frameIndex * samplesPerFrame + i) / sampleRate;
+        const double beat = std::fmod(t, 0.5);
+        const double kick = std::exp(-beat * 18.0) * std::sin(2.0 * juce::MathConstants<double>::pi * 55.0 * beat);
+        const double sweep = 0.3 * std::sin(2.0 * juce::MathConstants<double>::pi * (200.0 + 1800.0 * std::fmod(t, 4.0) / 4.0) * t);
+        pcm[(size_t)i * 2 + 0] = (float)(0.6 * kick + sweep);
+        pcm[(size_t)i * 2 + 1] = (float)(0.6 * kick - sweep);
+    }
+}
+
+// A warm-up ahead of a switch: a separate 64x36 instance loads the preset text and renders one
+// frame, which leaves the programs in the driver's shader cache.
+// Returns the time spent, 0 if no instance could be created.
+double warmUp(const juce::File& file, const HeadlessGL& gl)
+{
+    constexpr int warmWidth = 64, warmHeight = 36;
+    projectm_handle pm = projectm_create();
+    if (pm == nullptr) return 0.0;
+    projectm_set_window_size(pm, (size_t)warmWidth, (size_t)warmHeight);
+    projectm_set_preset_duration(pm, 86400.0);
+    const auto data = file.loadFileAsString();
+    const double t0 = juce::Time::getMillisecondCounterHiRes();
+    projectm_load_preset_data(pm, data.toRawUTF8(), false);
+    projectm_opengl_render_frame(pm);
+    gl.finish();
+    const double ms = juce::Time::getMillisecondCounterHiRes() - t0;
+    projectm_destroy(pm);
+    return ms;
+}
+
+struct FailureSink {
+    bool failed = false;
+    juce::String message;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (! parseArgs(argc, argv, opt))
+    {
+        std::fprintf(stderr, "usage: %s --folder <dir> [--frames N] [--size WxH] [--warm] [--csv out.csv] [--json out.json]\n", argv[0]);
+        return 2;
+    }
+
+    HeadlessGL gl;
+    if (! gl.create(opt.width, opt.height))
+    {
+        std::fprintf(stderr, "Could not create an offscreen OpenGL 3.3 context via EGL (try EGL_PLATFORM=surfaceless)\n");
+        return 1;
+    }
+
+    GpuTimerRing gpuTimer;
+    if (! gpuTimer.create(GpuTimerApi::resolve([](const char* name) { return (void*)eglGetProcAddress(name); })))
+        std::fprintf(stderr, "No GL timer queries; GPU times not reported\n");
+
+    const auto presets = PresetFolderScan::scan(opt.folder);
+    std::fprintf(stderr, "%d presets in %s, %d frames each at %dx%d%s\n", presets.size(),
+                 opt.folder.getFullPathName().toRawUTF8(), opt.frames, opt.width, opt.height,
+                 opt.warm ? ", shaders warmed before each load" : "");
+
+    std::vector<PresetBenchResult> results;
+    std::vector<float> pcm;
+    std::vector<double> frameMs, gpuMs;
+    for (int p = 0; p < presets.size(); ++p)
+    {
+        const auto& file = presets.getReference(p);
+        PresetBenchResult r;
+        r.path = file.getFullPathName();
+
+        // Fresh instance per preset so one preset's state (textures, failed loads) can't skew the next
+        projectm_handle pm = projectm_create();
+        if (pm == nullptr)
+        {
+            std::fprintf(stderr, "projectm_create failed\n");
+            return 1;
+        }
+        projectm_set_window_size(pm, (size_t)opt.width, (size_t)opt.height);
+        projectm_set_fps(pm, 60);
+        projectm_set_preset_duration(pm, 86400.0);
+        FailureSink failure;
+        projectm_set_preset_switch_failed_event_callback(pm, [](const char*, const char* message, void* user)
+        {
+            auto* sink = static_cast<FailureSink*>(user);
+            sink->failed = true;
+            sink->message = juce::String(message);
+        }, &failure);
+
+        int frame = 0;
+        auto renderTimed = [&]
+        {
+            fillAudio(pcm, frame++);
+            projectm_pcm_add_float(pm, pcm.data(), (unsigned int)(pcm.size() / 2), PROJECTM_STEREO);
+            const double t0 = juce::Time::getMillisecondCounterHiRes();
+            const bool timed = gpuTimer.begin((uint64_t)frame);
+            projectm_opengl_render_frame(pm);
+            if (timed) gpuTimer.end();
+            gl.finish();
+            const double ms = juce::Time::getMillisecondCounterHiRes() - t0;
+            gpuTimer.collect([&](uint64_t, double gpu) { gpuMs.push_back(gpu); });
+            return ms;
+        };
+
+        // Warm the instance on its built-in idle preset so its own setup isn't billed to the preset
+        renderTimed();
+        if (opt.warm)
+            r.warmUpMs = warmUp(file, gl);
+
+        const double t0 = juce::Time::getMillisecondCounterHiRes();
+        projectm_load_preset_file(pm, r.path.toRawUTF8(), false);
+        gl.finish();
+        r.loadMs = juce::Time::getMillisecondCounterHiRes() - t0;
+        r.loaded = ! failure.failed;
+        r.error = failure.message;
+
+        if (r.loaded)
+        {
+            r.firstFrameMs = renderTimed();
+            frameMs.clear();
+            gpuMs.clear();
+            for (int f = 0; f < opt.frames; ++f)
+                frameMs.push_back(renderTimed());
+            PresetBenchReport::setSteadyFrames(r, frameMs);
+        }
+        projectm_destroy(pm);
+
+        std::fprintf(stderr, "[%d/%d] %s: warm-up %.1f ms, load %.1f ms, first %.1f ms, p99 %.1f ms, gpu p50 %.2f ms%s\n", p + 1, presets.size(),
+                     file.getFileName().toRawUTF8(), r.warmUpMs, r.loadMs, r.firstFrameMs, r.p99Ms,
+                     PresetBenchReport::percentile(gpuMs, 50.0), r.loaded ? "" : " (FAILED)");
+        results.push_back(r);
+    }
+
+    // The figure to compare between a plain and a --warm run
+    std::vector<double> hitches, warmUps;
+    for (const auto& r : results)
+        if (r.loaded)
+        {
+            hitches.push_back(r.switchHitchMs());
+            warmUps.push_back(r.warmUpMs);
+        }
+    std::fprintf(stderr, "Switch hitch p50 %.1f ms, p99 %.1f ms", PresetBenchReport::percentile(hitches, 50.0),
+                 PresetBenchReport::percentile(hitches, 99.0));
+    if (opt.warm)
+        std::fprintf(stderr, " after a warm-up of p50 %.1f ms, p99 %.1f ms", PresetBenchReport::percentile(warmUps, 50.0),
+                     PresetBenchReport::percentile(warmUps, 99.0));
+    std::fputs("\n", stderr);
+
+    PresetBenchReport::sortWorstFirst(results);
+    const auto csv = PresetBenchReport::toCsv(results);
+    if (opt.csv != juce::File()) opt.csv.replaceWithText(csv);
+    if (opt.json != juce::File()) opt.json.replaceWithText(PresetBenchReport::toJson(results));
+    if (opt.csv == juce::File() && opt.json == juce::File())
+        std::fputs(csv.toRawUTF8(), stdout);
+    return 0;
+}
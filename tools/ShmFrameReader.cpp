@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// Copyright (c) 2025 Otitis Media
+//
+// Reference reader for the plugin's shared-memory frame output ("Publish frames to shared
+// memory" in the settings). Maps the segment, waits for frames and prints once a second how
+// many arrived, how many the plugin published that this reader missed, and the age of the
+// frames when picked up. Frames are used in place, without a copy, as a compositor would.
+//
+//   MilkDAWp_shm_reader [--name /milkdawp] [--seconds 10] [--ppm last.ppm]
+//
+// --ppm writes the first frame read as a binary PPM, to check the orientation and colours.
+
+#include <juce_core/juce_core.h>
+#include <cstdio>
+#include <vector>
+#include "../src/SharedFrameOutput.h"
+
+using namespace milkdawp;
+
+namespace {
+
+struct Options {
+    juce::String name = "/milkdawp";
+    int seconds = 10;
+    juce::File ppm;
+};
+
+bool parseArgs(int argc, char** argv, Options& o)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--name" && hasValue)         o.name = juce::String(argv[++i]);
+        else if (arg == "--seconds" && hasValue) o.seconds = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--ppm" && hasValue)     o.ppm = juce::File(juce::String(argv[++i]));
+        else return false;
+    }
+    return o.name.startsWithChar('/');
+}
+
+// BGRA rows top to bottom -> RGB
+bool writePpm(const juce::File& file, const SharedFrameReader::FrameRef& f, const SharedFrameReader& reader)
+{
+    std::vector<uint8_t> rgb((size_t)f.width * f.height * 3);
+    for (uint32_t y = 0; y < f.height; ++y)
+    {
+        const uint8_t* src = f.pixels + (size_t)y * f.stride;
+        uint8_t* dst = rgb.data() + (size_t)y * f.width * 3;
+        for (uint32_t x = 0; x < f.width; ++x)
+        {
+            dst[x * 3 + 0] = src[x * 4 + 2];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 0];
+        }
+    }
+    if (! reader.stillValid(f)) return false; // overwritten while converting
+    juce::FileOutputStream out(file);
+    if (! out.openedOk()) return false;
+    out.setPosition(0);
+    out.truncate();
+    const juce::String head = "P6\n" + juce::String(f.width) + " " + juce::String(f.height) + "\n255\n";
+    out.write(head.toRawUTF8(), head.getNumBytesAsUTF8());
+    out.write(rgb.data(), rgb.size());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (! parseArgs(argc, argv, opt))
+    {
+        std::fprintf(stderr, "usage: %s [--name /milkdawp] [--seconds N] [--ppm out.ppm]\n", argv[0]);
+        return 2;
+    }
+
+    SharedFrameReader reader;
+    const double end = juce::Time::getMillisecondCounterHiRes() + opt.seconds * 1000.0;
+    uint64_t lastIndex = 0;
+    uint32_t width = 0, height = 0;
+    int frames = 0, missed = 0, torn = 0;
+    double ageSumMs = 0.0, nextReport = juce::Time::getMillisecondCounterHiRes() + 1000.0;
+    bool wrotePpm = false;
+
+    while (juce::Time::getMillisecondCounterHiRes() < end)
+    {
+        if (reader.isClosed())
+        {
+            // Not published yet, stopped, or moved to a larger segment
+            if (! reader.open(opt.name))
+            {
+                juce::Thread::sleep(100);
+                continue;
+            }
+            std::fprintf(stderr, "Mapped %s\n", opt.name.toRawUTF8());
+            lastIndex = 0;
+        }
+
+        const uint32_t counter = reader.getFrameCounter();
+        SharedFrameReader::FrameRef f;
+        if (reader.latest(f) && f.frameIndex != lastIndex)
+        {
+            const double ageMs = (double)(SharedFrameClock::nowNs() - f.timestampNs) * 1.0e-6;
+            if (opt.ppm != juce::File() && ! wrotePpm)
+                wrotePpm = writePpm(opt.ppm, f, reader);
+            if (reader.stillValid(f))
+            {
+                if (lastIndex != 0 && f.frameIndex > lastIndex + 1)
+                    missed += (int)(f.frameIndex - lastIndex - 1);
+                lastIndex = f.frameIndex;
+                ++frames;
+                ageSumMs += ageMs;
+                width = f.width;
+                height = f.height;
+            }
+            else
+            {
+                ++torn;
+            }
+        }
+        else
+        {
+            reader.waitForFrame(counter, 100);
+        }
+
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        if (now >= nextReport)
+        {
+            std::printf("%d frames/s, %d skipped, %d overwritten while reading, avg age %.2f ms, %ux%u, frame %llu\n",
+                        frames, missed, torn, frames > 0 ? ageSumMs / frames : 0.0, width, height,
+                        (unsigned long long)lastIndex);
+            std::fflush(stdout);
+            frames = missed = torn = 0;
+            ageSumMs = 0.0;
+            nextReport = now + 1000.0;
+        }
+    }
+
+    if (opt.ppm != juce::File())
+        std::fprintf(stderr, wrotePpm ? "Wrote %s\n" : "No frame written to %s\n", opt.ppm.getFullPathName().toRawUTF8());
+    return 0;
+}